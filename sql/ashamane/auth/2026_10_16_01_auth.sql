@@ -0,0 +1,6 @@
+DELETE FROM `rbac_permissions` WHERE `id`=2011;
+INSERT INTO `rbac_permissions` (`id`, `name`) VALUES
+(2011, 'Command: server tickprofile');
+
+DELETE FROM `rbac_linked_permissions` WHERE `id`=192 AND `linkedId`=2011;
+INSERT INTO `rbac_linked_permissions` (`id`, `linkedId`) VALUES (192, 2011);
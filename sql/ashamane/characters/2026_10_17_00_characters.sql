@@ -0,0 +1,5 @@
+DROP TABLE IF EXISTS `database_journal`;
+CREATE TABLE `database_journal` (
+  `id` BIGINT(20) UNSIGNED NOT NULL,
+  PRIMARY KEY (`id`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8 COMMENT='Journal ids of committed transactions';
@@ -0,0 +1,5 @@
+DELETE FROM `command` WHERE `name`='server opcodestats';
+INSERT INTO `command` (`name`,`permission`,`help`) VALUES
+('server opcodestats', 2010, 'Syntax: .server opcodestats [#count]
+
+Show the #count (default 10) client opcodes with the highest total handling time and the #count server opcodes with the most bytes sent. Requires OpcodeStats.Enable in worldserver.conf.');
@@ -0,0 +1,5 @@
+DELETE FROM `command` WHERE `name`='server tickprofile';
+INSERT INTO `command` (`name`,`permission`,`help`) VALUES
+('server tickprofile', 2011, 'Syntax: .server tickprofile [on|off|dump [$filename]]
+
+Without argument show whether the tick profiler is enabled. on/off toggle it, dump writes the recorded world and map update scopes as Chrome trace event JSON to $filename in the logs directory (default: tickprofile_<time>.json).');
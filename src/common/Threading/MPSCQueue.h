@@ -19,6 +19,9 @@
 #define MPSCQueue_h__
 
 #include <atomic>
+#include <memory>
+#include <new>
+#include <type_traits>
 #include <utility>
 
 // C++ implementation of Dmitry Vyukov's lock free MPSC queue
@@ -80,4 +83,73 @@ private:
     MPSCQueue& operator=(MPSCQueue const&) = delete;
 };
 
+// Intrusive variant of the queue above, the link to the next element is stored inside T so no node is allocated per element
+// http://www.1024cores.net/home/lock-free-algorithms/queues/intrusive-mpsc-node-based-queue
+template<typename T, std::atomic<T*> T::* IntrusiveLink>
+class MPSCQueueIntrusive
+{
+public:
+    MPSCQueueIntrusive() : _dummyPtr(reinterpret_cast<T*>(std::addressof(_dummy))), _head(_dummyPtr), _tail(_dummyPtr)
+    {
+        // _dummy is never constructed (T might not be default constructible), only its link is
+        std::atomic<T*>* dummyNext = new (&(_dummyPtr->*IntrusiveLink)) std::atomic<T*>();
+        dummyNext->store(nullptr, std::memory_order_relaxed);
+    }
+
+    void Enqueue(T* input)
+    {
+        (input->*IntrusiveLink).store(nullptr, std::memory_order_release);
+        T* prevHead = _head.exchange(input, std::memory_order_acq_rel);
+        (prevHead->*IntrusiveLink).store(input, std::memory_order_release);
+    }
+
+    // can return false while a producer is between the exchange and the link store in Enqueue, the element shows up on a later call
+    bool Dequeue(T*& result)
+    {
+        T* tail = _tail.load(std::memory_order_relaxed);
+        T* next = (tail->*IntrusiveLink).load(std::memory_order_acquire);
+        if (tail == _dummyPtr)
+        {
+            if (!next)
+                return false;
+
+            _tail.store(next, std::memory_order_release);
+            tail = next;
+            next = (next->*IntrusiveLink).load(std::memory_order_acquire);
+        }
+
+        if (next)
+        {
+            _tail.store(next, std::memory_order_release);
+            result = tail;
+            return true;
+        }
+
+        T* head = _head.load(std::memory_order_acquire);
+        if (tail != head)
+            return false;
+
+        // tail is the last element, put the dummy behind it so it can be handed out
+        Enqueue(_dummyPtr);
+        next = (tail->*IntrusiveLink).load(std::memory_order_acquire);
+        if (next)
+        {
+            _tail.store(next, std::memory_order_release);
+            result = tail;
+            return true;
+        }
+
+        return false;
+    }
+
+private:
+    std::aligned_storage_t<sizeof(T), alignof(T)> _dummy;
+    T* _dummyPtr;
+    std::atomic<T*> _head;
+    std::atomic<T*> _tail;
+
+    MPSCQueueIntrusive(MPSCQueueIntrusive const&) = delete;
+    MPSCQueueIntrusive& operator=(MPSCQueueIntrusive const&) = delete;
+};
+
 #endif // MPSCQueue_h__
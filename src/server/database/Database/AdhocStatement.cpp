@@ -16,6 +16,7 @@
  */
 
 #include "AdhocStatement.h"
+#include "Common.h"
 #include "Errors.h"
 #include "MySQLConnection.h"
 #include "QueryResult.h"
@@ -42,18 +43,38 @@ BasicStatementTask::~BasicStatementTask()
 bool BasicStatementTask::Execute()
 {
     if (m_has_result)
+        return SetResult(m_conn->Query(m_sql));
+
+    return m_conn->Execute(m_sql);
+}
+
+bool BasicStatementTask::CanPipeline() const
+{
+    // a statement separator anywhere but at the end would make the results of the batch ambiguous
+    char const* separator = strchr(m_sql, ';');
+    if (separator && separator[strspn(separator, "; \t\r\n")] != '\0')
+        return false;
+
+    // stored procedures return an extra result and would shift the results of the statements after them
+    char const* sql = m_sql + strspn(m_sql, " \t\r\n");
+    return strnicmp(sql, "CALL", 4) != 0;
+}
+
+bool BasicStatementTask::SetResult(ResultSet* result)
+{
+    if (!m_has_result)
     {
-        ResultSet* result = m_conn->Query(m_sql);
-        if (!result || !result->GetRowCount() || !result->NextRow())
-        {
-            delete result;
-            m_result->set_value(QueryResult(NULL));
-            return false;
-        }
-
-        m_result->set_value(QueryResult(result));
+        delete result;
         return true;
     }
 
-    return m_conn->Execute(m_sql);
+    if (!result || !result->GetRowCount() || !result->NextRow())
+    {
+        delete result;
+        m_result->set_value(QueryResult(NULL));
+        return false;
+    }
+
+    m_result->set_value(QueryResult(result));
+    return true;
 }
@@ -32,6 +32,12 @@ class TC_DATABASE_API BasicStatementTask : public SQLOperation
         bool Execute() override;
         QueryResultFuture GetFuture() const { return m_result->get_future(); }
 
+        //- Single statements can be sent together with others in one multi statement query
+        bool CanPipeline() const;
+        char const* GetSql() const { return m_sql; }
+        //- Completes the task with the result of a pipelined execution
+        bool SetResult(ResultSet* result);
+
     private:
         const char* m_sql;      //- Raw query to be executed
         bool m_has_result;
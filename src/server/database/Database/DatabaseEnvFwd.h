@@ -18,11 +18,15 @@
 #ifndef DatabaseEnvFwd_h__
 #define DatabaseEnvFwd_h__
 
+#include <functional>
 #include <future>
 #include <memory>
 
 class Field;
 
+//- Receives the fields of one row of a streamed query, they are only valid during the call
+using QueryRowCallback = std::function<void(Field* fields)>;
+
 class ResultSet;
 using QueryResult = std::shared_ptr<ResultSet>;
 using QueryResultFuture = std::future<QueryResult>;
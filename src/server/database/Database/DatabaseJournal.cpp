@@ -0,0 +1,460 @@
+/*
+ * This file is part of the TrinityCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DatabaseJournal.h"
+#include "Errors.h"
+#include "Log.h"
+#include <boost/filesystem/operations.hpp>
+#include <algorithm>
+#include <cstring>
+
+#if TRINITY_PLATFORM == TRINITY_PLATFORM_WINDOWS
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    uint32 const JournalMagic = 0x4A424454;                 // "TDBJ"
+    uint32 const JournalVersion = 2;
+
+    //- Compact the file once it grows past this, only unfinished entries are kept
+    std::size_t const MaxJournalSize = 16 * 1024 * 1024;
+
+    enum JournalRecordType : uint8
+    {
+        JOURNAL_RECORD_ENTRY,
+        JOURNAL_RECORD_DONE
+    };
+
+    // type, id, key, payload size, payload checksum
+    std::size_t const RecordHeaderSize = 1 + 8 + 8 + 4 + 4;
+
+    template<typename T>
+    void Put(std::vector<uint8>& data, T value)
+    {
+        uint8 const* bytes = reinterpret_cast<uint8 const*>(&value);
+        data.insert(data.end(), bytes, bytes + sizeof(T));
+    }
+
+    void PutBytes(std::vector<uint8>& data, void const* bytes, std::size_t size)
+    {
+        Put<uint32>(data, uint32(size));
+        data.insert(data.end(), static_cast<uint8 const*>(bytes), static_cast<uint8 const*>(bytes) + size);
+    }
+
+    struct JournalReader
+    {
+        uint8 const* Data;
+        std::size_t Size;
+        std::size_t Pos;
+
+        template<typename T>
+        bool Get(T& value)
+        {
+            if (Size - Pos < sizeof(T))
+                return false;
+
+            memcpy(&value, Data + Pos, sizeof(T));
+            Pos += sizeof(T);
+            return true;
+        }
+
+        template<typename Container>
+        bool GetBytes(Container& value)
+        {
+            uint32 size;
+            if (!Get(size) || Size - Pos < size)
+                return false;
+
+            value.assign(Data + Pos, Data + Pos + size);
+            Pos += size;
+            return true;
+        }
+    };
+
+    uint32 Checksum(uint8 const* data, std::size_t size)
+    {
+        // FNV-1a, only needs to catch records torn by a crash
+        uint32 hash = 2166136261u;
+        for (std::size_t i = 0; i < size; ++i)
+            hash = (hash ^ data[i]) * 16777619u;
+
+        return hash;
+    }
+
+    void PutRecordHeader(std::vector<uint8>& data, JournalRecordType type, uint64 id, uint64 key, uint8 const* payload, std::size_t size)
+    {
+        Put<uint8>(data, type);
+        Put<uint64>(data, id);
+        Put<uint64>(data, key);
+        Put<uint32>(data, uint32(size));
+        Put<uint32>(data, Checksum(payload, size));
+    }
+
+    void PutFileHeader(std::vector<uint8>& data)
+    {
+        Put<uint32>(data, JournalMagic);
+        Put<uint32>(data, JournalVersion);
+    }
+
+    bool DeserializeEntry(JournalReader& reader, DatabaseJournal::Entry& entry)
+    {
+        uint32 count;
+        if (!reader.Get(count))
+            return false;
+
+        entry.Statements.resize(count);
+        for (DatabaseJournal::Statement& statement : entry.Statements)
+        {
+            uint8 isPrepared;
+            if (!reader.Get(isPrepared))
+                return false;
+
+            statement.IsPrepared = isPrepared != 0;
+            if (!statement.IsPrepared)
+            {
+                if (!reader.GetBytes(statement.Query))
+                    return false;
+                continue;
+            }
+
+            uint8 parameterCount;
+            if (!reader.Get(statement.Index) || !reader.GetBytes(statement.Query) || !reader.Get(parameterCount))
+                return false;
+
+            statement.Parameters.resize(parameterCount);
+            for (PreparedStatementData& parameter : statement.Parameters)
+            {
+                uint8 type;
+                if (!reader.Get(type) || type > TYPE_NULL || !reader.Get(parameter.data))
+                    return false;
+
+                parameter.type = PreparedStatementValueType(type);
+                if ((parameter.type == TYPE_STRING || parameter.type == TYPE_BINARY) && !reader.GetBytes(parameter.binary))
+                    return false;
+            }
+        }
+
+        return reader.Pos == reader.Size;
+    }
+}
+
+DatabaseJournal::DatabaseJournal() : _file(nullptr), _fileSize(0), _flushInterval(0), _shutdown(false), _nextId(1), _released(0), _takenReleased(0)
+{
+}
+
+DatabaseJournal::~DatabaseJournal()
+{
+    Close();
+}
+
+bool DatabaseJournal::ReadPending(std::string const& fileName, std::vector<Entry>& entries)
+{
+    entries.clear();
+
+    std::FILE* file = std::fopen(fileName.c_str(), "rb");
+    if (!file)
+        return true;
+
+    std::vector<uint8> data;
+    uint8 chunk[4096];
+    while (std::size_t read = std::fread(chunk, 1, sizeof(chunk), file))
+        data.insert(data.end(), chunk, chunk + read);
+
+    std::fclose(file);
+
+    if (data.empty())
+        return true;
+
+    JournalReader reader{ data.data(), data.size(), 0 };
+    uint32 magic, version;
+    if (!reader.Get(magic) || !reader.Get(version) || magic != JournalMagic || version != JournalVersion)
+    {
+        TC_LOG_ERROR("sql.driver", "Database journal %s is not a journal file of this version.", fileName.c_str());
+        return false;
+    }
+
+    struct ReadEntry
+    {
+        uint64 Key;
+        std::size_t Offset;
+        std::size_t Size;
+    };
+
+    std::map<uint64, ReadEntry> pending;
+    while (reader.Pos < reader.Size)
+    {
+        std::size_t recordStart = reader.Pos;
+        uint8 type;
+        uint64 id, key;
+        uint32 size, checksum;
+        if (!reader.Get(type) || !reader.Get(id) || !reader.Get(key) || !reader.Get(size) || !reader.Get(checksum)
+            || reader.Size - reader.Pos < size || Checksum(reader.Data + reader.Pos, size) != checksum)
+        {
+            // the last write before a crash can be incomplete
+            TC_LOG_WARN("sql.driver", "Database journal %s ends with an incomplete record, ignoring the last " SZFMTD " bytes.",
+                fileName.c_str(), reader.Size - recordStart);
+            break;
+        }
+
+        if (type == JOURNAL_RECORD_ENTRY)
+            pending[id] = { key, reader.Pos, size };
+        else
+            pending.erase(id);
+
+        reader.Pos += size;
+    }
+
+    for (auto const& itr : pending)
+    {
+        JournalReader entryReader{ data.data() + itr.second.Offset, itr.second.Size, 0 };
+        entries.emplace_back();
+        entries.back().Id = itr.first;
+        if (!DeserializeEntry(entryReader, entries.back()))
+        {
+            TC_LOG_ERROR("sql.driver", "Database journal %s has an unreadable entry " UI64FMTD ", skipped.", fileName.c_str(), itr.first);
+            entries.pop_back();
+        }
+    }
+
+    return true;
+}
+
+bool DatabaseJournal::Open(std::string const& fileName, uint32 flushInterval, uint64 firstId, std::vector<std::string> statementQueries)
+{
+    ASSERT(!_file);
+
+    _fileName = fileName;
+    _statementQueries = std::move(statementQueries);
+    _nextId = firstId;
+    _released = _takenReleased = firstId;
+    _flushInterval = std::chrono::milliseconds(std::max<uint32>(flushInterval, 1));
+
+    std::vector<uint8> header;
+    PutFileHeader(header);
+    if (!Rewrite(header))
+        return false;
+
+    _shutdown = false;
+    _flushThread = std::thread(&DatabaseJournal::FlushThread, this);
+    return true;
+}
+
+void DatabaseJournal::Close()
+{
+    if (!_flushThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _shutdown = true;
+        _condition.notify_all();
+    }
+
+    _flushThread.join();
+
+    if (_file)
+        std::fclose(_file);
+    _file = nullptr;
+}
+
+uint64 DatabaseJournal::Append(TransactionBase const& transaction)
+{
+    std::vector<uint8> payload;
+    Put<uint32>(payload, uint32(transaction.m_queries.size()));
+    for (SQLElementData const& element : transaction.m_queries)
+    {
+        if (element.type == SQL_ELEMENT_RAW)
+        {
+            Put<uint8>(payload, 0);
+            PutBytes(payload, element.element.query, strlen(element.element.query));
+            continue;
+        }
+
+        std::vector<PreparedStatementData> const& data = element.element.stmt->statement_data;
+        uint32 index = element.element.stmt->GetIndex();
+        ASSERT(index < _statementQueries.size());
+        Put<uint8>(payload, 1);
+        Put<uint32>(payload, index);
+        PutBytes(payload, _statementQueries[index].data(), _statementQueries[index].size());
+        Put<uint8>(payload, uint8(data.size()));
+        for (PreparedStatementData const& parameter : data)
+        {
+            Put<uint8>(payload, uint8(parameter.type));
+            Put(payload, parameter.data);
+            if (parameter.type == TYPE_STRING || parameter.type == TYPE_BINARY)
+                PutBytes(payload, parameter.binary.data(), parameter.binary.size());
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_lock);
+    uint64 id = _nextId++;
+    PendingEntry& entry = _pending[id];
+    entry.Key = transaction.GetJournalKey();
+    entry.Record.reserve(RecordHeaderSize + payload.size());
+    PutRecordHeader(entry.Record, JOURNAL_RECORD_ENTRY, id, entry.Key, payload.data(), payload.size());
+    entry.Record.insert(entry.Record.end(), payload.begin(), payload.end());
+
+    _buffer.insert(_buffer.end(), entry.Record.begin(), entry.Record.end());
+    return id;
+}
+
+void DatabaseJournal::MarkDone(uint64 id)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    auto itr = _pending.find(id);
+    if (itr == _pending.end())
+        return;
+
+    PutRecordHeader(_buffer, JOURNAL_RECORD_DONE, id, itr->second.Key, nullptr, 0);
+    _pending.erase(itr);
+}
+
+uint64 DatabaseJournal::TakeReleased()
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_released <= _takenReleased)
+        return 0;
+
+    _takenReleased = _released;
+    return _released;
+}
+
+void DatabaseJournal::SetParameters(PreparedStatementBase* stmt, std::vector<PreparedStatementData> const& parameters)
+{
+    for (std::size_t i = 0; i < parameters.size() && i < stmt->statement_data.size(); ++i)
+        stmt->statement_data[i] = parameters[i];
+}
+
+void DatabaseJournal::FlushThread()
+{
+    std::unique_lock<std::mutex> lock(_lock);
+    while (!_shutdown)
+    {
+        _condition.wait_for(lock, _flushInterval);
+        Flush(lock);
+    }
+
+    Flush(lock);
+}
+
+void DatabaseJournal::Flush(std::unique_lock<std::mutex>& lock)
+{
+    if (_buffer.empty())
+        return;
+
+    std::vector<uint8> buffer;
+    buffer.swap(_buffer);
+
+    // the done records of everything finished before this point are in the buffer
+    uint64 released = _pending.empty() ? _nextId : _pending.begin()->first;
+
+    if (_fileSize + buffer.size() <= MaxJournalSize)
+    {
+        lock.unlock();
+        bool written = Write(buffer);
+        lock.lock();
+        if (written)
+            _released = std::max(_released, released);
+        return;
+    }
+
+    // the unfinished entries already hold everything the buffer would add
+    std::vector<uint8> compacted;
+    PutFileHeader(compacted);
+    for (auto const& itr : _pending)
+        compacted.insert(compacted.end(), itr.second.Record.begin(), itr.second.Record.end());
+
+    lock.unlock();
+    bool written = Rewrite(compacted) || Write(buffer);
+    lock.lock();
+    if (written)
+        _released = std::max(_released, released);
+}
+
+bool DatabaseJournal::Write(std::vector<uint8> const& data)
+{
+    if (!_file || std::fwrite(data.data(), 1, data.size(), _file) != data.size() || std::fflush(_file))
+    {
+        TC_LOG_ERROR("sql.driver", "Could not write database journal %s.", _fileName.c_str());
+        return false;
+    }
+
+#if TRINITY_PLATFORM == TRINITY_PLATFORM_WINDOWS
+    _commit(_fileno(_file));
+#else
+    fsync(fileno(_file));
+#endif
+
+    _fileSize += data.size();
+    return true;
+}
+
+bool DatabaseJournal::Rewrite(std::vector<uint8> const& data)
+{
+    // write the new content next to the journal and swap it in, a crash leaves either the old or the new file
+    std::string tempFileName = _fileName + ".tmp";
+    std::FILE* oldFile = _file;
+    _file = std::fopen(tempFileName.c_str(), "wb");
+    if (!_file)
+    {
+        TC_LOG_ERROR("sql.driver", "Could not create database journal %s.", tempFileName.c_str());
+        _file = oldFile;
+        return false;
+    }
+
+    std::size_t oldFileSize = _fileSize;
+    bool written = Write(data);
+    std::fclose(_file);
+    _file = oldFile;
+    _fileSize = oldFileSize;
+
+    boost::system::error_code error;
+    if (written)
+        boost::filesystem::rename(tempFileName, _fileName, error);
+
+    if (!written || error)
+    {
+        TC_LOG_ERROR("sql.driver", "Could not replace database journal %s.", _fileName.c_str());
+        return false;
+    }
+
+    if (oldFile)
+        std::fclose(oldFile);
+
+    _file = std::fopen(_fileName.c_str(), "ab");
+    if (!_file)
+    {
+        TC_LOG_ERROR("sql.driver", "Could not open database journal %s.", _fileName.c_str());
+        return false;
+    }
+
+    _fileSize = data.size();
+    return true;
+}
+
+bool JournaledTransactionTask::Execute()
+{
+    bool committed = TransactionTask::Execute();
+    if (!committed)
+        TC_LOG_ERROR("sql.driver", "Journaled transaction " UI64FMTD " failed and is dropped from the journal.", m_journalId);
+
+    m_journal->MarkDone(m_journalId);
+    return committed;
+}
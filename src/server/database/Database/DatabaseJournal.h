@@ -0,0 +1,121 @@
+/*
+ * This file is part of the TrinityCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DATABASEJOURNAL_H
+#define _DATABASEJOURNAL_H
+
+#include "Define.h"
+#include "PreparedStatement.h"
+#include "Transaction.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Append-only file of the transactions a DatabaseWorkerPool queued but did not execute yet.
+/// Only transactions with a journal key are written. The pool adds a row with the journal id of the entry to the
+/// database_journal table inside the same transaction, so after a crash every unfinished entry without such a row
+/// is replayed in the order it was appended and entries that were committed are never applied twice.
+/// Appending only copies into memory, a background thread writes and syncs the file every flush interval.
+class TC_DATABASE_API DatabaseJournal
+{
+public:
+    struct Statement
+    {
+        bool IsPrepared;
+        uint32 Index;                                       // only a hint, statement enums change between builds
+        std::string Query;                                  // sql of prepared statements as well, identifies them on replay
+        std::vector<PreparedStatementData> Parameters;
+    };
+
+    struct Entry
+    {
+        uint64 Id;
+        std::vector<Statement> Statements;
+    };
+
+    DatabaseJournal();
+    ~DatabaseJournal();
+
+    /// Reads the entries a previous run journaled but never finished, in the order they were appended
+    static bool ReadPending(std::string const& fileName, std::vector<Entry>& entries);
+
+    /// Starts a new empty journal file, ids are handed out from firstId on.
+    /// statementQueries holds the sql of every prepared statement by index, it is journaled along with the parameters
+    bool Open(std::string const& fileName, uint32 flushInterval, uint64 firstId, std::vector<std::string> statementQueries);
+    /// Writes what is left, unfinished entries stay in the file for the next start
+    void Close();
+
+    uint64 Append(TransactionBase const& transaction);
+    /// For committed and failed transactions alike, replaying a failed one after newer saves of the same owner would roll those back
+    void MarkDone(uint64 id);
+    /// Returns the id below which database_journal rows are no longer needed if it advanced since the previous call, 0 otherwise
+    uint64 TakeReleased();
+
+    static void SetParameters(PreparedStatementBase* stmt, std::vector<PreparedStatementData> const& parameters);
+
+private:
+    struct PendingEntry
+    {
+        uint64 Key;
+        std::vector<uint8> Record;
+    };
+
+    void FlushThread();
+    void Flush(std::unique_lock<std::mutex>& lock);
+    bool Write(std::vector<uint8> const& data);
+    bool Rewrite(std::vector<uint8> const& data);
+
+    std::string _fileName;
+    std::FILE* _file;
+    std::size_t _fileSize;
+    std::chrono::milliseconds _flushInterval;
+
+    std::mutex _lock;
+    std::condition_variable _condition;
+    std::thread _flushThread;
+    bool _shutdown;
+
+    std::vector<std::string> _statementQueries;
+    uint64 _nextId;
+    uint64 _released;                                       // every entry below is finished and its done record is on disk
+    uint64 _takenReleased;
+    std::map<uint64, PendingEntry> _pending;
+    std::vector<uint8> _buffer;
+
+    DatabaseJournal(DatabaseJournal const& right) = delete;
+    DatabaseJournal& operator=(DatabaseJournal const& right) = delete;
+};
+
+class TC_DATABASE_API JournaledTransactionTask : public TransactionTask
+{
+public:
+    JournaledTransactionTask(std::shared_ptr<TransactionBase> trans, DatabaseJournal* journal, uint64 journalId)
+        : TransactionTask(trans), m_journal(journal), m_journalId(journalId) { }
+
+protected:
+    bool Execute() override;
+
+    DatabaseJournal* m_journal;
+    uint64 m_journalId;
+};
+
+#endif
@@ -53,7 +53,15 @@ DatabaseLoader& DatabaseLoader::AddDatabase(DatabaseWorkerPool<T>& pool, std::st
 
         uint8 const synchThreads = uint8(sConfigMgr->GetIntDefault(name + "Database.SynchThreads", 1));
 
-        pool.SetConnectionInfo(dbString, asyncThreads, synchThreads);
+        uint8 const reservedThreads = uint8(sConfigMgr->GetIntDefault(name + "Database.ReservedWorkerThreads", 0));
+        if (reservedThreads >= asyncThreads)
+        {
+            TC_LOG_ERROR(_logger, "%s database: invalid number of reserved worker threads specified. "
+                "Please pick a value lower than %sDatabase.WorkerThreads.", name.c_str(), name.c_str());
+            return false;
+        }
+
+        pool.SetConnectionInfo(dbString, asyncThreads, synchThreads, reservedThreads);
         if (uint32 error = pool.Open())
         {
             // Database does not exist
@@ -112,6 +120,17 @@ DatabaseLoader& DatabaseLoader::AddDatabase(DatabaseWorkerPool<T>& pool, std::st
             TC_LOG_ERROR(_logger, "Could not prepare statements of the %s database, see log for details.", name.c_str());
             return false;
         }
+
+        std::string const journalFile = sConfigMgr->GetStringDefault(name + "Database.JournalFile", "");
+        if (!journalFile.empty() && !pool.OpenJournal(journalFile, sConfigMgr->GetIntDefault(name + "Database.JournalFlushInterval", 50)))
+        {
+            TC_LOG_ERROR(_logger, "Could not open the journal of the %s database, see log for details.", name.c_str());
+            return false;
+        }
+
+        std::string const snapshotFile = sConfigMgr->GetStringDefault(name + "Database.SnapshotFile", "");
+        if (!snapshotFile.empty() && !pool.OpenSnapshot(snapshotFile))
+            TC_LOG_ERROR(_logger, "Could not open the snapshot of the %s database, it is loaded from MySQL.", name.c_str());
         return true;
     });
 
@@ -0,0 +1,371 @@
+/*
+ * This file is part of the TrinityCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DatabaseSnapshot.h"
+#include "Field.h"
+#include "Log.h"
+#include "PreparedStatement.h"
+#include "QueryResultCache.h"
+#include <boost/filesystem/operations.hpp>
+#include <cstring>
+
+namespace
+{
+    uint32 const SnapshotMagic = 0x53424454;                // "TDBS"
+    uint32 const SnapshotVersion = 1;
+
+    // magic, version, key
+    std::size_t const FileHeaderSize = 4 + 4 + 8;
+    // key length, field count, row count, data size
+    std::size_t const EntryHeaderSize = 4 + 4 + 8 + 8;
+    // length, type, flags, padding
+    std::size_t const FieldHeaderSize = 8;
+
+    enum SnapshotFieldFlags : uint8
+    {
+        SNAPSHOT_FIELD_RAW  = 0x1,
+        SNAPSHOT_FIELD_NULL = 0x2
+    };
+
+    std::size_t Align(std::size_t size)
+    {
+        return (size + 7) & ~std::size_t(7);
+    }
+
+    //- Bytes a value occupies, raw values of fixed size types do not need to carry a length
+    uint32 GetValueSize(DatabaseFieldTypes type, bool raw, uint32 length)
+    {
+        if (!raw)
+            return length;
+
+        switch (type)
+        {
+            case DatabaseFieldTypes::Int8:
+                return 1;
+            case DatabaseFieldTypes::Int16:
+                return 2;
+            case DatabaseFieldTypes::Int32:
+            case DatabaseFieldTypes::Float:
+                return 4;
+            case DatabaseFieldTypes::Int64:
+            case DatabaseFieldTypes::Double:
+                return 8;
+            default:
+                return length;
+        }
+    }
+}
+
+DatabaseSnapshot::DatabaseSnapshot() : _file(nullptr), _discarded(false)
+{
+}
+
+DatabaseSnapshot::~DatabaseSnapshot()
+{
+    // a recording that was not closed is missing the rest of the startup
+    StopRecording();
+    Close();
+}
+
+std::string DatabaseSnapshot::GetKey(PreparedStatementBase const* stmt)
+{
+    return "#" + std::to_string(stmt->GetIndex()) + ":" + QueryResultCache::GetKey(stmt);
+}
+
+bool DatabaseSnapshot::Open(std::string const& fileName, uint64 key)
+{
+    Close();
+    _fileName = fileName;
+
+    if (Load(key))
+    {
+        TC_LOG_INFO("sql.driver", "Loaded " SZFMTD " queries from the snapshot %s.", _entries.size(), _fileName.c_str());
+        return true;
+    }
+
+    _entries.clear();
+    if (_mapping.is_open())
+        _mapping.close();
+
+    _file = std::fopen((_fileName + ".tmp").c_str(), "wb");
+    if (!_file)
+    {
+        TC_LOG_ERROR("sql.driver", "Could not create the snapshot %s.tmp.", _fileName.c_str());
+        return false;
+    }
+
+    TC_LOG_INFO("sql.driver", "Snapshot %s is missing or outdated, it will be recorded during this start.", _fileName.c_str());
+    return Write(&SnapshotMagic, 4) && Write(&SnapshotVersion, 4) && Write(&key, 8);
+}
+
+bool DatabaseSnapshot::Load(uint64 key)
+{
+    boost::system::error_code error;
+    if (!boost::filesystem::exists(_fileName, error) || boost::filesystem::file_size(_fileName, error) < FileHeaderSize)
+        return false;
+
+    try
+    {
+        _mapping.open(_fileName);
+    }
+    catch (std::exception const& e)
+    {
+        TC_LOG_ERROR("sql.driver", "Could not map the snapshot %s: %s", _fileName.c_str(), e.what());
+        return false;
+    }
+
+    char const* data = _mapping.data();
+    std::size_t size = _mapping.size();
+
+    uint32 magic, version;
+    uint64 fileKey;
+    memcpy(&magic, data, 4);
+    memcpy(&version, data + 4, 4);
+    memcpy(&fileKey, data + 8, 8);
+    if (magic != SnapshotMagic || version != SnapshotVersion || fileKey != key)
+        return false;
+
+    // everything is checked once here so replaying never leaves the file
+    std::size_t pos = FileHeaderSize;
+    while (pos < size)
+    {
+        if (size - pos < EntryHeaderSize)
+            return false;
+
+        uint32 keyLength;
+        Entry entry;
+        uint64 dataSize;
+        memcpy(&keyLength, data + pos, 4);
+        memcpy(&entry.FieldCount, data + pos + 4, 4);
+        memcpy(&entry.RowCount, data + pos + 8, 8);
+        memcpy(&dataSize, data + pos + 16, 8);
+        pos += EntryHeaderSize;
+
+        if (size - pos < Align(keyLength))
+            return false;
+
+        std::string entryKey(data + pos, keyLength);
+        pos += Align(keyLength);
+
+        if (size - pos < dataSize)
+            return false;
+
+        entry.Data = data + pos;
+        std::size_t end = pos + dataSize;
+        for (uint64 i = 0; i < entry.RowCount * entry.FieldCount; ++i)
+        {
+            if (end - pos < FieldHeaderSize)
+                return false;
+
+            uint32 length;
+            memcpy(&length, data + pos, 4);
+            DatabaseFieldTypes type = DatabaseFieldTypes(uint8(data[pos + 4]));
+            uint8 flags = uint8(data[pos + 5]);
+            if (type > DatabaseFieldTypes::Binary)
+                return false;
+
+            pos += FieldHeaderSize;
+            if (flags & SNAPSHOT_FIELD_NULL)
+                continue;
+
+            std::size_t valueSize = Align(GetValueSize(type, (flags & SNAPSHOT_FIELD_RAW) != 0, length) + 1);
+            if (end - pos < valueSize)
+                return false;
+
+            pos += valueSize;
+        }
+
+        if (pos != end)
+            return false;
+
+        _entries.emplace(std::move(entryKey), entry);
+    }
+
+    return true;
+}
+
+void DatabaseSnapshot::Close()
+{
+    if (_file)
+    {
+        bool written = std::fflush(_file) == 0;
+        std::fclose(_file);
+        _file = nullptr;
+
+        boost::system::error_code error;
+        if (written)
+            boost::filesystem::rename(_fileName + ".tmp", _fileName, error);
+
+        if (!written || error)
+        {
+            TC_LOG_ERROR("sql.driver", "Could not write the snapshot %s.", _fileName.c_str());
+            boost::filesystem::remove(_fileName + ".tmp", error);
+        }
+        else
+            TC_LOG_INFO("sql.driver", "Recorded the snapshot %s.", _fileName.c_str());
+    }
+
+    _entries.clear();
+    if (_mapping.is_open())
+        _mapping.close();
+
+    if (_discarded)
+    {
+        _discarded = false;
+        boost::system::error_code error;
+        if (boost::filesystem::remove(_fileName, error))
+            TC_LOG_INFO("sql.driver", "The database was written to during loading, deleted the snapshot %s.", _fileName.c_str());
+    }
+}
+
+void DatabaseSnapshot::Discard()
+{
+    std::lock_guard<std::mutex> lock(_recordLock);
+    StopRecording();
+    _discarded = true;
+}
+
+bool DatabaseSnapshot::Replay(std::string const& key, QueryRowCallback const& callback, uint64& rowCount) const
+{
+    auto itr = _entries.find(key);
+    if (itr == _entries.end())
+        return false;
+
+    Entry const& entry = itr->second;
+    std::vector<Field> row(entry.FieldCount);
+    char const* data = entry.Data;
+    for (uint64 i = 0; i < entry.RowCount; ++i)
+    {
+        for (Field& field : row)
+        {
+            uint32 length;
+            memcpy(&length, data, 4);
+            DatabaseFieldTypes type = DatabaseFieldTypes(uint8(data[4]));
+            uint8 flags = uint8(data[5]);
+            bool raw = (flags & SNAPSHOT_FIELD_RAW) != 0;
+            data += FieldHeaderSize;
+
+            char* value = nullptr;
+            if (!(flags & SNAPSHOT_FIELD_NULL))
+            {
+                value = const_cast<char*>(data);
+                data += Align(GetValueSize(type, raw, length) + 1);
+            }
+
+            if (raw)
+                field.SetByteValue(value, type, length);
+            else
+                field.SetStructuredValue(value, type, length);
+        }
+
+        callback(row.data());
+    }
+
+    rowCount = entry.RowCount;
+    return true;
+}
+
+bool DatabaseSnapshot::BeginEntry(Recording& recording, std::string key, uint32 fieldCount)
+{
+    {
+        std::lock_guard<std::mutex> lock(_recordLock);
+        if (!_file)
+            return false;
+    }
+
+    recording.Key = std::move(key);
+    recording.FieldCount = fieldCount;
+    recording.RowCount = 0;
+    recording.Data.clear();
+    return true;
+}
+
+void DatabaseSnapshot::Record(Recording& recording, Field const* fields)
+{
+    for (uint32 i = 0; i < recording.FieldCount; ++i)
+    {
+        Field const& field = fields[i];
+        uint8 header[FieldHeaderSize] = { };
+        memcpy(header, &field.data.length, 4);
+        header[4] = uint8(field.data.type);
+        header[5] = (field.data.raw ? SNAPSHOT_FIELD_RAW : 0) | (field.data.value ? 0 : SNAPSHOT_FIELD_NULL);
+        recording.Data.insert(recording.Data.end(), header, header + FieldHeaderSize);
+        if (!field.data.value)
+            continue;
+
+        // null terminated like the values of both result set types
+        uint32 valueSize = GetValueSize(field.data.type, field.data.raw, field.data.length);
+        char const* value = static_cast<char const*>(field.data.value);
+        recording.Data.insert(recording.Data.end(), value, value + valueSize);
+        recording.Data.resize(recording.Data.size() + Align(valueSize + 1) - valueSize, '\0');
+    }
+
+    ++recording.RowCount;
+}
+
+void DatabaseSnapshot::EndEntry(Recording const& recording, bool complete)
+{
+    std::lock_guard<std::mutex> lock(_recordLock);
+    if (!_file)
+        return;
+
+    // a partial result would be replayed on every following start
+    if (!complete)
+    {
+        TC_LOG_ERROR("sql.driver", "A query did not complete, the snapshot %s is not recorded.", _fileName.c_str());
+        StopRecording();
+        return;
+    }
+
+    uint32 keyLength = uint32(recording.Key.length());
+    uint64 dataSize = recording.Data.size();
+    if (Write(&keyLength, 4) && Write(&recording.FieldCount, 4) && Write(&recording.RowCount, 8) && Write(&dataSize, 8) && Write(recording.Key.data(), keyLength))
+    {
+        Pad();
+        if (_file)
+            Write(recording.Data.data(), recording.Data.size());
+    }
+}
+
+bool DatabaseSnapshot::Write(void const* data, std::size_t size)
+{
+    if (!size || std::fwrite(data, size, 1, _file) == 1)
+        return true;
+
+    TC_LOG_ERROR("sql.driver", "Could not write the snapshot %s.", _fileName.c_str());
+    StopRecording();
+    return false;
+}
+
+void DatabaseSnapshot::Pad()
+{
+    static char const zeros[8] = { };
+    std::size_t pos = std::size_t(std::ftell(_file));
+    Write(zeros, Align(pos) - pos);
+}
+
+void DatabaseSnapshot::StopRecording()
+{
+    if (!_file)
+        return;
+
+    std::fclose(_file);
+    _file = nullptr;
+
+    boost::system::error_code error;
+    boost::filesystem::remove(_fileName + ".tmp", error);
+}
@@ -0,0 +1,92 @@
+/*
+ * This file is part of the TrinityCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DATABASESNAPSHOT_H
+#define _DATABASESNAPSHOT_H
+
+#include "Define.h"
+#include "DatabaseEnvFwd.h"
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// Local file holding the rows of the streamed queries of a previous start, so the next one reads them without asking MySQL.
+/// The file is keyed by a hash of the core revision and the database state (version and applied updates), a different key
+/// discards it and the rows are recorded again. Writes through the pool discard the file, edits of the tables from outside the core are not noticed.
+/// Values are stored 8 byte aligned and null terminated, fields of replayed rows point straight into the memory mapped file.
+class TC_DATABASE_API DatabaseSnapshot
+{
+public:
+    DatabaseSnapshot();
+    ~DatabaseSnapshot();
+
+    /// Maps the file when its key matches, otherwise starts recording a new one
+    bool Open(std::string const& fileName, uint64 key);
+    /// Finishes the file when recording and releases the mapping, replayed fields are invalid afterwards
+    void Close();
+    /// Stops recording and deletes the file on Close, the rows already mapped stay valid until then
+    void Discard();
+
+    static std::string GetKey(char const* sql) { return sql; }
+    static std::string GetKey(PreparedStatementBase const* stmt);
+
+    /// Hands the saved rows of a query to the callback, returns false if the query is not part of the snapshot
+    bool Replay(std::string const& key, QueryRowCallback const& callback, uint64& rowCount) const;
+
+    /// Rows of one streamed query, collected by the streaming thread and appended to the file as a whole once finished
+    struct Recording
+    {
+        std::string Key;
+        uint32 FieldCount = 0;
+        uint64 RowCount = 0;
+        std::vector<char> Data;
+    };
+
+    /// Record and EndEntry may only follow a BeginEntry that returned true, only EndEntry locks so concurrent streams do not wait on each other
+    bool BeginEntry(Recording& recording, std::string key, uint32 fieldCount);
+    static void Record(Recording& recording, Field const* fields);
+    void EndEntry(Recording const& recording, bool complete);
+
+private:
+    struct Entry
+    {
+        uint32 FieldCount;
+        uint64 RowCount;
+        char const* Data;
+    };
+
+    bool Load(uint64 key);
+    bool Write(void const* data, std::size_t size);
+    void Pad();
+    void StopRecording();
+
+    std::string _fileName;
+    boost::iostreams::mapped_file_source _mapping;
+    std::unordered_map<std::string, Entry> _entries;
+
+    std::mutex _recordLock;
+    std::FILE* _file;
+    bool _discarded;
+
+    DatabaseSnapshot(DatabaseSnapshot const& right) = delete;
+    DatabaseSnapshot& operator=(DatabaseSnapshot const& right) = delete;
+};
+
+#endif
@@ -0,0 +1,238 @@
+/*
+ * This file is part of the TrinityCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DatabaseWorkQueue.h"
+#include "SQLOperation.h"
+#include <algorithm>
+
+//- Lower priority operations waiting this long are served before anything else so saves are delayed but never starved
+static std::chrono::milliseconds const StarvationLimit(2000);
+
+DatabaseWorkQueue::DatabaseWorkQueue() : _shutdown(false), _nextSequence(1), _reservedWorkers(0), _registeredReservedWorkers(0)
+{
+}
+
+DatabaseWorkQueue::~DatabaseWorkQueue()
+{
+    Cancel();
+}
+
+DatabasePriority DatabaseWorkQueue::RegisterWorker()
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_registeredReservedWorkers < _reservedWorkers)
+    {
+        ++_registeredReservedWorkers;
+        return DATABASE_PRIORITY_HIGH;
+    }
+
+    return DatabasePriority(MAX_DATABASE_PRIORITY - 1);
+}
+
+void DatabaseWorkQueue::UnregisterWorker(DatabasePriority lowestPriority)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    if (lowestPriority == DATABASE_PRIORITY_HIGH && _registeredReservedWorkers)
+        --_registeredReservedWorkers;
+}
+
+void DatabaseWorkQueue::Push(SQLOperation* operation, DatabasePriority priority)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    QueuedOperation queued = { operation, std::chrono::steady_clock::now(), _nextSequence++, DatabaseOrderScope::GetCurrentKey() };
+    _lanes[priority].push_back(queued);
+    if (priority == DATABASE_PRIORITY_HIGH)
+        _queuedReads[queued.Key].insert(queued.Sequence);
+    else if (priority == DATABASE_PRIORITY_NORMAL)
+        _pendingWrites[queued.Key].insert(queued.Sequence);
+
+    // reserved workers do not take every operation, so waking a single worker is not enough
+    if (priority == DATABASE_PRIORITY_HIGH || !_reservedWorkers)
+        _condition.notify_one();
+    else
+        _condition.notify_all();
+}
+
+static bool HasEarlier(std::unordered_map<uint64, std::set<uint64>> const& sequences, uint64 key, uint64 sequence)
+{
+    auto itr = sequences.find(key);
+    return itr != sequences.end() && *itr->second.begin() < sequence;
+}
+
+static void RemoveSequence(std::unordered_map<uint64, std::set<uint64>>& sequences, uint64 key, uint64 sequence)
+{
+    auto itr = sequences.find(key);
+    if (itr == sequences.end())
+        return;
+
+    itr->second.erase(sequence);
+    if (itr->second.empty())
+        sequences.erase(itr);
+}
+
+bool DatabaseWorkQueue::CanTake(int32 lane, QueuedOperation const& queued, bool ownsEarlierWrites /*= false*/) const
+{
+    switch (lane)
+    {
+        case DATABASE_PRIORITY_HIGH:
+            // the writes pushed before must have been executed, not only taken by another worker
+            return !HasEarlier(_pendingWrites, queued.Key, queued.Sequence);
+        case DATABASE_PRIORITY_NORMAL:
+            return (ownsEarlierWrites || !HasEarlier(_pendingWrites, queued.Key, queued.Sequence)) && !HasEarlier(_queuedReads, queued.Key, queued.Sequence);
+        default:
+            return true;
+    }
+}
+
+std::size_t DatabaseWorkQueue::FindTakeable(int32 lane) const
+{
+    std::deque<QueuedOperation> const& queue = _lanes[lane];
+    for (std::size_t i = 0; i < queue.size(); ++i)
+        if (CanTake(lane, queue[i]))
+            return i;
+
+    return queue.size();
+}
+
+int32 DatabaseWorkQueue::SelectLane(DatabasePriority lowestPriority, std::chrono::steady_clock::time_point now, std::size_t& index) const
+{
+    for (int32 priority = lowestPriority; priority > DATABASE_PRIORITY_HIGH; --priority)
+        if (!_lanes[priority].empty() && now - _lanes[priority].front().QueueTime >= StarvationLimit && (index = FindTakeable(priority)) < _lanes[priority].size())
+            return priority;
+
+    for (int32 priority = DATABASE_PRIORITY_HIGH; priority <= lowestPriority; ++priority)
+        if ((index = FindTakeable(priority)) < _lanes[priority].size())
+            return priority;
+
+    return -1;
+}
+
+void DatabaseWorkQueue::WaitAndPop(std::vector<SQLOperation*>& operations, DatabasePriority lowestPriority, std::size_t maxCount, BatchPredicate canBatch)
+{
+    operations.clear();
+
+    std::unique_lock<std::mutex> lock(_lock);
+
+    int32 lane = -1;
+    std::size_t index = 0;
+    while (!_shutdown && (lane = SelectLane(lowestPriority, std::chrono::steady_clock::now(), index)) < 0)
+        _condition.wait(lock);
+
+    if (_shutdown)
+        return;
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::deque<QueuedOperation>& queue = _lanes[lane];
+    DatabaseWorkQueueStats& stats = _stats[lane];
+    uint64 const batchKey = queue[index].Key;
+    do
+    {
+        QueuedOperation const& queued = queue[index];
+        uint64 waitTime = uint64(std::chrono::duration_cast<std::chrono::microseconds>(now - queued.QueueTime).count());
+        ++stats.Processed;
+        stats.TotalWaitTime += waitTime;
+        stats.MaxWaitTime = std::max(stats.MaxWaitTime, waitTime);
+
+        operations.push_back(queued.Operation);
+        if (lane == DATABASE_PRIORITY_HIGH)
+            RemoveSequence(_queuedReads, queued.Key, queued.Sequence);
+        else if (lane == DATABASE_PRIORITY_NORMAL)
+            _runningWrites[queued.Operation] = queued;
+
+        queue.erase(queue.begin() + index);
+    } while (operations.size() < maxCount && index < queue.size() && canBatch(operations.back()) && canBatch(queue[index].Operation)
+        && CanTake(lane, queue[index], queue[index].Key == batchKey));
+
+    // writes that waited for these queries may be taken now
+    if (lane == DATABASE_PRIORITY_HIGH && !_lanes[DATABASE_PRIORITY_NORMAL].empty())
+        _condition.notify_all();
+}
+
+void DatabaseWorkQueue::Done(std::vector<SQLOperation*> const& operations)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    bool released = false;
+    for (SQLOperation* operation : operations)
+    {
+        auto itr = _runningWrites.find(operation);
+        if (itr == _runningWrites.end())
+            continue;
+
+        RemoveSequence(_pendingWrites, itr->second.Key, itr->second.Sequence);
+        _runningWrites.erase(itr);
+        released = true;
+    }
+
+    // operations waiting for these writes may be taken now
+    if (released && (!_lanes[DATABASE_PRIORITY_HIGH].empty() || !_lanes[DATABASE_PRIORITY_NORMAL].empty()))
+        _condition.notify_all();
+}
+
+void DatabaseWorkQueue::Cancel()
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    for (std::deque<QueuedOperation>& queue : _lanes)
+    {
+        for (QueuedOperation const& queued : queue)
+            delete queued.Operation;
+
+        queue.clear();
+    }
+
+    _pendingWrites.clear();
+    _queuedReads.clear();
+    _runningWrites.clear();
+    _shutdown = true;
+    _condition.notify_all();
+}
+
+std::array<DatabaseWorkQueueStats, MAX_DATABASE_PRIORITY> DatabaseWorkQueue::CollectStats()
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    std::array<DatabaseWorkQueueStats, MAX_DATABASE_PRIORITY> stats = _stats;
+    for (uint8 i = 0; i < MAX_DATABASE_PRIORITY; ++i)
+    {
+        stats[i].Depth = _lanes[i].size();
+        _stats[i] = DatabaseWorkQueueStats();
+    }
+
+    return stats;
+}
+
+namespace
+{
+    thread_local uint64 CurrentOrderKey = 0;
+}
+
+DatabaseOrderScope::DatabaseOrderScope(uint64 key) : _previousKey(CurrentOrderKey)
+{
+    CurrentOrderKey = key;
+}
+
+DatabaseOrderScope::~DatabaseOrderScope()
+{
+    CurrentOrderKey = _previousKey;
+}
+
+uint64 DatabaseOrderScope::GetCurrentKey()
+{
+    return CurrentOrderKey;
+}
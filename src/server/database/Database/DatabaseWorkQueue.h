@@ -0,0 +1,137 @@
+/*
+ * This file is part of the TrinityCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DATABASEWORKQUEUE_H
+#define _DATABASEWORKQUEUE_H
+
+#include "Define.h"
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+class SQLOperation;
+
+enum DatabasePriority : uint8
+{
+    DATABASE_PRIORITY_HIGH,                                 // queries somebody waits for (character list, login, async lookups)
+    DATABASE_PRIORITY_NORMAL,                               // statements and transactions, saves included
+    DATABASE_PRIORITY_LOW,                                  // keep alive pings
+
+    MAX_DATABASE_PRIORITY
+};
+
+struct DatabaseWorkQueueStats
+{
+    std::size_t Depth = 0;
+    uint64 Processed = 0;
+    uint64 TotalWaitTime = 0;                               // microseconds
+    uint64 MaxWaitTime = 0;                                 // microseconds
+};
+
+/// Queue shared by the async workers of a DatabaseWorkerPool with one FIFO lane per DatabasePriority.
+/// Workers take the highest priority operation first, reserved workers only serve DATABASE_PRIORITY_HIGH.
+/// Operations that waited longer than the starvation limit are taken before higher priority ones.
+/// Operations are only ordered against operations pushed with the same order key (see DatabaseOrderScope):
+/// a high priority operation waits until every write of its key pushed before it has finished executing,
+/// and a write waits for the earlier writes and still queued high priority operations of its key.
+/// Blocked operations are skipped, so one account waiting on its saves does not hold back the others.
+class TC_DATABASE_API DatabaseWorkQueue
+{
+public:
+    typedef bool(*BatchPredicate)(SQLOperation*);
+
+    DatabaseWorkQueue();
+    ~DatabaseWorkQueue();
+
+    void SetReservedWorkers(uint8 reservedWorkers) { _reservedWorkers = reservedWorkers; }
+
+    /// Returns the lowest priority the calling worker may serve
+    DatabasePriority RegisterWorker();
+    void UnregisterWorker(DatabasePriority lowestPriority);
+
+    /// Every operation that modifies the database must be pushed as DATABASE_PRIORITY_NORMAL
+    void Push(SQLOperation* operation, DatabasePriority priority);
+
+    /// Blocks until an operation of at least lowestPriority can be taken or the queue is cancelled (operations is left empty)
+    /// Pops more operations of the same lane while both the last popped and the next one satisfy canBatch
+    void WaitAndPop(std::vector<SQLOperation*>& operations, DatabasePriority lowestPriority, std::size_t maxCount, BatchPredicate canBatch);
+
+    /// Must be called by the worker once the operations returned by WaitAndPop were executed, before deleting them
+    void Done(std::vector<SQLOperation*> const& operations);
+
+    void Cancel();
+
+    /// Returns queue depths and the wait times of operations popped since the previous call
+    std::array<DatabaseWorkQueueStats, MAX_DATABASE_PRIORITY> CollectStats();
+
+private:
+    struct QueuedOperation
+    {
+        SQLOperation* Operation;
+        std::chrono::steady_clock::time_point QueueTime;
+        uint64 Sequence;
+        uint64 Key;
+    };
+
+    typedef std::unordered_map<uint64, std::set<uint64>> SequencesByKey;
+
+    /// ownsEarlierWrites is set while batching, the earlier writes of the key were popped into the same batch
+    bool CanTake(int32 lane, QueuedOperation const& queued, bool ownsEarlierWrites = false) const;
+    int32 SelectLane(DatabasePriority lowestPriority, std::chrono::steady_clock::time_point now, std::size_t& index) const;
+    std::size_t FindTakeable(int32 lane) const;
+
+    std::mutex _lock;
+    std::condition_variable _condition;
+    std::array<std::deque<QueuedOperation>, MAX_DATABASE_PRIORITY> _lanes;
+    std::array<DatabaseWorkQueueStats, MAX_DATABASE_PRIORITY> _stats;
+    bool _shutdown;
+
+    uint64 _nextSequence;
+    SequencesByKey _pendingWrites;                          // writes queued or running, until the worker reports them done
+    SequencesByKey _queuedReads;                            // high priority operations not taken yet
+    std::unordered_map<SQLOperation*, QueuedOperation> _runningWrites;
+
+    uint8 _reservedWorkers;
+    uint8 _registeredReservedWorkers;
+
+    DatabaseWorkQueue(DatabaseWorkQueue const& right) = delete;
+    DatabaseWorkQueue& operator=(DatabaseWorkQueue const& right) = delete;
+};
+
+/// Operations pushed by the thread while the scope exists carry its key, 0 is the key of all other operations.
+/// Sessions use their account id so their saves and the queries that read them back keep their order.
+class TC_DATABASE_API DatabaseOrderScope
+{
+public:
+    explicit DatabaseOrderScope(uint64 key);
+    ~DatabaseOrderScope();
+
+    static uint64 GetCurrentKey();
+
+private:
+    uint64 _previousKey;
+
+    DatabaseOrderScope(DatabaseOrderScope const& right) = delete;
+    DatabaseOrderScope& operator=(DatabaseOrderScope const& right) = delete;
+};
+
+#endif
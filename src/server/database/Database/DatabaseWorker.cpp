@@ -16,13 +16,28 @@
  */
 
 #include "DatabaseWorker.h"
+#include "AdhocStatement.h"
+#include "MySQLConnection.h"
+#include "DatabaseWorkQueue.h"
 #include "SQLOperation.h"
-#include "ProducerConsumerQueue.h"
 
-DatabaseWorker::DatabaseWorker(ProducerConsumerQueue<SQLOperation*>* newQueue, MySQLConnection* connection)
+//- Maximum ad-hoc statements sent to the server in one round trip
+static std::size_t const MaxPipelinedOperations = 16;
+//- Switching multi statements on and off costs two round trips, smaller batches are executed one by one
+static std::size_t const MinPipelinedOperations = 4;
+
+//- Prepared statements use the binary protocol which has no multi statement form, only ad-hoc statements are pipelined
+static bool CanPipeline(SQLOperation* operation)
+{
+    BasicStatementTask const* task = dynamic_cast<BasicStatementTask const*>(operation);
+    return task && task->CanPipeline();
+}
+
+DatabaseWorker::DatabaseWorker(DatabaseWorkQueue* newQueue, MySQLConnection* connection)
 {
     _connection = connection;
     _queue = newQueue;
+    _lowestPriority = _queue->RegisterWorker();
     _cancelationToken = false;
     _workerThread = std::thread(&DatabaseWorker::WorkerThread, this);
 }
@@ -34,6 +49,8 @@ DatabaseWorker::~DatabaseWorker()
     _queue->Cancel();
 
     _workerThread.join();
+
+    _queue->UnregisterWorker(_lowestPriority);
 }
 
 void DatabaseWorker::WorkerThread()
@@ -41,18 +58,54 @@ void DatabaseWorker::WorkerThread()
     if (!_queue)
         return;
 
+    std::vector<SQLOperation*> operations;
     for (;;)
     {
-        SQLOperation* operation = nullptr;
-
-        _queue->WaitAndPop(operation);
+        // consecutive ad-hoc statements are taken together, everything else is taken one by one to keep the other workers busy
+        _queue->WaitAndPop(operations, _lowestPriority, MaxPipelinedOperations, &CanPipeline);
 
-        if (_cancelationToken || !operation)
+        if (_cancelationToken || operations.empty())
+        {
+            for (SQLOperation* operation : operations)
+                delete operation;
             return;
+        }
 
-        operation->SetConnection(_connection);
-        operation->call();
+        if (operations.size() >= MinPipelinedOperations)
+            ExecutePipelined(operations.begin(), operations.end());
+        else
+        {
+            for (SQLOperation* operation : operations)
+            {
+                operation->SetConnection(_connection);
+                operation->call();
+            }
+        }
 
-        delete operation;
+        _queue->Done(operations);
+
+        for (SQLOperation* operation : operations)
+            delete operation;
+    }
+}
+
+void DatabaseWorker::ExecutePipelined(std::vector<SQLOperation*>::const_iterator begin, std::vector<SQLOperation*>::const_iterator end)
+{
+    std::vector<char const*> queries;
+    queries.reserve(std::distance(begin, end));
+    for (auto itr = begin; itr != end; ++itr)
+        queries.push_back(static_cast<BasicStatementTask*>(*itr)->GetSql());
+
+    std::vector<ResultSet*> results;
+    std::size_t executed = _connection->QueryMultiple(queries, results);
+
+    for (std::size_t i = 0; i < executed; ++i)
+        static_cast<BasicStatementTask*>(begin[i])->SetResult(results[i]);
+
+    // whatever the batch did not get to is executed on its own, including error handling and reconnects
+    for (auto itr = begin + executed; itr != end; ++itr)
+    {
+        (*itr)->SetConnection(_connection);
+        (*itr)->call();
     }
 }
@@ -21,24 +21,26 @@
 #include "Define.h"
 #include <atomic>
 #include <thread>
+#include <vector>
 
-template <typename T>
-class ProducerConsumerQueue;
-
+class DatabaseWorkQueue;
 class MySQLConnection;
 class SQLOperation;
+enum DatabasePriority : uint8;
 
 class TC_DATABASE_API DatabaseWorker
 {
     public:
-        DatabaseWorker(ProducerConsumerQueue<SQLOperation*>* newQueue, MySQLConnection* connection);
+        DatabaseWorker(DatabaseWorkQueue* newQueue, MySQLConnection* connection);
         ~DatabaseWorker();
 
     private:
-        ProducerConsumerQueue<SQLOperation*>* _queue;
+        DatabaseWorkQueue* _queue;
         MySQLConnection* _connection;
+        DatabasePriority _lowestPriority;
 
         void WorkerThread();
+        void ExecutePipelined(std::vector<SQLOperation*>::const_iterator begin, std::vector<SQLOperation*>::const_iterator end);
         std::thread _workerThread;
 
         std::atomic<bool> _cancelationToken;
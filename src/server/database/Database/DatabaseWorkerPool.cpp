@@ -18,22 +18,29 @@
 #include "DatabaseWorkerPool.h"
 #include "AdhocStatement.h"
 #include "Common.h"
+#include "DatabaseJournal.h"
+#include "DatabaseSnapshot.h"
 #include "Errors.h"
+#include "GitRevision.h"
 #include "Implementation/LoginDatabase.h"
 #include "Implementation/WorldDatabase.h"
 #include "Implementation/CharacterDatabase.h"
 #include "Implementation/HotfixDatabase.h"
 #include "Log.h"
+#include "Metric.h"
 #include "MySQLPreparedStatement.h"
 #include "PreparedStatement.h"
-#include "ProducerConsumerQueue.h"
 #include "QueryCallback.h"
 #include "QueryHolder.h"
 #include "QueryResult.h"
+#include "QueryResultCache.h"
 #include "SQLOperation.h"
 #include "Transaction.h"
 #include "MySQLWorkaround.h"
+#include <boost/filesystem/operations.hpp>
 #include <mysqld_error.h>
+#include <unordered_map>
+#include <unordered_set>
 
 #define MIN_MYSQL_SERVER_VERSION 50100u
 #define MIN_MYSQL_CLIENT_VERSION 50100u
@@ -50,8 +57,8 @@ class PingOperation : public SQLOperation
 
 template <class T>
 DatabaseWorkerPool<T>::DatabaseWorkerPool()
-    : _queue(new ProducerConsumerQueue<SQLOperation*>()),
-      _async_threads(0), _synch_threads(0)
+    : _queue(new DatabaseWorkQueue()), _resultCache(new QueryResultCache()),
+      _snapshotDiscarded(false), _async_threads(0), _synch_threads(0)
 {
     WPFatal(mysql_thread_safe(), "Used MySQL library isn't thread-safe.");
     WPFatal(mysql_get_client_version() >= MIN_MYSQL_CLIENT_VERSION, "TrinityCore does not support MySQL versions below 5.1");
@@ -67,12 +74,13 @@ DatabaseWorkerPool<T>::~DatabaseWorkerPool()
 
 template <class T>
 void DatabaseWorkerPool<T>::SetConnectionInfo(std::string const& infoString,
-    uint8 const asyncThreads, uint8 const synchThreads)
+    uint8 const asyncThreads, uint8 const synchThreads, uint8 const reservedThreads /*= 0*/)
 {
     _connectionInfo = Trinity::make_unique<MySQLConnectionInfo>(infoString);
 
     _async_threads = asyncThreads;
     _synch_threads = synchThreads;
+    _queue->SetReservedWorkers(reservedThreads);
 }
 
 template <class T>
@@ -119,9 +127,135 @@ void DatabaseWorkerPool<T>::Close()
     //! meaning there can be no concurrent access at this point.
     _connections[IDX_SYNCH].clear();
 
+    //! Transactions that were still queued stay in the journal and are replayed on the next start
+    _journal.reset();
+    _snapshot.reset();
+
     TC_LOG_INFO("sql.driver", "All connections on DatabasePool '%s' closed.", GetDatabaseName());
 }
 
+template <class T>
+bool DatabaseWorkerPool<T>::OpenJournal(std::string const& fileName, uint32 flushInterval)
+{
+    std::vector<DatabaseJournal::Entry> entries;
+    if (!DatabaseJournal::ReadPending(fileName, entries))
+        return false;
+
+    //! Entries with a row in database_journal were committed, only their done record got lost
+    std::unordered_set<uint64> committed;
+    uint64 lastId = entries.empty() ? 0 : entries.back().Id;
+    if (QueryResult result = Query("SELECT id FROM database_journal"))
+    {
+        do
+        {
+            uint64 id = (*result)[0].GetUInt64();
+            committed.insert(id);
+            lastId = std::max(lastId, id);
+        } while (result->NextRow());
+    }
+
+    //! Statement enums change between builds, prepared statements are found by their sql
+    std::unordered_map<std::string, uint32> statementIndexes;
+    for (uint32 index = 0; index < _preparedStatementSql.size(); ++index)
+        if (!_preparedStatementSql[index].empty())
+            statementIndexes.emplace(_preparedStatementSql[index], index);
+
+    //! Stops the startup on any problem, the journal file is only replaced once every entry was applied
+    std::size_t replayed = 0;
+    for (DatabaseJournal::Entry const& entry : entries)
+    {
+        if (committed.count(entry.Id))
+            continue;
+
+        SQLTransaction<T> transaction = BeginTransaction();
+        for (DatabaseJournal::Statement const& statement : entry.Statements)
+        {
+            if (!statement.IsPrepared)
+            {
+                transaction->Append(statement.Query.c_str());
+                continue;
+            }
+
+            uint32 index = statement.Index;
+            if (index >= _preparedStatementSql.size() || _preparedStatementSql[index] != statement.Query)
+            {
+                auto itr = statementIndexes.find(statement.Query);
+                if (itr == statementIndexes.end())
+                {
+                    TC_LOG_ERROR("sql.driver", "Journal of DatabasePool '%s' references prepared statement \"%s\" which no longer exists.", GetDatabaseName(), statement.Query.c_str());
+                    return false;
+                }
+
+                index = itr->second;
+            }
+
+            PreparedStatement<T>* stmt = GetPreparedStatement(PreparedStatementIndex(index));
+            DatabaseJournal::SetParameters(stmt, statement.Parameters);
+            transaction->Append(stmt);
+        }
+
+        //! A crash during the replay must not apply this entry again on the next start
+        transaction->PAppend("INSERT INTO database_journal (id) VALUES (" UI64FMTD ")", entry.Id);
+        if (!DirectCommitTransaction(transaction))
+        {
+            TC_LOG_ERROR("sql.driver", "Could not replay transaction " UI64FMTD " from the journal of DatabasePool '%s', it is kept for the next start.", entry.Id, GetDatabaseName());
+            return false;
+        }
+
+        ++replayed;
+    }
+
+    if (replayed)
+        TC_LOG_INFO("sql.driver", "Replayed " SZFMTD " unfinished transactions from the journal of DatabasePool '%s'.", replayed, GetDatabaseName());
+
+    //! Ids keep growing across restarts so rows left behind by a crash below never match a new entry
+    _journal = Trinity::make_unique<DatabaseJournal>();
+    if (!_journal->Open(fileName, flushInterval, lastId + 1, _preparedStatementSql))
+        return false;
+
+    DirectExecute("DELETE FROM database_journal");
+    return true;
+}
+
+template <class T>
+bool DatabaseWorkerPool<T>::OpenSnapshot(std::string const& fileName)
+{
+    // tables are not read to tell whether they changed, the core revision and the applied updates have to do
+    std::string state = GitRevision::GetHash();
+    for (char const* sql : { "SELECT * FROM `version`", "SELECT `name`, `hash` FROM `updates` ORDER BY `name`" })
+    {
+        if (QueryResult result = Query(sql))
+        {
+            do
+            {
+                Field* fields = result->Fetch();
+                for (uint32 i = 0; i < result->GetFieldCount(); ++i)
+                    state.append(fields[i].GetString()).push_back('\0');
+            } while (result->NextRow());
+        }
+    }
+
+    // FNV-1a
+    uint64 key = UI64LIT(14695981039346656037);
+    for (char c : state)
+        key = (key ^ uint8(c)) * UI64LIT(1099511628211);
+
+    _snapshotFileName = fileName;
+    _snapshot = Trinity::make_unique<DatabaseSnapshot>();
+    return _snapshot->Open(fileName, key);
+}
+
+template <class T>
+void DatabaseWorkerPool<T>::CloseSnapshot()
+{
+    std::lock_guard<std::mutex> lock(_snapshotLock);
+    if (!_snapshot)
+        return;
+
+    _snapshot->Close();
+    _snapshot.reset();
+}
+
 template <class T>
 bool DatabaseWorkerPool<T>::PrepareStatements()
 {
@@ -141,10 +275,16 @@ bool DatabaseWorkerPool<T>::PrepareStatements()
 
             size_t const preparedSize = connection->m_stmts.size();
             if (_preparedStatementSize.size() < preparedSize)
+            {
                 _preparedStatementSize.resize(preparedSize);
+                _preparedStatementSql.resize(preparedSize);
+            }
 
             for (size_t i = 0; i < preparedSize; ++i)
             {
+                if (MySQLPreparedStatement* stmt = connection->m_stmts[i].get())
+                    _resultCache->SetStatement(uint32(i), stmt->GetSql(), stmt->GetCacheTime(), stmt->IsCachedPerAccount());
+
                 // already set by another connection
                 // (each connection only has prepared statements of it's own type sync/async)
                 if (_preparedStatementSize[i] > 0)
@@ -153,6 +293,7 @@ bool DatabaseWorkerPool<T>::PrepareStatements()
                 if (MySQLPreparedStatement * stmt = connection->m_stmts[i].get())
                 {
                     uint32 const paramCount = stmt->GetParameterCount();
+                    _preparedStatementSql[i] = stmt->GetSql();
 
                     // TC only supports uint8 indices.
                     ASSERT(paramCount < std::numeric_limits<uint8>::max());
@@ -163,6 +304,7 @@ bool DatabaseWorkerPool<T>::PrepareStatements()
         }
     }
 
+    _resultCache->Finalize();
     return true;
 }
 
@@ -183,9 +325,66 @@ QueryResult DatabaseWorkerPool<T>::Query(const char* sql, T* connection /*= null
     return QueryResult(result);
 }
 
+template <class T>
+uint64 DatabaseWorkerPool<T>::StreamQuery(const char* sql, QueryRowCallback const& callback)
+{
+    uint64 rowCount = 0;
+    if (_snapshot && _snapshot->Replay(DatabaseSnapshot::GetKey(sql), callback, rowCount))
+        return rowCount;
+
+    bool complete;
+    T* connection = GetFreeConnection();
+    rowCount = connection->StreamQuery(sql, callback, complete, _snapshot.get());
+    connection->Unlock();
+
+    // the caller already used the rows it got, carrying on would leave it with a partly loaded table
+    WPFatal(complete, "Streamed query was interrupted after " UI64FMTD " rows, the loaded table is incomplete: %s", rowCount, sql);
+    return rowCount;
+}
+
+template <class T>
+uint64 DatabaseWorkerPool<T>::StreamQuery(PreparedStatement<T>* stmt, QueryRowCallback const& callback)
+{
+    uint64 rowCount = 0;
+    if (_snapshot && _snapshot->Replay(DatabaseSnapshot::GetKey(stmt), callback, rowCount))
+    {
+        delete stmt;
+        return rowCount;
+    }
+
+    bool complete;
+    T* connection = GetFreeConnection();
+    rowCount = connection->StreamQuery(stmt, callback, complete, _snapshot.get());
+    std::string sql = complete ? std::string() : connection->GetPreparedStatement(stmt->GetIndex())->GetSql();
+    connection->Unlock();
+
+    // the caller already used the rows it got, carrying on would leave it with a partly loaded table
+    WPFatal(complete, "Streamed query was interrupted after " UI64FMTD " rows, the loaded table is incomplete: %s", rowCount, sql.c_str());
+
+    //! Delete proxy-class. Not needed anymore
+    delete stmt;
+
+    return rowCount;
+}
+
 template <class T>
 PreparedQueryResult DatabaseWorkerPool<T>::Query(PreparedStatement<T>* stmt)
 {
+    if (_resultCache->IsCached(stmt->GetIndex()))
+    {
+        PreparedQueryResult result;
+        QueryResultCache::Ticket ticket;
+        if (!_resultCache->Get(stmt, result, ticket))
+        {
+            auto connection = GetFreeConnection();
+            result = _resultCache->Store(ticket, connection->Query(stmt));
+            connection->Unlock();
+        }
+
+        delete stmt;
+        return result;
+    }
+
     auto connection = GetFreeConnection();
     PreparedResultSet* ret = connection->Query(stmt);
     connection->Unlock();
@@ -208,17 +407,35 @@ QueryCallback DatabaseWorkerPool<T>::AsyncQuery(const char* sql)
     BasicStatementTask* task = new BasicStatementTask(sql, true);
     // Store future result before enqueueing - task might get already processed and deleted before returning from this method
     QueryResultFuture result = task->GetFuture();
-    Enqueue(task);
+    Enqueue(task, DATABASE_PRIORITY_HIGH);
     return QueryCallback(std::move(result));
 }
 
 template <class T>
 QueryCallback DatabaseWorkerPool<T>::AsyncQuery(PreparedStatement<T>* stmt)
 {
+    if (_resultCache->IsCached(stmt->GetIndex()))
+    {
+        PreparedQueryResult cached;
+        QueryResultCache::Ticket ticket;
+        if (_resultCache->Get(stmt, cached, ticket))
+        {
+            delete stmt;
+            PreparedQueryResultPromise promise;
+            promise.set_value(std::move(cached));
+            return QueryCallback(promise.get_future());
+        }
+
+        CachedPreparedStatementTask* task = new CachedPreparedStatementTask(stmt, _resultCache.get(), std::move(ticket));
+        PreparedQueryResultFuture result = task->GetFuture();
+        Enqueue(task, DATABASE_PRIORITY_HIGH);
+        return QueryCallback(std::move(result));
+    }
+
     PreparedStatementTask* task = new PreparedStatementTask(stmt, true);
     // Store future result before enqueueing - task might get already processed and deleted before returning from this method
     PreparedQueryResultFuture result = task->GetFuture();
-    Enqueue(task);
+    Enqueue(task, DATABASE_PRIORITY_HIGH);
     return QueryCallback(std::move(result));
 }
 
@@ -228,7 +445,7 @@ QueryResultHolderFuture DatabaseWorkerPool<T>::DelayQueryHolder(SQLQueryHolder<T
     SQLQueryHolderTask* task = new SQLQueryHolderTask(holder);
     // Store future result before enqueueing - task might get already processed and deleted before returning from this method
     QueryResultHolderFuture result = task->GetFuture();
-    Enqueue(task);
+    Enqueue(task, DATABASE_PRIORITY_HIGH);
     return result;
 }
 
@@ -258,7 +475,20 @@ void DatabaseWorkerPool<T>::CommitTransaction(SQLTransaction<T> transaction)
     }
 #endif // TRINITY_DEBUG
 
-    Enqueue(new TransactionTask(transaction));
+    uint64 account = DatabaseOrderScope::GetCurrentKey();
+    std::vector<uint32> invalidated = _resultCache->BeginWrite(*transaction, account);
+    if (_journal && transaction->GetJournalKey())
+    {
+        uint64 journalId = _journal->Append(*transaction);
+        //! Committed in the same transaction, a replay after a crash skips entries that have their row
+        transaction->PAppend("INSERT INTO database_journal (id) VALUES (" UI64FMTD ")", journalId);
+        if (uint64 released = _journal->TakeReleased())
+            transaction->PAppend("DELETE FROM database_journal WHERE id < " UI64FMTD, released);
+        EnqueueWrite(new JournaledTransactionTask(transaction, _journal.get(), journalId), std::move(invalidated), account);
+        return;
+    }
+
+    EnqueueWrite(new TransactionTask(transaction), std::move(invalidated), account);
 }
 
 template <class T>
@@ -283,19 +513,24 @@ TransactionCallback DatabaseWorkerPool<T>::AsyncCommitTransaction(SQLTransaction
 
     TransactionWithResultTask* task = new TransactionWithResultTask(transaction);
     TransactionFuture result = task->GetFuture();
-    Enqueue(task);
+    uint64 account = DatabaseOrderScope::GetCurrentKey();
+    EnqueueWrite(task, _resultCache->BeginWrite(*transaction, account), account);
     return TransactionCallback(std::move(result));
 }
 
 template <class T>
-void DatabaseWorkerPool<T>::DirectCommitTransaction(SQLTransaction<T>& transaction)
+bool DatabaseWorkerPool<T>::DirectCommitTransaction(SQLTransaction<T>& transaction)
 {
+    DiscardSnapshot();
+    uint64 account = DatabaseOrderScope::GetCurrentKey();
+    std::vector<uint32> invalidated = _resultCache->BeginWrite(*transaction, account);
     T* connection = GetFreeConnection();
     int errorCode = connection->ExecuteTransaction(transaction);
     if (!errorCode)
     {
         connection->Unlock();      // OK, operation succesful
-        return;
+        _resultCache->EndWrite(invalidated, account);
+        return true;
     }
 
     //! Handle MySQL Errno 1213 without extending deadlock to the core itself
@@ -305,7 +540,8 @@ void DatabaseWorkerPool<T>::DirectCommitTransaction(SQLTransaction<T>& transacti
         uint8 loopBreaker = 5;
         for (uint8 i = 0; i < loopBreaker; ++i)
         {
-            if (!connection->ExecuteTransaction(transaction))
+            errorCode = connection->ExecuteTransaction(transaction);
+            if (!errorCode)
                 break;
         }
     }
@@ -314,6 +550,8 @@ void DatabaseWorkerPool<T>::DirectCommitTransaction(SQLTransaction<T>& transacti
     transaction->Cleanup();
 
     connection->Unlock();
+    _resultCache->EndWrite(invalidated, account);
+    return !errorCode;
 }
 
 template <class T>
@@ -352,7 +590,7 @@ void DatabaseWorkerPool<T>::KeepAlive()
     //! as the sole purpose is to prevent connections from idling.
     auto const count = _connections[IDX_ASYNC].size();
     for (uint8 i = 0; i < count; ++i)
-        Enqueue(new PingOperation);
+        Enqueue(new PingOperation, DATABASE_PRIORITY_LOW);
 }
 
 template <class T>
@@ -404,9 +642,67 @@ unsigned long DatabaseWorkerPool<T>::EscapeString(char *to, const char *from, un
 }
 
 template <class T>
-void DatabaseWorkerPool<T>::Enqueue(SQLOperation* op)
+void DatabaseWorkerPool<T>::Enqueue(SQLOperation* op, DatabasePriority priority)
+{
+    _queue->Push(op, priority);
+}
+
+template <class T>
+void DatabaseWorkerPool<T>::EnqueueWrite(SQLOperation* op, std::vector<uint32> invalidated, uint64 account)
+{
+    DiscardSnapshot();
+    if (!invalidated.empty())
+        op = new QueryResultCacheWriteTask(op, _resultCache.get(), std::move(invalidated), account);
+
+    Enqueue(op, DATABASE_PRIORITY_NORMAL);
+}
+
+template <class T>
+void DatabaseWorkerPool<T>::DiscardSnapshot()
+{
+    //! Writes are not matched against the recorded queries, any of them may change a row of the snapshot
+    if (_snapshotFileName.empty() || _snapshotDiscarded.exchange(true))
+        return;
+
+    std::lock_guard<std::mutex> lock(_snapshotLock);
+    if (_snapshot)
+    {
+        //! Still mapped while loading, the file is deleted once it is closed
+        _snapshot->Discard();
+        return;
+    }
+
+    boost::system::error_code error;
+    if (boost::filesystem::remove(_snapshotFileName, error))
+        TC_LOG_INFO("sql.driver", "DatabasePool '%s' was written to, deleted the snapshot %s.", GetDatabaseName(), _snapshotFileName.c_str());
+}
+
+template <class T>
+void DatabaseWorkerPool<T>::LogMetrics()
 {
-    _queue->Push(op);
+    static char const* const PriorityNames[MAX_DATABASE_PRIORITY] = { "high", "normal", "low" };
+
+    std::array<DatabaseWorkQueueStats, MAX_DATABASE_PRIORITY> stats = _queue->CollectStats();
+    std::vector<QueryResultCache::Stats> cache = _resultCache->CollectStats();
+    if (!sMetric->IsEnabled())
+        return;
+
+    for (uint8 i = 0; i < MAX_DATABASE_PRIORITY; ++i)
+    {
+        std::vector<MetricTag> tags = { TC_METRIC_TAG("db", GetDatabaseName()), TC_METRIC_TAG("priority", PriorityNames[i]) };
+        sMetric->LogValue("db_queue_depth", uint64(stats[i].Depth), tags);
+        sMetric->LogValue("db_queue_processed", stats[i].Processed, tags);
+        sMetric->LogValue("db_queue_wait_time", stats[i].Processed ? stats[i].TotalWaitTime / stats[i].Processed : 0, tags);
+        sMetric->LogValue("db_queue_max_wait_time", stats[i].MaxWaitTime, std::move(tags));
+    }
+
+    for (QueryResultCache::Stats const& cacheStats : cache)
+    {
+        std::vector<MetricTag> tags = { TC_METRIC_TAG("db", GetDatabaseName()), TC_METRIC_TAG("statement", std::to_string(cacheStats.Index)) };
+        sMetric->LogValue("db_cache_hits", cacheStats.Hits, tags);
+        sMetric->LogValue("db_cache_misses", cacheStats.Misses, tags);
+        sMetric->LogValue("db_cache_entries", uint64(cacheStats.Entries), std::move(tags));
+    }
 }
 
 template <class T>
@@ -440,14 +736,16 @@ void DatabaseWorkerPool<T>::Execute(const char* sql)
         return;
 
     BasicStatementTask* task = new BasicStatementTask(sql);
-    Enqueue(task);
+    uint64 account = DatabaseOrderScope::GetCurrentKey();
+    EnqueueWrite(task, _resultCache->BeginWrite(sql, account), account);
 }
 
 template <class T>
 void DatabaseWorkerPool<T>::Execute(PreparedStatement<T>* stmt)
 {
     PreparedStatementTask* task = new PreparedStatementTask(stmt);
-    Enqueue(task);
+    uint64 account = DatabaseOrderScope::GetCurrentKey();
+    EnqueueWrite(task, _resultCache->BeginWrite(stmt->GetIndex(), account), account);
 }
 
 template <class T>
@@ -456,17 +754,25 @@ void DatabaseWorkerPool<T>::DirectExecute(const char* sql)
     if (Trinity::IsFormatEmptyOrNull(sql))
         return;
 
+    DiscardSnapshot();
+    uint64 account = DatabaseOrderScope::GetCurrentKey();
+    std::vector<uint32> invalidated = _resultCache->BeginWrite(sql, account);
     T* connection = GetFreeConnection();
     connection->Execute(sql);
     connection->Unlock();
+    _resultCache->EndWrite(invalidated, account);
 }
 
 template <class T>
 void DatabaseWorkerPool<T>::DirectExecute(PreparedStatement<T>* stmt)
 {
+    DiscardSnapshot();
+    uint64 account = DatabaseOrderScope::GetCurrentKey();
+    std::vector<uint32> invalidated = _resultCache->BeginWrite(stmt->GetIndex(), account);
     T* connection = GetFreeConnection();
     connection->Execute(stmt);
     connection->Unlock();
+    _resultCache->EndWrite(invalidated, account);
 
     //! Delete proxy-class. Not needed anymore
     delete stmt;
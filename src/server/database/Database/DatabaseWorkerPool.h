@@ -20,14 +20,17 @@
 
 #include "Define.h"
 #include "DatabaseEnvFwd.h"
+#include "DatabaseWorkQueue.h"
 #include "StringFormat.h"
 #include <array>
+#include <atomic>
+#include <mutex>
 #include <string>
 #include <vector>
 
-template <typename T>
-class ProducerConsumerQueue;
-
+class DatabaseJournal;
+class DatabaseSnapshot;
+class QueryResultCache;
 class SQLOperation;
 struct MySQLConnectionInfo;
 
@@ -48,12 +51,23 @@ class DatabaseWorkerPool
 
         ~DatabaseWorkerPool();
 
-        void SetConnectionInfo(std::string const& infoString, uint8 const asyncThreads, uint8 const synchThreads);
+        //! reservedThreads async workers only execute DATABASE_PRIORITY_HIGH operations (queries and query holders)
+        void SetConnectionInfo(std::string const& infoString, uint8 const asyncThreads, uint8 const synchThreads, uint8 const reservedThreads = 0);
 
         uint32 Open();
 
         void Close();
 
+        //! Replays the transactions a previous run left unfinished in the journal file, then journals
+        //! transactions with a journal key until they are executed. Needs prepared statements.
+        bool OpenJournal(std::string const& fileName, uint32 flushInterval);
+
+        //! Streamed queries are answered from the snapshot file while it matches the database state, otherwise
+        //! their rows are recorded into it. CloseSnapshot has to be called once loading is complete. The first write
+        //! through the pool deletes the file, its rows may no longer match the tables.
+        bool OpenSnapshot(std::string const& fileName);
+        void CloseSnapshot();
+
         //! Prepares all prepared statements
         bool PrepareStatements();
 
@@ -143,6 +157,17 @@ class DatabaseWorkerPool
         //! Statement must be prepared with CONNECTION_SYNCH flag.
         PreparedQueryResult Query(PreparedStatement<T>* stmt);
 
+        //! Directly executes an SQL query in string format that will block the calling thread until finished.
+        //! Every row is handed to the callback as soon as it is received instead of buffering the whole result, meant for loading big tables.
+        //! Returns the number of rows. The connection stays busy while the callback runs, it must not wait for other queries on this database.
+        //! Stops the server when the transfer breaks off after rows were handed out, the caller would otherwise keep a partial table.
+        uint64 StreamQuery(const char* sql, QueryRowCallback const& callback);
+
+        //! Directly executes an SQL query in prepared format that will block the calling thread until finished.
+        //! Rows are handed to the callback as they are received, see StreamQuery(const char*, QueryRowCallback const&).
+        //! Statement must be prepared with CONNECTION_SYNCH flag.
+        uint64 StreamQuery(PreparedStatement<T>* stmt, QueryRowCallback const& callback);
+
         /**
             Asynchronous query (with resultset) methods.
         */
@@ -178,8 +203,8 @@ class DatabaseWorkerPool
         TransactionCallback AsyncCommitTransaction(SQLTransaction<T> transaction);
 
         //! Directly executes a collection of one-way SQL operations (can be both adhoc and prepared). The order in which these operations
-        //! were appended to the transaction will be respected during execution.
-        void DirectCommitTransaction(SQLTransaction<T>& transaction);
+        //! were appended to the transaction will be respected during execution. Returns false if it could not be committed.
+        bool DirectCommitTransaction(SQLTransaction<T>& transaction);
 
         //! Method used to execute ad-hoc statements in a diverse context.
         //! Will be wrapped in a transaction if valid object is present, otherwise executed standalone.
@@ -206,12 +231,21 @@ class DatabaseWorkerPool
         //! Keeps all our MySQL connections alive, prevent the server from disconnecting us.
         void KeepAlive();
 
+        //! Number of connections synchronous queries are spread over.
+        uint8 GetSynchThreadCount() const { return _synch_threads; }
+
+        //! Sends queue depth and wait times per priority and result cache hits since the previous call through Metric.
+        void LogMetrics();
+
     private:
         uint32 OpenConnections(InternalIndex type, uint8 numConnections);
 
         unsigned long EscapeString(char *to, const char *from, unsigned long length);
 
-        void Enqueue(SQLOperation* op);
+        void Enqueue(SQLOperation* op, DatabasePriority priority);
+        //! Keeps the cached results the write invalidated from being refilled until it was executed
+        void EnqueueWrite(SQLOperation* op, std::vector<uint32> invalidated, uint64 account);
+        void DiscardSnapshot();
 
         //! Gets a free connection in the synchronous connection pool.
         //! Caller MUST call t->Unlock() after touching the MySQL context to prevent deadlocks.
@@ -220,10 +254,17 @@ class DatabaseWorkerPool
         char const* GetDatabaseName() const;
 
         //! Queue shared by async worker threads.
-        std::unique_ptr<ProducerConsumerQueue<SQLOperation*>> _queue;
+        std::unique_ptr<DatabaseWorkQueue> _queue;
+        std::unique_ptr<DatabaseJournal> _journal;
+        std::unique_ptr<QueryResultCache> _resultCache;
+        std::unique_ptr<DatabaseSnapshot> _snapshot;
+        std::string _snapshotFileName;
+        std::atomic<bool> _snapshotDiscarded;
+        std::mutex _snapshotLock;
         std::array<std::vector<std::unique_ptr<T>>, IDX_SIZE> _connections;
         std::unique_ptr<MySQLConnectionInfo> _connectionInfo;
         std::vector<uint8> _preparedStatementSize;
+        std::vector<std::string> _preparedStatementSql;        //! Query strings by statement index, for the journal
         uint8 _async_threads, _synch_threads;
 };
 
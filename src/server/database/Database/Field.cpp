@@ -26,10 +26,7 @@ Field::Field()
     data.raw = false;
 }
 
-Field::~Field()
-{
-    CleanUp();
-}
+Field::~Field() = default;
 
 uint8 Field::GetUInt8() const
 {
@@ -238,6 +235,21 @@ std::string Field::GetString() const
     return std::string(string, data.length);
 }
 
+boost::string_ref Field::GetStringRef() const
+{
+    if (!data.value)
+        return boost::string_ref();
+
+#ifdef TRINITY_DEBUG
+    if (IsNumeric() && data.raw)
+    {
+        LogWrongType(__FUNCTION__);
+        return boost::string_ref();
+    }
+#endif
+    return boost::string_ref(static_cast<char const*>(data.value), data.length);
+}
+
 std::vector<uint8> Field::GetBinary() const
 {
     std::vector<uint8> result;
@@ -260,18 +272,10 @@ void Field::SetByteValue(void* newValue, DatabaseFieldTypes newType, uint32 leng
 
 void Field::SetStructuredValue(char* newValue, DatabaseFieldTypes newType, uint32 length)
 {
-    if (data.value)
-        CleanUp();
-
     // This value stores somewhat structured data that needs function style casting
-    if (newValue)
-    {
-        data.value = new char[length + 1];
-        memcpy(data.value, newValue, length);
-        *(reinterpret_cast<char*>(data.value) + length) = '\0';
-        data.length = length;
-    }
-
+    // MYSQL_ROW values are null terminated and live until the MYSQL_RES is freed so no copy is needed
+    data.value = newValue;
+    data.length = newValue ? length : 0;
     data.type = newType;
     data.raw = false;
 }
@@ -20,6 +20,7 @@
 
 #include "Define.h"
 #include "DatabaseEnvFwd.h"
+#include <boost/utility/string_ref.hpp>
 #include <vector>
 
 enum class DatabaseFieldTypes : uint8
@@ -51,12 +52,12 @@ enum class DatabaseFieldTypes : uint8
     | BIGINT                 | GetInt64, GetUInt64                    |
     | FLOAT                  | GetFloat                               |
     | DOUBLE, DECIMAL        | GetDouble                              |
-    | CHAR, VARCHAR,         | GetCString, GetString                  |
-    | TINYTEXT, MEDIUMTEXT,  | GetCString, GetString                  |
-    | TEXT, LONGTEXT         | GetCString, GetString                  |
-    | TINYBLOB, MEDIUMBLOB,  | GetBinary, GetString                   |
-    | BLOB, LONGBLOB         | GetBinary, GetString                   |
-    | BINARY, VARBINARY      | GetBinary                              |
+    | CHAR, VARCHAR,         | GetCString, GetString, GetStringRef    |
+    | TINYTEXT, MEDIUMTEXT,  | GetCString, GetString, GetStringRef    |
+    | TEXT, LONGTEXT         | GetCString, GetString, GetStringRef    |
+    | TINYBLOB, MEDIUMBLOB,  | GetBinary, GetString, GetStringRef     |
+    | BLOB, LONGBLOB         | GetBinary, GetString, GetStringRef     |
+    | BINARY, VARBINARY      | GetBinary, GetStringRef                |
 
     Return types of aggregate functions:
 
@@ -65,11 +66,17 @@ enum class DatabaseFieldTypes : uint8
     | MIN, MAX | Same as the field |
     | SUM, AVG | DECIMAL           |
     | COUNT    | BIGINT            |
+
+    Fields never own their data, they point into memory owned by the result set
+    (the stored MYSQL_RES rows for ResultSet, the row arena for PreparedResultSet)
+    and stay valid as long as that result set is alive.
+    GetStringRef returns a view into that memory without copying.
 */
 class TC_DATABASE_API Field
 {
     friend class ResultSet;
     friend class PreparedResultSet;
+    friend class DatabaseSnapshot;
 
     public:
         Field();
@@ -92,6 +99,7 @@ class TC_DATABASE_API Field
         double GetDouble() const;
         char const* GetCString() const;
         std::string GetString() const;
+        boost::string_ref GetStringRef() const;
         std::vector<uint8> GetBinary() const;
 
         bool IsNull() const
@@ -123,14 +131,6 @@ class TC_DATABASE_API Field
         void SetByteValue(void* newValue, DatabaseFieldTypes newType, uint32 length);
         void SetStructuredValue(char* newValue, DatabaseFieldTypes newType, uint32 length);
 
-        void CleanUp()
-        {
-            // Field does not own the data if fetched with prepared statement
-            if (!data.raw)
-                delete[] ((char*)data.value);
-            data.value = NULL;
-        }
-
         bool IsType(DatabaseFieldTypes type) const;
 
         bool IsNumeric() const;
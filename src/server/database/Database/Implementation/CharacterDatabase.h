@@ -513,6 +513,7 @@ enum CharacterDatabaseStatements : uint32
     CHAR_DEL_GUILD_BANK_EVENTLOG_BY_PLAYER,
     CHAR_DEL_CHAR_GLYPHS,
     CHAR_DEL_CHAR_TALENT,
+    CHAR_DEL_CHAR_TALENT_BY_ID,
     CHAR_DEL_CHAR_PVP_TALENT,
     CHAR_DEL_CHAR_SKILLS,
     CHAR_UPD_CHAR_MONEY,
@@ -699,7 +700,7 @@ public:
 
     //- Constructors for sync and async connections
     CharacterDatabaseConnection(MySQLConnectionInfo& connInfo);
-    CharacterDatabaseConnection(ProducerConsumerQueue<SQLOperation*>* q, MySQLConnectionInfo& connInfo);
+    CharacterDatabaseConnection(DatabaseWorkQueue* q, MySQLConnectionInfo& connInfo);
     ~CharacterDatabaseConnection();
 
     //- Loads database type specific prepared statements
@@ -1261,7 +1261,7 @@ HotfixDatabaseConnection::HotfixDatabaseConnection(MySQLConnectionInfo& connInfo
 {
 }
 
-HotfixDatabaseConnection::HotfixDatabaseConnection(ProducerConsumerQueue<SQLOperation*>* q, MySQLConnectionInfo& connInfo) : MySQLConnection(q, connInfo)
+HotfixDatabaseConnection::HotfixDatabaseConnection(DatabaseWorkQueue* q, MySQLConnectionInfo& connInfo) : MySQLConnection(q, connInfo)
 {
 }
 
@@ -183,7 +183,7 @@ LoginDatabaseConnection::LoginDatabaseConnection(MySQLConnectionInfo& connInfo)
 {
 }
 
-LoginDatabaseConnection::LoginDatabaseConnection(ProducerConsumerQueue<SQLOperation*>* q, MySQLConnectionInfo& connInfo) : MySQLConnection(q, connInfo)
+LoginDatabaseConnection::LoginDatabaseConnection(DatabaseWorkQueue* q, MySQLConnectionInfo& connInfo) : MySQLConnection(q, connInfo)
 {
 }
 
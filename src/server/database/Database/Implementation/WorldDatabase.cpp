@@ -100,7 +100,7 @@ WorldDatabaseConnection::WorldDatabaseConnection(MySQLConnectionInfo& connInfo)
 {
 }
 
-WorldDatabaseConnection::WorldDatabaseConnection(ProducerConsumerQueue<SQLOperation*>* q, MySQLConnectionInfo& connInfo) : MySQLConnection(q, connInfo)
+WorldDatabaseConnection::WorldDatabaseConnection(DatabaseWorkQueue* q, MySQLConnectionInfo& connInfo) : MySQLConnection(q, connInfo)
 {
 }
 
@@ -111,7 +111,7 @@ public:
 
     //- Constructors for sync and async connections
     WorldDatabaseConnection(MySQLConnectionInfo& connInfo);
-    WorldDatabaseConnection(ProducerConsumerQueue<SQLOperation*>* q, MySQLConnectionInfo& connInfo);
+    WorldDatabaseConnection(DatabaseWorkQueue* q, MySQLConnectionInfo& connInfo);
     ~WorldDatabaseConnection();
 
     //- Loads database type specific prepared statements
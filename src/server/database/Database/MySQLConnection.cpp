@@ -17,6 +17,7 @@
 
 #include "MySQLConnection.h"
 #include "Common.h"
+#include "DatabaseSnapshot.h"
 #include "DatabaseWorker.h"
 #include "Log.h"
 #include "MySQLHacks.h"
@@ -30,6 +31,9 @@
 #include "MySQLWorkaround.h"
 #include <mysqld_error.h>
 
+//- Upper bound of statements merged into one, only powers of two are used to limit the number of prepared variants
+static uint32 const MaxBatchedStatementRows = 32;
+
 MySQLConnectionInfo::MySQLConnectionInfo(std::string const& infoString)
 {
     Tokenizer tokens(infoString, ';');
@@ -54,7 +58,7 @@ m_Mysql(NULL),
 m_connectionInfo(connInfo),
 m_connectionFlags(CONNECTION_SYNCH) { }
 
-MySQLConnection::MySQLConnection(ProducerConsumerQueue<SQLOperation*>* queue, MySQLConnectionInfo& connInfo) :
+MySQLConnection::MySQLConnection(DatabaseWorkQueue* queue, MySQLConnectionInfo& connInfo) :
 m_reconnecting(false),
 m_prepareError(false),
 m_queue(queue),
@@ -75,6 +79,7 @@ void MySQLConnection::Close()
     // Stop the worker thread before the statements are cleared
     m_worker.reset();
 
+    m_batchedStmts.clear();
     m_stmts.clear();
 
     if (m_Mysql)
@@ -161,6 +166,7 @@ uint32 MySQLConnection::Open()
 
 bool MySQLConnection::PrepareStatements()
 {
+    m_batchedStmts.clear();
     DoPrepareStatements();
     return !m_prepareError;
 }
@@ -310,6 +316,187 @@ ResultSet* MySQLConnection::Query(const char* sql)
     return new ResultSet(result, fields, rowCount, fieldCount);
 }
 
+std::size_t MySQLConnection::QueryMultiple(std::vector<char const*> const& queries, std::vector<ResultSet*>& results)
+{
+    results.clear();
+    if (!m_Mysql || !(m_connectionFlags & CONNECTION_ASYNC) || queries.empty())
+        return 0;
+
+    std::string sql;
+    for (char const* query : queries)
+    {
+        std::size_t length = strlen(query);
+        while (length && (query[length - 1] == ';' || isspace(static_cast<unsigned char>(query[length - 1]))))
+            --length;
+
+        if (!sql.empty())
+            sql += ";\n";
+        sql.append(query, length);
+    }
+
+    uint32 _s = getMSTime();
+
+    // multi statements are only enabled for the batch, a ';' in any other query can never run a second statement
+    if (mysql_set_server_option(m_Mysql, MYSQL_OPTION_MULTI_STATEMENTS_ON))
+        return 0;
+
+    // the first statement failed, it is executed again on its own to report the error
+    if (mysql_real_query(m_Mysql, sql.c_str(), static_cast<unsigned long>(sql.length())))
+    {
+        EndMultiStatements();
+        return 0;
+    }
+
+    for (std::size_t i = 0; i < queries.size(); ++i)
+    {
+        ResultSet* resultSet = nullptr;
+        if (MYSQL_RES* result = mysql_store_result(m_Mysql))
+        {
+            uint64 rowCount = mysql_affected_rows(m_Mysql);
+            uint32 fieldCount = mysql_field_count(m_Mysql);
+            if (rowCount)
+                resultSet = new ResultSet(reinterpret_cast<MySQLResult*>(result), reinterpret_cast<MySQLField*>(mysql_fetch_fields(result)), rowCount, fieldCount);
+            else
+                mysql_free_result(result);
+        }
+
+        results.push_back(resultSet);
+
+        int status = mysql_next_result(m_Mysql);
+        if (status < 0)
+            break;
+
+        if (status > 0)
+        {
+            // the server stops at the first failing statement, it counts as executed unless the connection was lost
+            uint32 lErrno = mysql_errno(m_Mysql);
+            TC_LOG_INFO("sql.sql", "SQL: %s", queries[i + 1]);
+            TC_LOG_ERROR("sql.sql", "[%u] %s", lErrno, mysql_error(m_Mysql));
+
+            if (!_HandleMySQLErrno(lErrno))
+                results.push_back(nullptr);
+            break;
+        }
+    }
+
+    EndMultiStatements();
+
+    TC_LOG_DEBUG("sql.sql", "[%u ms] SQL(%u statements): %s", getMSTimeDiff(_s, getMSTime()), uint32(queries.size()), sql.c_str());
+    return results.size();
+}
+
+void MySQLConnection::EndMultiStatements()
+{
+    // results the batch did not consume would make every following command fail with "commands out of sync"
+    while (mysql_more_results(m_Mysql) && !mysql_next_result(m_Mysql))
+        if (MYSQL_RES* result = mysql_store_result(m_Mysql))
+            mysql_free_result(result);
+
+    if (mysql_set_server_option(m_Mysql, MYSQL_OPTION_MULTI_STATEMENTS_OFF))
+    {
+        uint32 lErrno = mysql_errno(m_Mysql);
+        TC_LOG_ERROR("sql.sql", "Could not disable multi statements: [%u] %s", lErrno, mysql_error(m_Mysql));
+
+        // a connection that still accepts multi statements must not be used any further, a new one starts with them disabled
+        if (!_HandleMySQLErrno(lErrno))
+        {
+            mysql_close(m_Mysql);
+            m_Mysql = nullptr;
+            _HandleMySQLErrno(CR_CONN_HOST_ERROR);
+        }
+    }
+}
+
+uint64 MySQLConnection::StreamQuery(const char* sql, QueryRowCallback const& callback, bool& complete, DatabaseSnapshot* snapshot /*= nullptr*/)
+{
+    complete = true;
+    if (!m_Mysql || !sql)
+        return 0;
+
+    uint32 _s = getMSTime();
+
+    if (mysql_query(m_Mysql, sql))
+    {
+        uint32 lErrno = mysql_errno(m_Mysql);
+        TC_LOG_INFO("sql.sql", "SQL: %s", sql);
+        TC_LOG_ERROR("sql.sql", "[%u] %s", lErrno, mysql_error(m_Mysql));
+
+        if (_HandleMySQLErrno(lErrno))      // If it returns true, an error was handled successfully (i.e. reconnection)
+            return StreamQuery(sql, callback, complete, snapshot);    // We try again
+
+        return 0;
+    }
+
+    MYSQL_RES* result = mysql_use_result(m_Mysql);
+    if (!result)
+        return 0;
+
+    uint32 fieldCount = mysql_field_count(m_Mysql);
+    DatabaseSnapshot::Recording recording;
+    if (snapshot && !snapshot->BeginEntry(recording, DatabaseSnapshot::GetKey(sql), fieldCount))
+        snapshot = nullptr;
+
+    uint64 rowCount = 0;
+    {
+        ResultSet resultSet(reinterpret_cast<MySQLResult*>(result), reinterpret_cast<MySQLField*>(mysql_fetch_fields(result)), 0, fieldCount);
+        while (resultSet.NextRow())
+        {
+            if (snapshot)
+                DatabaseSnapshot::Record(recording, resultSet.Fetch());
+
+            callback(resultSet.Fetch());
+            ++rowCount;
+        }
+    }
+
+    // rows arrive while fetching, errors of an interrupted transfer only show up now and the query can not be repeated
+    uint32 lErrno = mysql_errno(m_Mysql);
+    if (snapshot)
+        snapshot->EndEntry(recording, !lErrno);
+
+    if (lErrno)
+    {
+        TC_LOG_INFO("sql.sql", "SQL: %s", sql);
+        TC_LOG_ERROR("sql.sql", "[%u] %s, result incomplete after " UI64FMTD " rows", lErrno, mysql_error(m_Mysql), rowCount);
+        _HandleMySQLErrno(lErrno);
+        complete = false;
+    }
+    else
+        TC_LOG_DEBUG("sql.sql", "[%u ms] SQL(streamed " UI64FMTD " rows): %s", getMSTimeDiff(_s, getMSTime()), rowCount, sql);
+
+    return rowCount;
+}
+
+uint64 MySQLConnection::StreamQuery(PreparedStatementBase* stmt, QueryRowCallback const& callback, bool& complete, DatabaseSnapshot* snapshot /*= nullptr*/)
+{
+    MySQLResult* result = NULL;
+    uint64 rowCount = 0;
+    uint32 fieldCount = 0;
+    complete = true;
+
+    if (!_Query(stmt, &result, &rowCount, &fieldCount))
+        return 0;
+
+    DatabaseSnapshot::Recording recording;
+    if (snapshot && snapshot->BeginEntry(recording, DatabaseSnapshot::GetKey(stmt), fieldCount))
+    {
+        complete = PreparedResultSet::Stream(stmt->m_stmt->GetSTMT(), result, fieldCount, [&](Field* fields)
+        {
+            DatabaseSnapshot::Record(recording, fields);
+            callback(fields);
+        }, rowCount);
+        snapshot->EndEntry(recording, complete);
+    }
+    else
+        complete = PreparedResultSet::Stream(stmt->m_stmt->GetSTMT(), result, fieldCount, callback, rowCount);
+
+    if (mysql_more_results(m_Mysql))
+    {
+        mysql_next_result(m_Mysql);
+    }
+    return rowCount;
+}
+
 bool MySQLConnection::_Query(const char* sql, MySQLResult** pResult, MySQLField** pFields, uint64* pRowCount, uint32* pFieldCount)
 {
     if (!m_Mysql)
@@ -383,7 +570,22 @@ int MySQLConnection::ExecuteTransaction(std::shared_ptr<TransactionBase> transac
             {
                 PreparedStatementBase* stmt = data.element.stmt;
                 ASSERT(stmt);
-                if (!Execute(stmt))
+
+                // consecutive rows written by the same statement (_SaveInventory, _SaveSpells...) go out as one statement,
+                // rows are never moved past other statements since those may depend on them (foreign keys)
+                if (uint32 rows = GetBatchableStatementCount(&data, queries.data() + queries.size()))
+                {
+                    if (!ExecuteBatch(&data, rows))
+                    {
+                        TC_LOG_WARN("sql.sql", "Transaction aborted. %u queries not executed.", (uint32)queries.size());
+                        int errorCode = GetLastError();
+                        RollbackTransaction();
+                        return errorCode;
+                    }
+
+                    itr += rows - 1;
+                }
+                else if (!Execute(stmt))
                 {
                     TC_LOG_WARN("sql.sql", "Transaction aborted. %u queries not executed.", (uint32)queries.size());
                     int errorCode = GetLastError();
@@ -417,6 +619,101 @@ int MySQLConnection::ExecuteTransaction(std::shared_ptr<TransactionBase> transac
     return 0;
 }
 
+uint32 MySQLConnection::GetBatchableStatementCount(SQLElementData const* first, SQLElementData const* last)
+{
+    uint32 index = first->element.stmt->m_index;
+    uint32 rows = 1;
+    while (rows < MaxBatchedStatementRows && first + rows != last && first[rows].type == SQL_ELEMENT_PREPARED && first[rows].element.stmt->m_index == index)
+        ++rows;
+
+    if (rows < 2)
+        return 0;
+
+    MySQLPreparedStatement* stmt = GetPreparedStatement(index);
+    if (!stmt || stmt->GetBatchType() == STMT_BATCH_NONE)
+        return 0;
+
+    // round down to a power of two, the remaining statements start the next batch
+    uint32 batchRows = 2;
+    while (batchRows * 2 <= rows)
+        batchRows *= 2;
+
+    return batchRows;
+}
+
+MySQLPreparedStatement* MySQLConnection::GetBatchedPreparedStatement(uint32 index, uint32 rows)
+{
+    auto itr = m_batchedStmts.find(std::make_pair(index, rows));
+    if (itr != m_batchedStmts.end())
+        return itr->second.get();
+
+    // a failed preparation is remembered as null so these statements are executed one by one from now on
+    std::unique_ptr<MySQLPreparedStatement>& batched = m_batchedStmts[std::make_pair(index, rows)];
+    std::string sql = m_stmts[index]->GetBatchQueryString(rows);
+
+    MYSQL_STMT* stmt = mysql_stmt_init(m_Mysql);
+    if (!stmt)
+    {
+        TC_LOG_ERROR("sql.sql", "In mysql_stmt_init() id: %u (batch of %u), sql: \"%s\"", index, rows, sql.c_str());
+        TC_LOG_ERROR("sql.sql", "%s", mysql_error(m_Mysql));
+    }
+    else if (mysql_stmt_prepare(stmt, sql.c_str(), static_cast<unsigned long>(sql.size())))
+    {
+        TC_LOG_ERROR("sql.sql", "In mysql_stmt_prepare() id: %u (batch of %u), sql: \"%s\"", index, rows, sql.c_str());
+        TC_LOG_ERROR("sql.sql", "%s", mysql_stmt_error(stmt));
+        mysql_stmt_close(stmt);
+    }
+    else
+        batched = Trinity::make_unique<MySQLPreparedStatement>(reinterpret_cast<MySQLStmt*>(stmt), std::move(sql));
+
+    return batched.get();
+}
+
+bool MySQLConnection::ExecuteBatch(SQLElementData const* first, uint32 rows)
+{
+    if (!m_Mysql)
+        return false;
+
+    uint32 index = first->element.stmt->m_index;
+    MySQLPreparedStatement* m_mStmt = GetBatchedPreparedStatement(index, rows);
+    if (m_mStmt)
+    {
+        m_mStmt->m_stmt = first->element.stmt;  // Cross reference them for debug output
+
+        uint32 paramCount = m_stmts[index]->GetParameterCount();
+        for (uint32 i = 0; i < rows; ++i)
+            first[i].element.stmt->BindParameters(m_mStmt, i * paramCount);
+
+        MYSQL_STMT* msql_STMT = m_mStmt->GetSTMT();
+        MYSQL_BIND* msql_BIND = m_mStmt->GetBind();
+
+        uint32 _s = getMSTime();
+
+        if (!mysql_stmt_bind_param(msql_STMT, msql_BIND) && !mysql_stmt_execute(msql_STMT))
+        {
+            TC_LOG_DEBUG("sql.sql", "[%u ms] SQL(p, %u rows): %s", getMSTimeDiff(_s, getMSTime()), rows, m_mStmt->getQueryString().c_str());
+
+            m_mStmt->ClearParameters();
+            return true;
+        }
+
+        uint32 lErrno = mysql_errno(m_Mysql);
+        TC_LOG_ERROR("sql.sql", "SQL(p, %u rows): %s\n [ERROR]: [%u] %s", rows, m_mStmt->getQueryString().c_str(), lErrno, mysql_stmt_error(msql_STMT));
+
+        m_mStmt->ClearParameters();
+
+        if (_HandleMySQLErrno(lErrno))  // If it returns true, an error was handled successfully (i.e. reconnection)
+            return ExecuteBatch(first, rows);   // Try again
+    }
+
+    // the failed batch changed nothing, run the statements one by one to get the exact error of the offending row
+    for (uint32 i = 0; i < rows; ++i)
+        if (!Execute(first[i].element.stmt))
+            return false;
+
+    return true;
+}
+
 size_t MySQLConnection::EscapeString(char* to, const char* from, size_t length)
 {
     return mysql_real_escape_string(m_Mysql, to, from, length);
@@ -458,7 +755,7 @@ MySQLPreparedStatement* MySQLConnection::GetPreparedStatement(uint32 index)
     return ret;
 }
 
-void MySQLConnection::PrepareStatement(uint32 index, std::string const& sql, ConnectionFlags flags)
+void MySQLConnection::PrepareStatement(uint32 index, std::string const& sql, ConnectionFlags flags, uint32 cacheTime /*= 0*/, QueryCacheScope cacheScope /*= CACHE_SHARED*/)
 {
     // Check if specified query should be prepared on this connection
     // i.e. don't prepare async statements on synchronous connections
@@ -486,7 +783,7 @@ void MySQLConnection::PrepareStatement(uint32 index, std::string const& sql, Con
             m_prepareError = true;
         }
         else
-            m_stmts[index] = Trinity::make_unique<MySQLPreparedStatement>(reinterpret_cast<MySQLStmt*>(stmt), sql);
+            m_stmts[index] = Trinity::make_unique<MySQLPreparedStatement>(reinterpret_cast<MySQLStmt*>(stmt), sql, cacheTime, cacheScope == CACHE_PER_ACCOUNT);
     }
 }
 
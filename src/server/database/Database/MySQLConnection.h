@@ -26,12 +26,12 @@
 #include <string>
 #include <vector>
 
-template <typename T>
-class ProducerConsumerQueue;
-
+class DatabaseSnapshot;
 class DatabaseWorker;
+class DatabaseWorkQueue;
 class MySQLPreparedStatement;
 class SQLOperation;
+struct SQLElementData;
 
 enum ConnectionFlags
 {
@@ -40,6 +40,13 @@ enum ConnectionFlags
     CONNECTION_BOTH = CONNECTION_ASYNC | CONNECTION_SYNCH
 };
 
+//! Which writes drop the cached results of a statement, see QueryResultCache
+enum QueryCacheScope
+{
+    CACHE_SHARED,                                           // every write to one of its tables
+    CACHE_PER_ACCOUNT                                       // first parameter is an account id, writes of other accounts keep the results
+};
+
 struct TC_DATABASE_API MySQLConnectionInfo
 {
     explicit MySQLConnectionInfo(std::string const& infoString);
@@ -58,7 +65,7 @@ class TC_DATABASE_API MySQLConnection
 
     public:
         MySQLConnection(MySQLConnectionInfo& connInfo);                               //! Constructor for synchronous connections.
-        MySQLConnection(ProducerConsumerQueue<SQLOperation*>* queue, MySQLConnectionInfo& connInfo);  //! Constructor for asynchronous connections.
+        MySQLConnection(DatabaseWorkQueue* queue, MySQLConnectionInfo& connInfo);  //! Constructor for asynchronous connections.
         virtual ~MySQLConnection();
 
         virtual uint32 Open();
@@ -69,7 +76,16 @@ class TC_DATABASE_API MySQLConnection
         bool Execute(const char* sql);
         bool Execute(PreparedStatementBase* stmt);
         ResultSet* Query(const char* sql);
+        /// Sends all queries in one round trip (async connections only), results receives one entry per executed query (null without rows)
+        /// Returns the number of queries executed, the caller has to run the remaining ones one by one
+        std::size_t QueryMultiple(std::vector<char const*> const& queries, std::vector<ResultSet*>& results);
         PreparedResultSet* Query(PreparedStatementBase* stmt);
+        /// Hands every row to the callback as it is received instead of storing the whole result first (mysql_use_result),
+        /// returns the number of rows. The connection can not be used for anything else until all rows were handled
+        /// Rows are also written to the snapshot if one is given
+        // complete is set to false when the transfer broke off after rows were already handed to the callback
+        uint64 StreamQuery(const char* sql, QueryRowCallback const& callback, bool& complete, DatabaseSnapshot* snapshot = nullptr);
+        uint64 StreamQuery(PreparedStatementBase* stmt, QueryRowCallback const& callback, bool& complete, DatabaseSnapshot* snapshot = nullptr);
         bool _Query(const char* sql, MySQLResult** pResult, MySQLField** pFields, uint64* pRowCount, uint32* pFieldCount);
         bool _Query(PreparedStatementBase* stmt, MySQLResult** pResult, uint64* pRowCount, uint32* pFieldCount);
 
@@ -92,7 +108,8 @@ class TC_DATABASE_API MySQLConnection
 
         uint32 GetServerVersion() const;
         MySQLPreparedStatement* GetPreparedStatement(uint32 index);
-        void PrepareStatement(uint32 index, std::string const& sql, ConnectionFlags flags);
+        //! Results of read only statements with a cacheTime (milliseconds) are cached by the pool, see QueryResultCache
+        void PrepareStatement(uint32 index, std::string const& sql, ConnectionFlags flags, uint32 cacheTime = 0, QueryCacheScope cacheScope = CACHE_SHARED);
 
         virtual void DoPrepareStatements() = 0;
 
@@ -104,8 +121,18 @@ class TC_DATABASE_API MySQLConnection
 
     private:
         bool _HandleMySQLErrno(uint32 errNo, uint8 attempts = 5);
+        //! Drains the results a multi statement query left behind and disables multi statements again
+        void EndMultiStatements();
+
+        /// Number of statements starting at first that can be sent as one batched statement
+        uint32 GetBatchableStatementCount(SQLElementData const* first, SQLElementData const* last);
+        MySQLPreparedStatement* GetBatchedPreparedStatement(uint32 index, uint32 rows);
+        bool ExecuteBatch(SQLElementData const* first, uint32 rows);
+
+        typedef std::map<std::pair<uint32, uint32>, std::unique_ptr<MySQLPreparedStatement>> BatchedStatementContainer;
+        BatchedStatementContainer m_batchedStmts;          //! Lazily prepared multi row variants of m_stmts, keyed by statement index and row count
 
-        ProducerConsumerQueue<SQLOperation*>* m_queue;      //! Queue shared with other asynchronous connections.
+        DatabaseWorkQueue*    m_queue;                      //! Queue shared with other asynchronous connections.
         std::unique_ptr<DatabaseWorker> m_worker;           //! Core worker task.
         MySQLHandle*          m_Mysql;                      //! MySQL Handle.
         MySQLConnectionInfo&  m_connectionInfo;             //! Connection info (used for logging)
@@ -20,10 +20,14 @@
 #include "Log.h"
 #include "MySQLHacks.h"
 #include "PreparedStatement.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <sstream>
 
-MySQLPreparedStatement::MySQLPreparedStatement(MySQLStmt* stmt, std::string queryString) :
-    m_stmt(nullptr), m_Mstmt(stmt), m_bind(nullptr), m_queryString(std::move(queryString))
+MySQLPreparedStatement::MySQLPreparedStatement(MySQLStmt* stmt, std::string queryString, uint32 cacheTime /*= 0*/, bool cachedPerAccount /*= false*/) :
+    m_stmt(nullptr), m_Mstmt(stmt), m_bind(nullptr), m_queryString(std::move(queryString)), m_cacheTime(cacheTime), m_cachedPerAccount(cachedPerAccount),
+    m_batchType(STMT_BATCH_NONE)
 {
     /// Initialize variable parameters
     m_paramCount = mysql_stmt_param_count(stmt);
@@ -34,6 +38,8 @@ MySQLPreparedStatement::MySQLPreparedStatement(MySQLStmt* stmt, std::string quer
     /// "If set to 1, causes mysql_stmt_store_result() to update the metadata MYSQL_FIELD->max_length value."
     MySQLBool bool_tmp = MySQLBool(1);
     mysql_stmt_attr_set(stmt, STMT_ATTR_UPDATE_MAX_LENGTH, &bool_tmp);
+
+    ParseBatchTemplate();
 }
 
 MySQLPreparedStatement::~MySQLPreparedStatement()
@@ -60,9 +66,9 @@ void MySQLPreparedStatement::ClearParameters()
     }
 }
 
-static bool ParamenterIndexAssertFail(uint32 stmtIndex, uint8 index, uint32 paramCount)
+static bool ParamenterIndexAssertFail(uint32 stmtIndex, uint32 index, uint32 paramCount)
 {
-    TC_LOG_ERROR("sql.driver", "Attempted to bind parameter %u%s on a PreparedStatement %u (statement has only %u parameters)", uint32(index) + 1, (index == 1 ? "st" : (index == 2 ? "nd" : (index == 3 ? "rd" : "nd"))), stmtIndex, paramCount);
+    TC_LOG_ERROR("sql.driver", "Attempted to bind parameter %u%s on a PreparedStatement %u (statement has only %u parameters)", index + 1, (index == 1 ? "st" : (index == 2 ? "nd" : (index == 3 ? "rd" : "nd"))), stmtIndex, paramCount);
     return false;
 }
 
@@ -80,7 +86,7 @@ static void SetParameterValue(MYSQL_BIND* param, enum_field_types type, const vo
 }
 
 //- Bind on mysql level
-void MySQLPreparedStatement::AssertValidIndex(uint8 index)
+void MySQLPreparedStatement::AssertValidIndex(uint32 index)
 {
     ASSERT(index < m_paramCount || ParamenterIndexAssertFail(m_stmt->m_index, index, m_paramCount));
 
@@ -88,7 +94,7 @@ void MySQLPreparedStatement::AssertValidIndex(uint8 index)
         TC_LOG_ERROR("sql.sql", "[ERROR] Prepared Statement (id: %u) trying to bind value on already bound index (%u).", m_stmt->m_index, index);
 }
 
-void MySQLPreparedStatement::setNull(const uint8 index)
+void MySQLPreparedStatement::setNull(const uint32 index)
 {
     AssertValidIndex(index);
     m_paramsSet[index] = true;
@@ -102,12 +108,12 @@ void MySQLPreparedStatement::setNull(const uint8 index)
     param->length = NULL;
 }
 
-void MySQLPreparedStatement::setBool(const uint8 index, const bool value)
+void MySQLPreparedStatement::setBool(const uint32 index, const bool value)
 {
     setUInt8(index, value ? 1 : 0);
 }
 
-void MySQLPreparedStatement::setUInt8(const uint8 index, const uint8 value)
+void MySQLPreparedStatement::setUInt8(const uint32 index, const uint8 value)
 {
     AssertValidIndex(index);
     m_paramsSet[index] = true;
@@ -115,7 +121,7 @@ void MySQLPreparedStatement::setUInt8(const uint8 index, const uint8 value)
     SetParameterValue(param, MYSQL_TYPE_TINY, &value, sizeof(uint8), true);
 }
 
-void MySQLPreparedStatement::setUInt16(const uint8 index, const uint16 value)
+void MySQLPreparedStatement::setUInt16(const uint32 index, const uint16 value)
 {
     AssertValidIndex(index);
     m_paramsSet[index] = true;
@@ -123,7 +129,7 @@ void MySQLPreparedStatement::setUInt16(const uint8 index, const uint16 value)
     SetParameterValue(param, MYSQL_TYPE_SHORT, &value, sizeof(uint16), true);
 }
 
-void MySQLPreparedStatement::setUInt32(const uint8 index, const uint32 value)
+void MySQLPreparedStatement::setUInt32(const uint32 index, const uint32 value)
 {
     AssertValidIndex(index);
     m_paramsSet[index] = true;
@@ -131,7 +137,7 @@ void MySQLPreparedStatement::setUInt32(const uint8 index, const uint32 value)
     SetParameterValue(param, MYSQL_TYPE_LONG, &value, sizeof(uint32), true);
 }
 
-void MySQLPreparedStatement::setUInt64(const uint8 index, const uint64 value)
+void MySQLPreparedStatement::setUInt64(const uint32 index, const uint64 value)
 {
     AssertValidIndex(index);
     m_paramsSet[index] = true;
@@ -139,7 +145,7 @@ void MySQLPreparedStatement::setUInt64(const uint8 index, const uint64 value)
     SetParameterValue(param, MYSQL_TYPE_LONGLONG, &value, sizeof(uint64), true);
 }
 
-void MySQLPreparedStatement::setInt8(const uint8 index, const int8 value)
+void MySQLPreparedStatement::setInt8(const uint32 index, const int8 value)
 {
     AssertValidIndex(index);
     m_paramsSet[index] = true;
@@ -147,7 +153,7 @@ void MySQLPreparedStatement::setInt8(const uint8 index, const int8 value)
     SetParameterValue(param, MYSQL_TYPE_TINY, &value, sizeof(int8), false);
 }
 
-void MySQLPreparedStatement::setInt16(const uint8 index, const int16 value)
+void MySQLPreparedStatement::setInt16(const uint32 index, const int16 value)
 {
     AssertValidIndex(index);
     m_paramsSet[index] = true;
@@ -155,7 +161,7 @@ void MySQLPreparedStatement::setInt16(const uint8 index, const int16 value)
     SetParameterValue(param, MYSQL_TYPE_SHORT, &value, sizeof(int16), false);
 }
 
-void MySQLPreparedStatement::setInt32(const uint8 index, const int32 value)
+void MySQLPreparedStatement::setInt32(const uint32 index, const int32 value)
 {
     AssertValidIndex(index);
     m_paramsSet[index] = true;
@@ -163,7 +169,7 @@ void MySQLPreparedStatement::setInt32(const uint8 index, const int32 value)
     SetParameterValue(param, MYSQL_TYPE_LONG, &value, sizeof(int32), false);
 }
 
-void MySQLPreparedStatement::setInt64(const uint8 index, const int64 value)
+void MySQLPreparedStatement::setInt64(const uint32 index, const int64 value)
 {
     AssertValidIndex(index);
     m_paramsSet[index] = true;
@@ -171,7 +177,7 @@ void MySQLPreparedStatement::setInt64(const uint8 index, const int64 value)
     SetParameterValue(param, MYSQL_TYPE_LONGLONG, &value, sizeof(int64), false);
 }
 
-void MySQLPreparedStatement::setFloat(const uint8 index, const float value)
+void MySQLPreparedStatement::setFloat(const uint32 index, const float value)
 {
     AssertValidIndex(index);
     m_paramsSet[index] = true;
@@ -179,7 +185,7 @@ void MySQLPreparedStatement::setFloat(const uint8 index, const float value)
     SetParameterValue(param, MYSQL_TYPE_FLOAT, &value, sizeof(float), (value > 0.0f));
 }
 
-void MySQLPreparedStatement::setDouble(const uint8 index, const double value)
+void MySQLPreparedStatement::setDouble(const uint32 index, const double value)
 {
     AssertValidIndex(index);
     m_paramsSet[index] = true;
@@ -187,7 +193,7 @@ void MySQLPreparedStatement::setDouble(const uint8 index, const double value)
     SetParameterValue(param, MYSQL_TYPE_DOUBLE, &value, sizeof(double), (value > 0.0f));
 }
 
-void MySQLPreparedStatement::setBinary(const uint8 index, const std::vector<uint8>& value, bool isString)
+void MySQLPreparedStatement::setBinary(const uint32 index, const std::vector<uint8>& value, bool isString)
 {
     AssertValidIndex(index);
     m_paramsSet[index] = true;
@@ -272,3 +278,90 @@ std::string MySQLPreparedStatement::getQueryString() const
 
     return queryString;
 }
+
+void MySQLPreparedStatement::ParseBatchTemplate()
+{
+    if (!m_paramCount)
+        return;
+
+    std::string upper(m_queryString);
+    std::transform(upper.begin(), upper.end(), upper.begin(), [](char c) { return char(std::toupper(static_cast<unsigned char>(c))); });
+
+    char const* whitespace = " \t\r\n";
+    std::size_t start = upper.find_first_not_of(whitespace);
+    std::size_t end = upper.find_last_not_of(" \t\r\n;");
+    if (start == std::string::npos || end == std::string::npos)
+        return;
+
+    if (!upper.compare(start, 6, "INSERT") || !upper.compare(start, 7, "REPLACE"))
+    {
+        // the value tuple has to end the statement (no ON DUPLICATE KEY UPDATE) and hold every parameter
+        std::size_t values = upper.rfind("VALUES");
+        if (values == std::string::npos || values == 0 || (std::isalnum(static_cast<unsigned char>(upper[values - 1])) || upper[values - 1] == '_'))
+            return;
+
+        std::size_t open = upper.find_first_not_of(whitespace, values + 6);
+        if (open == std::string::npos || upper[open] != '(' || upper[end] != ')')
+            return;
+
+        int32 depth = 0;
+        for (std::size_t pos = open; pos <= end; ++pos)
+        {
+            if (upper[pos] == '(')
+                ++depth;
+            else if (upper[pos] == ')' && !--depth && pos != end)
+                return;
+        }
+
+        if (std::count(upper.begin() + open, upper.begin() + end + 1, '?') != std::ptrdiff_t(m_paramCount))
+            return;
+
+        m_batchType = STMT_BATCH_VALUES;
+        m_batchHead = m_queryString.substr(0, open);
+        m_batchRow = m_queryString.substr(open, end + 1 - open);
+    }
+    else if (!upper.compare(start, 6, "DELETE") && m_paramCount == 1 && upper[end] == '?')
+    {
+        // only a plain equality on the single parameter, deleting a list of keys equals deleting them one by one
+        std::size_t equals = upper.find_last_not_of(whitespace, end - 1);
+        if (equals == std::string::npos || upper[equals] != '=' || equals == 0 || std::strchr("<>!:", upper[equals - 1]))
+            return;
+
+        // and only when the condition is a conjunction of such terms, NOT or OR would turn the list into something else
+        std::size_t where = upper.rfind("WHERE", equals);
+        if (where == std::string::npos)
+            return;
+
+        std::string condition = " " + upper.substr(where + 5, equals - where - 5) + " ";
+        if (condition.find_first_of("()!|^") != std::string::npos)
+            return;
+
+        for (char& c : condition)
+            if (std::isspace(static_cast<unsigned char>(c)))
+                c = ' ';
+
+        for (char const* word : { " NOT ", " OR ", " XOR " })
+            if (condition.find(word) != std::string::npos)
+                return;
+
+        m_batchType = STMT_BATCH_IN_LIST;
+        m_batchHead = m_queryString.substr(0, equals) + "IN (";
+        m_batchRow = "?";
+        m_batchTail = ")";
+    }
+}
+
+std::string MySQLPreparedStatement::GetBatchQueryString(uint32 rows) const
+{
+    std::string queryString(m_batchHead);
+    queryString.reserve(m_batchHead.length() + (m_batchRow.length() + 2) * rows + m_batchTail.length());
+    for (uint32 i = 0; i < rows; ++i)
+    {
+        if (i)
+            queryString += ", ";
+        queryString += m_batchRow;
+    }
+
+    queryString += m_batchTail;
+    return queryString;
+}
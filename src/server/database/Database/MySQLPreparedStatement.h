@@ -27,6 +27,14 @@
 class MySQLConnection;
 class PreparedStatementBase;
 
+//- How consecutive executions of the same statement in a transaction can be merged into one
+enum PreparedStatementBatchType
+{
+    STMT_BATCH_NONE,
+    STMT_BATCH_VALUES,                                      // INSERT/REPLACE ... VALUES (?, ?) -> VALUES (?, ?), (?, ?)
+    STMT_BATCH_IN_LIST                                      // DELETE ... WHERE key = ? -> WHERE key IN (?, ?)
+};
+
 //- Class of which the instances are unique per MySQLConnection
 //- access to these class objects is only done when a prepared statement task
 //- is executed.
@@ -36,39 +44,55 @@ class TC_DATABASE_API MySQLPreparedStatement
     friend class PreparedStatementBase;
 
     public:
-        MySQLPreparedStatement(MySQLStmt* stmt, std::string queryString);
+        MySQLPreparedStatement(MySQLStmt* stmt, std::string queryString, uint32 cacheTime = 0, bool cachedPerAccount = false);
         ~MySQLPreparedStatement();
 
-        void setNull(const uint8 index);
-        void setBool(const uint8 index, const bool value);
-        void setUInt8(const uint8 index, const uint8 value);
-        void setUInt16(const uint8 index, const uint16 value);
-        void setUInt32(const uint8 index, const uint32 value);
-        void setUInt64(const uint8 index, const uint64 value);
-        void setInt8(const uint8 index, const int8 value);
-        void setInt16(const uint8 index, const int16 value);
-        void setInt32(const uint8 index, const int32 value);
-        void setInt64(const uint8 index, const int64 value);
-        void setFloat(const uint8 index, const float value);
-        void setDouble(const uint8 index, const double value);
-        void setBinary(const uint8 index, const std::vector<uint8>& value, bool isString);
+        void setNull(const uint32 index);
+        void setBool(const uint32 index, const bool value);
+        void setUInt8(const uint32 index, const uint8 value);
+        void setUInt16(const uint32 index, const uint16 value);
+        void setUInt32(const uint32 index, const uint32 value);
+        void setUInt64(const uint32 index, const uint64 value);
+        void setInt8(const uint32 index, const int8 value);
+        void setInt16(const uint32 index, const int16 value);
+        void setInt32(const uint32 index, const int32 value);
+        void setInt64(const uint32 index, const int64 value);
+        void setFloat(const uint32 index, const float value);
+        void setDouble(const uint32 index, const double value);
+        void setBinary(const uint32 index, const std::vector<uint8>& value, bool isString);
 
         uint32 GetParameterCount() const { return m_paramCount; }
+        std::string const& GetSql() const { return m_queryString; }
+        uint32 GetCacheTime() const { return m_cacheTime; }
+        bool IsCachedPerAccount() const { return m_cachedPerAccount; }
+
+        PreparedStatementBatchType GetBatchType() const { return m_batchType; }
+        std::string GetBatchQueryString(uint32 rows) const;
 
     protected:
         MySQLStmt* GetSTMT() { return m_Mstmt; }
         MySQLBind* GetBind() { return m_bind; }
         PreparedStatementBase* m_stmt;
         void ClearParameters();
-        void AssertValidIndex(uint8 index);
+        void AssertValidIndex(uint32 index);
         std::string getQueryString() const;
 
     private:
+        void ParseBatchTemplate();
+
         MySQLStmt* m_Mstmt;
         uint32 m_paramCount;
         std::vector<bool> m_paramsSet;
         MySQLBind* m_bind;
         std::string const m_queryString;
+        uint32 m_cacheTime;                                 // milliseconds results are kept in the QueryResultCache of the pool
+        bool m_cachedPerAccount;                            // see CACHE_PER_ACCOUNT
+
+        //- Batched query string is m_batchHead + m_batchRow repeated (comma separated) + m_batchTail
+        PreparedStatementBatchType m_batchType;
+        std::string m_batchHead;
+        std::string m_batchRow;
+        std::string m_batchTail;
 
         MySQLPreparedStatement(MySQLPreparedStatement const& right) = delete;
         MySQLPreparedStatement& operator=(MySQLPreparedStatement const& right) = delete;
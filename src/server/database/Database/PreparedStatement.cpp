@@ -29,63 +29,106 @@ PreparedStatementBase::PreparedStatementBase(uint32 index, uint8 capacity) :
 PreparedStatementBase::~PreparedStatementBase() { }
 
 void PreparedStatementBase::BindParameters(MySQLPreparedStatement* stmt)
+{
+    BindParameters(stmt, 0);
+
+    #ifdef _DEBUG
+    if (statement_data.size() < stmt->m_paramCount)
+        TC_LOG_WARN("sql.sql", "[WARNING]: BindParameters() for statement %u did not bind all allocated parameters", m_index);
+    #endif
+}
+
+void PreparedStatementBase::BindParameters(MySQLPreparedStatement* stmt, uint32 offset)
 {
     ASSERT(stmt);
     m_stmt = stmt;
 
-    uint8 i = 0;
-    for (; i < statement_data.size(); i++)
+    for (uint32 i = 0; i < statement_data.size(); i++)
     {
         switch (statement_data[i].type)
         {
             case TYPE_BOOL:
-                stmt->setBool(i, statement_data[i].data.boolean);
+                stmt->setBool(offset + i, statement_data[i].data.boolean);
                 break;
             case TYPE_UI8:
-                stmt->setUInt8(i, statement_data[i].data.ui8);
+                stmt->setUInt8(offset + i, statement_data[i].data.ui8);
                 break;
             case TYPE_UI16:
-                stmt->setUInt16(i, statement_data[i].data.ui16);
+                stmt->setUInt16(offset + i, statement_data[i].data.ui16);
                 break;
             case TYPE_UI32:
-                stmt->setUInt32(i, statement_data[i].data.ui32);
+                stmt->setUInt32(offset + i, statement_data[i].data.ui32);
                 break;
             case TYPE_I8:
-                stmt->setInt8(i, statement_data[i].data.i8);
+                stmt->setInt8(offset + i, statement_data[i].data.i8);
                 break;
             case TYPE_I16:
-                stmt->setInt16(i, statement_data[i].data.i16);
+                stmt->setInt16(offset + i, statement_data[i].data.i16);
                 break;
             case TYPE_I32:
-                stmt->setInt32(i, statement_data[i].data.i32);
+                stmt->setInt32(offset + i, statement_data[i].data.i32);
                 break;
             case TYPE_UI64:
-                stmt->setUInt64(i, statement_data[i].data.ui64);
+                stmt->setUInt64(offset + i, statement_data[i].data.ui64);
                 break;
             case TYPE_I64:
-                stmt->setInt64(i, statement_data[i].data.i64);
+                stmt->setInt64(offset + i, statement_data[i].data.i64);
                 break;
             case TYPE_FLOAT:
-                stmt->setFloat(i, statement_data[i].data.f);
+                stmt->setFloat(offset + i, statement_data[i].data.f);
                 break;
             case TYPE_DOUBLE:
-                stmt->setDouble(i, statement_data[i].data.d);
+                stmt->setDouble(offset + i, statement_data[i].data.d);
                 break;
             case TYPE_STRING:
-                stmt->setBinary(i, statement_data[i].binary, true);
+                stmt->setBinary(offset + i, statement_data[i].binary, true);
                 break;
             case TYPE_BINARY:
-                stmt->setBinary(i, statement_data[i].binary, false);
+                stmt->setBinary(offset + i, statement_data[i].binary, false);
                 break;
             case TYPE_NULL:
-                stmt->setNull(i);
+                stmt->setNull(offset + i);
                 break;
         }
     }
-    #ifdef _DEBUG
-    if (i < stmt->m_paramCount)
-        TC_LOG_WARN("sql.sql", "[WARNING]: BindParameters() for statement %u did not bind all allocated parameters", m_index);
-    #endif
+}
+
+std::size_t PreparedStatementBase::GetPayloadSize() const
+{
+    std::size_t size = 0;
+    for (PreparedStatementData const& data : statement_data)
+    {
+        switch (data.type)
+        {
+            case TYPE_BOOL:
+            case TYPE_UI8:
+            case TYPE_I8:
+                size += 1;
+                break;
+            case TYPE_UI16:
+            case TYPE_I16:
+                size += 2;
+                break;
+            case TYPE_UI32:
+            case TYPE_I32:
+            case TYPE_FLOAT:
+                size += 4;
+                break;
+            case TYPE_UI64:
+            case TYPE_I64:
+            case TYPE_DOUBLE:
+                size += 8;
+                break;
+            case TYPE_STRING:
+            case TYPE_BINARY:
+                size += data.binary.size();
+                break;
+            case TYPE_NULL:
+                break;
+        }
+    }
+
+    return size;
 }
 
 //- Bind to buffer
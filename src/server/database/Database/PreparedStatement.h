@@ -78,6 +78,8 @@ class TC_DATABASE_API PreparedStatementBase
     friend class PreparedStatementTask;
     friend class MySQLPreparedStatement;
     friend class MySQLConnection;
+    friend class DatabaseJournal;
+    friend class QueryResultCache;
 
     public:
         explicit PreparedStatementBase(uint32 index, uint8 capacity);
@@ -99,9 +101,12 @@ class TC_DATABASE_API PreparedStatementBase
         void setNull(const uint8 index);
 
         uint32 GetIndex() const { return m_index; }
+        std::size_t GetPayloadSize() const;
 
     protected:
         void BindParameters(MySQLPreparedStatement* stmt);
+        //- Binds the parameters as one row of a batched statement, starting at parameter offset
+        void BindParameters(MySQLPreparedStatement* stmt, uint32 offset);
 
     protected:
         MySQLPreparedStatement* m_stmt;
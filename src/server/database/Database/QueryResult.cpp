@@ -21,6 +21,7 @@
 #include "Log.h"
 #include "MySQLHacks.h"
 #include "MySQLWorkaround.h"
+#include <algorithm>
 
 static uint32 SizeForType(MYSQL_FIELD* field)
 {
@@ -116,6 +117,27 @@ DatabaseFieldTypes MysqlTypeToFieldType(enum_field_types type)
     return DatabaseFieldTypes::Null;
 }
 
+//- Fetches a variable length value that was bound without a buffer into buffer, returns the length fetched
+static unsigned long FetchColumn(MySQLStmt* stmt, MySQLBind const& bind, uint32 index, char* buffer, unsigned long length)
+{
+    unsigned long columnLength = 0;
+    MySQLBool columnIsNull = 0;
+    MySQLBool columnError = 0;
+    MySQLBind columnBind = bind;
+    columnBind.buffer = buffer;
+    columnBind.buffer_length = length;
+    columnBind.length = &columnLength;
+    columnBind.is_null = &columnIsNull;
+    columnBind.error = &columnError;
+    if (mysql_stmt_fetch_column(stmt, &columnBind, index, 0))
+    {
+        TC_LOG_WARN("sql.sql", "%s:mysql_stmt_fetch_column, cannot fetch column %u. Error: %s", __FUNCTION__, index, mysql_stmt_error(stmt));
+        return 0;
+    }
+
+    return length;
+}
+
 ResultSet::ResultSet(MySQLResult* result, MySQLField* fields, uint64 rowCount, uint32 fieldCount) :
 _rowCount(rowCount),
 _fieldCount(fieldCount),
@@ -135,7 +157,10 @@ m_rowPosition(0),
 m_fieldCount(fieldCount),
 m_rBind(NULL),
 m_stmt(stmt),
-m_metadataResult(result)
+m_metadataResult(result),
+m_dataCursor(nullptr),
+m_dataFree(0),
+m_dataBlockSize(0)
 {
     if (!m_metadataResult)
         return;
@@ -171,27 +196,41 @@ m_metadataResult(result)
     m_rowCount = mysql_stmt_num_rows(m_stmt);
 
     //- This is where we prepare the buffer based on metadata
+    // Fixed size values are fetched straight into the row arena. Variable length values (strings, blobs, decimals)
+    // are bound without a buffer so mysql_stmt_fetch only reports their length, they are then fetched
+    // into an exactly sized, null terminated arena slice instead of reserving max_length for every row
     MySQLField* field = reinterpret_cast<MySQLField*>(mysql_fetch_fields(m_metadataResult));
-    std::size_t rowSize = 0;
+    std::vector<std::size_t> fixedOffsets(m_fieldCount, 0);
+    std::vector<bool> variableLength(m_fieldCount, false);
+    std::size_t fixedRowSize = 0;
+    std::size_t estimatedRowSize = 0;
     for (uint32 i = 0; i < m_fieldCount; ++i)
     {
-        uint32 size = SizeForType(&field[i]);
-        rowSize += size;
+        DatabaseFieldTypes type = MysqlTypeToFieldType(field[i].type);
+        variableLength[i] = type == DatabaseFieldTypes::Binary || type == DatabaseFieldTypes::Decimal;
+        if (variableLength[i])
+        {
+            estimatedRowSize += std::min<std::size_t>(field[i].max_length, 64) + 1;
+        }
+        else
+        {
+            uint32 size = SizeForType(&field[i]);
+            std::size_t alignment = std::min<std::size_t>(size ? size : 1, 8);
+            fixedRowSize = (fixedRowSize + alignment - 1) / alignment * alignment;
+            fixedOffsets[i] = fixedRowSize;
+            fixedRowSize += size;
+            m_rBind[i].buffer_length = size;
+        }
 
         m_rBind[i].buffer_type = field[i].type;
-        m_rBind[i].buffer_length = size;
         m_rBind[i].length = &m_length[i];
         m_rBind[i].is_null = &m_isNull[i];
         m_rBind[i].error = NULL;
         m_rBind[i].is_unsigned = field[i].flags & UNSIGNED_FLAG;
     }
 
-    char* dataBuffer = new char[rowSize * m_rowCount];
-    for (uint32 i = 0, offset = 0; i < m_fieldCount; ++i)
-    {
-        m_rBind[i].buffer = dataBuffer + offset;
-        offset += m_rBind[i].buffer_length;
-    }
+    estimatedRowSize += fixedRowSize + 8;
+    m_dataBlockSize = std::min<std::size_t>(std::max<std::size_t>(estimatedRowSize * m_rowCount, 256), 4 * 1024 * 1024);
 
     //- This is where we bind the bind the buffer to the statement
     if (mysql_stmt_bind_result(m_stmt, m_rBind))
@@ -205,53 +244,38 @@ m_metadataResult(result)
     }
 
     m_rows.resize(uint32(m_rowCount) * m_fieldCount);
-    while (_NextRow())
+    while (m_rowPosition < m_rowCount)
     {
+        char* rowData = AllocateData(fixedRowSize, 8);
+        for (uint32 fIndex = 0; fIndex < m_fieldCount; ++fIndex)
+            if (!variableLength[fIndex])
+                m_stmt->bind[fIndex].buffer = rowData + fixedOffsets[fIndex];
+
+        if (!_NextRow())
+            break;
+
         for (uint32 fIndex = 0; fIndex < m_fieldCount; ++fIndex)
         {
-            unsigned long buffer_length = m_rBind[fIndex].buffer_length;
+            Field& rowField = m_rows[uint32(m_rowPosition) * m_fieldCount + fIndex];
+            DatabaseFieldTypes type = MysqlTypeToFieldType(m_rBind[fIndex].buffer_type);
             unsigned long fetched_length = *m_rBind[fIndex].length;
-            if (!*m_rBind[fIndex].is_null)
+            if (*m_rBind[fIndex].is_null)
+                rowField.SetByteValue(nullptr, type, fetched_length);
+            else if (variableLength[fIndex])
             {
-                void* buffer = m_stmt->bind[fIndex].buffer;
-                switch (m_rBind[fIndex].buffer_type)
-                {
-                    case MYSQL_TYPE_TINY_BLOB:
-                    case MYSQL_TYPE_MEDIUM_BLOB:
-                    case MYSQL_TYPE_LONG_BLOB:
-                    case MYSQL_TYPE_BLOB:
-                    case MYSQL_TYPE_STRING:
-                    case MYSQL_TYPE_VAR_STRING:
-                        // warning - the string will not be null-terminated if there is no space for it in the buffer
-                        // when mysql_stmt_fetch returned MYSQL_DATA_TRUNCATED
-                        // we cannot blindly null-terminate the data either as it may be retrieved as binary blob and not specifically a string
-                        // in this case using Field::GetCString will result in garbage
-                        // TODO: remove Field::GetCString and use boost::string_ref (currently proposed for TS as string_view, maybe in C++17)
-                        if (fetched_length < buffer_length)
-                            *((char*)buffer + fetched_length) = '\0';
-                        break;
-                    default:
-                        break;
-                }
-
-                m_rows[uint32(m_rowPosition) * m_fieldCount + fIndex].SetByteValue(
-                    buffer,
-                    MysqlTypeToFieldType(m_rBind[fIndex].buffer_type),
-                    fetched_length);
-
-                // move buffer pointer to next part
-                m_stmt->bind[fIndex].buffer = (char*)buffer + rowSize;
+                char* value = AllocateData(fetched_length + 1, 1);
+                if (fetched_length)
+                    fetched_length = FetchColumn(m_stmt, m_rBind[fIndex], fIndex, value, fetched_length);
+
+                // always null terminated, Field::GetCString is safe on any string or blob
+                value[fetched_length] = '\0';
+                rowField.SetByteValue(value, type, fetched_length);
             }
             else
-            {
-                m_rows[uint32(m_rowPosition) * m_fieldCount + fIndex].SetByteValue(
-                    nullptr,
-                    MysqlTypeToFieldType(m_rBind[fIndex].buffer_type),
-                    *m_rBind[fIndex].length);
-            }
+                rowField.SetByteValue(m_stmt->bind[fIndex].buffer, type, fetched_length);
 
 #ifdef TRINITY_DEBUG
-            m_rows[uint32(m_rowPosition) * m_fieldCount + fIndex].SetMetadata(&field[fIndex], fIndex);
+            rowField.SetMetadata(&field[fIndex], fIndex);
 #endif
         }
         m_rowPosition++;
@@ -262,6 +286,117 @@ m_metadataResult(result)
     mysql_stmt_free_result(m_stmt);
 }
 
+PreparedResultSet::PreparedResultSet(std::shared_ptr<PreparedResultSet const> source) :
+m_rows(source->m_rows),
+m_rowCount(source->m_rowCount),
+m_rowPosition(0),
+m_fieldCount(source->m_fieldCount),
+m_rBind(nullptr),
+m_stmt(nullptr),
+m_metadataResult(nullptr),
+m_source(std::move(source)),
+m_dataCursor(nullptr),
+m_dataFree(0),
+m_dataBlockSize(0)
+{
+}
+
+bool PreparedResultSet::Stream(MySQLStmt* stmt, MySQLResult* result, uint32 fieldCount, QueryRowCallback const& callback, uint64& rowCount)
+{
+    rowCount = 0;
+    if (!result)
+        return true;
+
+    if (stmt->bind_result_done)
+    {
+        delete[] stmt->bind->length;
+        delete[] stmt->bind->is_null;
+    }
+
+    // handed over to the statement the same way the constructor does
+    MySQLBool* isNull = new MySQLBool[fieldCount];
+    unsigned long* length = new unsigned long[fieldCount];
+    std::unique_ptr<MySQLBind[]> bind(new MySQLBind[fieldCount]);
+
+    memset(isNull, 0, sizeof(MySQLBool) * fieldCount);
+    memset(bind.get(), 0, sizeof(MySQLBind) * fieldCount);
+    memset(length, 0, sizeof(unsigned long) * fieldCount);
+
+    // Without mysql_stmt_store_result only one row exists at a time, every field gets a buffer that is reused for all rows.
+    // Fixed size values are fetched straight into it, variable length ones are fetched afterwards and grow it when needed
+    MySQLField* field = reinterpret_cast<MySQLField*>(mysql_fetch_fields(result));
+    std::vector<std::vector<char>> values(fieldCount);
+    std::vector<bool> variableLength(fieldCount, false);
+    std::vector<Field> row(fieldCount);
+    for (uint32 i = 0; i < fieldCount; ++i)
+    {
+        DatabaseFieldTypes type = MysqlTypeToFieldType(field[i].type);
+        variableLength[i] = type == DatabaseFieldTypes::Binary || type == DatabaseFieldTypes::Decimal;
+        if (!variableLength[i])
+        {
+            values[i].resize(SizeForType(&field[i]));
+            bind[i].buffer = values[i].data();
+            bind[i].buffer_length = values[i].size();
+        }
+
+        bind[i].buffer_type = field[i].type;
+        bind[i].length = &length[i];
+        bind[i].is_null = &isNull[i];
+        bind[i].error = NULL;
+        bind[i].is_unsigned = field[i].flags & UNSIGNED_FLAG;
+
+#ifdef TRINITY_DEBUG
+        row[i].SetMetadata(&field[i], i);
+#endif
+    }
+
+    if (mysql_stmt_bind_result(stmt, bind.get()))
+    {
+        TC_LOG_WARN("sql.sql", "%s:mysql_stmt_bind_result, cannot bind result from MySQL server. Error: %s", __FUNCTION__, mysql_stmt_error(stmt));
+        mysql_stmt_free_result(stmt);
+        mysql_free_result(result);
+        delete[] isNull;
+        delete[] length;
+        return false;
+    }
+
+    int status;
+    while ((status = mysql_stmt_fetch(stmt)) == 0 || status == MYSQL_DATA_TRUNCATED)
+    {
+        for (uint32 fIndex = 0; fIndex < fieldCount; ++fIndex)
+        {
+            DatabaseFieldTypes type = MysqlTypeToFieldType(bind[fIndex].buffer_type);
+            unsigned long fetched_length = length[fIndex];
+            if (isNull[fIndex])
+                row[fIndex].SetByteValue(nullptr, type, fetched_length);
+            else if (variableLength[fIndex])
+            {
+                std::vector<char>& value = values[fIndex];
+                if (value.size() < fetched_length + 1)
+                    value.resize(fetched_length + 1);
+
+                if (fetched_length)
+                    fetched_length = FetchColumn(stmt, bind[fIndex], fIndex, value.data(), fetched_length);
+
+                value[fetched_length] = '\0';
+                row[fIndex].SetByteValue(value.data(), type, fetched_length);
+            }
+            else
+                row[fIndex].SetByteValue(values[fIndex].data(), type, fetched_length);
+        }
+
+        callback(row.data());
+        ++rowCount;
+    }
+
+    if (status != MYSQL_NO_DATA)
+        TC_LOG_ERROR("sql.sql", "%s:mysql_stmt_fetch, result incomplete after " UI64FMTD " rows. Error: %s", __FUNCTION__, rowCount, mysql_stmt_error(stmt));
+
+    mysql_stmt_free_result(stmt);
+    mysql_free_result(result);
+    return status == MYSQL_NO_DATA;
+}
+
 ResultSet::~ResultSet()
 {
     CleanUp();
@@ -339,16 +474,42 @@ void ResultSet::CleanUp()
 void PreparedResultSet::CleanUp()
 {
     if (m_metadataResult)
+    {
         mysql_free_result(m_metadataResult);
+        m_metadataResult = nullptr;
+    }
 
     if (m_rBind)
     {
-        delete[](char*)m_rBind->buffer;
         delete[] m_rBind;
         m_rBind = nullptr;
     }
 }
 
+char* PreparedResultSet::AllocateData(std::size_t size, std::size_t alignment)
+{
+    // values much larger than a block get one of their own so the current block is not abandoned
+    if (size > m_dataBlockSize / 2)
+    {
+        m_dataBlocks.emplace_back(new char[size]);
+        return m_dataBlocks.back().get();
+    }
+
+    std::size_t padding = m_dataCursor ? (alignment - reinterpret_cast<uintptr_t>(m_dataCursor) % alignment) % alignment : 0;
+    if (!m_dataCursor || padding + size > m_dataFree)
+    {
+        m_dataBlocks.emplace_back(new char[m_dataBlockSize]);
+        m_dataCursor = m_dataBlocks.back().get();
+        m_dataFree = m_dataBlockSize;
+        padding = 0;
+    }
+
+    char* data = m_dataCursor + padding;
+    m_dataCursor += padding + size;
+    m_dataFree -= padding + size;
+    return data;
+}
+
 Field const& ResultSet::operator[](std::size_t index) const
 {
     ASSERT(index < _fieldCount);
@@ -20,6 +20,7 @@
 
 #include "Define.h"
 #include "DatabaseEnvFwd.h"
+#include <memory>
 #include <vector>
 
 class TC_DATABASE_API ResultSet
@@ -53,6 +54,8 @@ class TC_DATABASE_API PreparedResultSet
 {
     public:
         PreparedResultSet(MySQLStmt* stmt, MySQLResult* result, uint64 rowCount, uint32 fieldCount);
+        //- Shares the rows of a cached result, only the read position is separate
+        explicit PreparedResultSet(std::shared_ptr<PreparedResultSet const> source);
         ~PreparedResultSet();
 
         bool NextRow();
@@ -62,6 +65,9 @@ class TC_DATABASE_API PreparedResultSet
         Field* Fetch() const;
         Field const& operator[](std::size_t index) const;
 
+        //- Fetches the rows of an executed statement one by one without storing the result, returns false if not all rows were received
+        static bool Stream(MySQLStmt* stmt, MySQLResult* result, uint32 fieldCount, QueryRowCallback const& callback, uint64& rowCount);
+
     protected:
         std::vector<Field> m_rows;
         uint64 m_rowCount;
@@ -72,9 +78,17 @@ class TC_DATABASE_API PreparedResultSet
         MySQLBind* m_rBind;
         MySQLStmt* m_stmt;
         MySQLResult* m_metadataResult;    ///< Field metadata, returned by mysql_stmt_result_metadata
+        std::shared_ptr<PreparedResultSet const> m_source;    ///< Owner of the values when sharing a cached result
+
+        // Arena holding the values of all rows, m_rows fields point into it
+        std::vector<std::unique_ptr<char[]>> m_dataBlocks;
+        char* m_dataCursor;
+        std::size_t m_dataFree;
+        std::size_t m_dataBlockSize;
 
         void CleanUp();
         bool _NextRow();
+        char* AllocateData(std::size_t size, std::size_t alignment);
 
         PreparedResultSet(PreparedResultSet const& right) = delete;
         PreparedResultSet& operator=(PreparedResultSet const& right) = delete;
@@ -0,0 +1,491 @@
+/*
+ * This file is part of the TrinityCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "QueryResultCache.h"
+#include "Log.h"
+#include "MySQLConnection.h"
+#include "PreparedStatement.h"
+#include "QueryResult.h"
+#include "Transaction.h"
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+
+//- Cached results per statement, the statement starts over once exceeded
+static std::size_t const MaxEntriesPerStatement = 4096;
+
+QueryResultCache::QueryResultCache()
+{
+}
+
+void QueryResultCache::SetStatement(uint32 index, std::string const& sql, uint32 cacheTime, bool perAccount)
+{
+    if (_statements.size() <= index)
+        _statements.resize(index + 1);
+
+    StatementInfo& info = _statements[index];
+    info.Tables.clear();
+    for (std::string const& table : ParseTables(sql, info.IsWrite))
+    {
+        auto itr = _tableIds.emplace(table, uint32(_tableIds.size())).first;
+        info.Tables.push_back(itr->second);
+    }
+
+    if (cacheTime && info.IsWrite)
+    {
+        TC_LOG_ERROR("sql.sql", "Prepared statement %u has a cache time but does not only read, it will not be cached.", index);
+        cacheTime = 0;
+    }
+
+    info.CacheTime = std::chrono::milliseconds(cacheTime);
+    info.PerAccount = cacheTime && perAccount;
+}
+
+void QueryResultCache::Finalize()
+{
+    _tableReaders.assign(_tableIds.size(), std::vector<uint32>());
+    _allCachedStatements.clear();
+    for (uint32 index = 0; index < _statements.size(); ++index)
+    {
+        if (!IsCached(index))
+            continue;
+
+        _allCachedStatements.push_back(index);
+        for (uint32 table : _statements[index].Tables)
+            _tableReaders[table].push_back(index);
+    }
+
+    for (StatementInfo& info : _statements)
+    {
+        info.Invalidates.clear();
+        if (!info.IsWrite)
+            continue;
+
+        // writes to tables we could not find are assumed to affect everything
+        if (info.Tables.empty())
+            info.Invalidates = _allCachedStatements;
+
+        for (uint32 table : info.Tables)
+            info.Invalidates.insert(info.Invalidates.end(), _tableReaders[table].begin(), _tableReaders[table].end());
+
+        std::sort(info.Invalidates.begin(), info.Invalidates.end());
+        info.Invalidates.erase(std::unique(info.Invalidates.begin(), info.Invalidates.end()), info.Invalidates.end());
+    }
+}
+
+bool QueryResultCache::Get(PreparedStatementBase const* stmt, PreparedQueryResult& result, Ticket& ticket)
+{
+    ticket.Index = stmt->GetIndex();
+    ticket.Key = GetKey(stmt);
+
+    std::shared_ptr<PreparedResultSet const> cached;
+    {
+        TimePoint now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(_lock);
+        StatementInfo& info = _statements[ticket.Index];
+        ticket.Generation = info.Generation;
+        ticket.Account = info.PerAccount ? GetAccount(stmt) : 0;
+
+        auto account = info.Accounts.find(ticket.Account);
+        bool accountPending = account != info.Accounts.end() && account->second.PendingWrites;
+        ticket.AccountGeneration = account != info.Accounts.end() ? account->second.Generation : 0;
+
+        auto itr = info.Entries.find(ticket.Key);
+        if (itr == info.Entries.end() || info.PendingWrites || accountPending || itr->second.Expires <= now)
+        {
+            if (itr != info.Entries.end())
+                info.Entries.erase(itr);
+
+            ++info.Misses;
+            return false;
+        }
+
+        ++info.Hits;
+        cached = itr->second.Result;
+    }
+
+    result = cached ? std::make_shared<PreparedResultSet>(std::move(cached)) : nullptr;
+    return true;
+}
+
+PreparedQueryResult QueryResultCache::Store(Ticket const& ticket, PreparedResultSet* result)
+{
+    if (result && !result->GetRowCount())
+    {
+        delete result;
+        result = nullptr;
+    }
+
+    // the cache only hands out views, so the first caller can keep the original
+    PreparedQueryResult stored(result);
+
+    TimePoint now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(_lock);
+    StatementInfo& info = _statements[ticket.Index];
+    if (info.Generation != ticket.Generation || info.PendingWrites)
+        return stored;
+
+    auto account = info.Accounts.find(ticket.Account);
+    if (account != info.Accounts.end() && (account->second.Generation != ticket.AccountGeneration || account->second.PendingWrites))
+        return stored;
+
+    if (info.Entries.size() >= MaxEntriesPerStatement)
+        info.Entries.clear();
+
+    CacheEntry& entry = info.Entries[ticket.Key];
+    entry.Result = stored;
+    entry.Expires = now + info.CacheTime;
+    entry.Account = ticket.Account;
+    return stored;
+}
+
+std::vector<uint32> QueryResultCache::BeginWrite(uint32 index, uint64 account)
+{
+    if (_allCachedStatements.empty() || index >= _statements.size() || _statements[index].Invalidates.empty())
+        return { };
+
+    std::vector<uint32> statements = _statements[index].Invalidates;
+    Invalidate(statements, account);
+    return statements;
+}
+
+std::vector<uint32> QueryResultCache::BeginWrite(char const* sql, uint64 account)
+{
+    if (_allCachedStatements.empty())
+        return { };
+
+    std::vector<uint32> statements = GetInvalidatedStatements(sql);
+    Invalidate(statements, account);
+    return statements;
+}
+
+std::vector<uint32> QueryResultCache::BeginWrite(TransactionBase const& transaction, uint64 account)
+{
+    if (_allCachedStatements.empty())
+        return { };
+
+    std::vector<uint32> statements;
+    for (SQLElementData const& element : transaction.m_queries)
+    {
+        if (element.type == SQL_ELEMENT_RAW)
+        {
+            std::vector<uint32> invalidated = GetInvalidatedStatements(element.element.query);
+            statements.insert(statements.end(), invalidated.begin(), invalidated.end());
+        }
+        else if (element.element.stmt->GetIndex() < _statements.size())
+        {
+            std::vector<uint32> const& invalidated = _statements[element.element.stmt->GetIndex()].Invalidates;
+            statements.insert(statements.end(), invalidated.begin(), invalidated.end());
+        }
+    }
+
+    std::sort(statements.begin(), statements.end());
+    statements.erase(std::unique(statements.begin(), statements.end()), statements.end());
+    Invalidate(statements, account);
+    return statements;
+}
+
+void QueryResultCache::EndWrite(std::vector<uint32> const& statements, uint64 account)
+{
+    if (statements.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(_lock);
+    for (uint32 index : statements)
+    {
+        StatementInfo& info = _statements[index];
+        if (!account || !info.PerAccount)
+        {
+            --info.PendingWrites;
+            ++info.Generation;
+            continue;
+        }
+
+        for (uint64 key : { account, UI64LIT(0) })
+        {
+            AccountWrites& writes = info.Accounts[key];
+            --writes.PendingWrites;
+            ++writes.Generation;
+        }
+    }
+}
+
+void QueryResultCache::Invalidate(std::vector<uint32> const& statements, uint64 account)
+{
+    if (statements.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(_lock);
+    for (uint32 index : statements)
+    {
+        StatementInfo& info = _statements[index];
+        if (!account || !info.PerAccount)
+        {
+            ++info.PendingWrites;
+            ++info.Generation;
+            info.Entries.clear();
+            continue;
+        }
+
+        // accounts are only forgotten together with all results and tickets that could still refer to them
+        if (info.Accounts.size() >= MaxEntriesPerStatement)
+        {
+            for (auto itr = info.Accounts.begin(); itr != info.Accounts.end();)
+                itr = itr->second.PendingWrites ? std::next(itr) : info.Accounts.erase(itr);
+
+            ++info.Generation;
+            info.Entries.clear();
+        }
+
+        // results read without an account can hold rows of any of them
+        for (uint64 key : { account, UI64LIT(0) })
+        {
+            AccountWrites& writes = info.Accounts[key];
+            ++writes.PendingWrites;
+            ++writes.Generation;
+        }
+
+        for (auto itr = info.Entries.begin(); itr != info.Entries.end();)
+        {
+            if (!itr->second.Account || itr->second.Account == account)
+                itr = info.Entries.erase(itr);
+            else
+                ++itr;
+        }
+    }
+}
+
+uint64 QueryResultCache::GetAccount(PreparedStatementBase const* stmt)
+{
+    if (stmt->statement_data.empty())
+        return 0;
+
+    PreparedStatementData const& data = stmt->statement_data[0];
+    switch (data.type)
+    {
+        case TYPE_UI32:
+            return data.data.ui32;
+        case TYPE_UI64:
+            return data.data.ui64;
+        default:
+            return 0;
+    }
+}
+
+std::vector<QueryResultCache::Stats> QueryResultCache::CollectStats()
+{
+    std::vector<Stats> stats;
+    stats.reserve(_allCachedStatements.size());
+
+    std::lock_guard<std::mutex> lock(_lock);
+    for (uint32 index : _allCachedStatements)
+    {
+        StatementInfo& info = _statements[index];
+        stats.push_back({ index, info.Hits, info.Misses, info.Entries.size() });
+        info.Hits = 0;
+        info.Misses = 0;
+    }
+
+    return stats;
+}
+
+std::vector<uint32> QueryResultCache::GetInvalidatedStatements(std::string const& sql)
+{
+    bool isWrite;
+    std::vector<std::string> tables = ParseTables(sql, isWrite);
+    if (!isWrite)
+        return { };
+
+    if (tables.empty())
+        return _allCachedStatements;
+
+    std::vector<uint32> statements;
+    for (std::string const& table : tables)
+    {
+        auto itr = _tableIds.find(table);
+        if (itr != _tableIds.end())
+            statements.insert(statements.end(), _tableReaders[itr->second].begin(), _tableReaders[itr->second].end());
+    }
+
+    std::sort(statements.begin(), statements.end());
+    statements.erase(std::unique(statements.begin(), statements.end()), statements.end());
+    return statements;
+}
+
+std::vector<std::string> QueryResultCache::ParseTables(std::string const& sql, bool& isWrite)
+{
+    // split into lowercase words (identifiers without quotes and database prefix) and single punctuation characters
+    std::vector<std::string> tokens;
+    for (std::size_t i = 0; i < sql.size();)
+    {
+        char c = sql[i];
+        if (c == '\'' || c == '"')
+        {
+            // string literals never name tables
+            std::size_t end = i + 1;
+            while (end < sql.size() && sql[end] != c)
+                end += sql[end] == '\\' ? 2 : 1;
+
+            tokens.emplace_back("'");
+            i = end + 1;
+        }
+        else if (std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '`')
+        {
+            std::string word;
+            for (; i < sql.size() && (std::isalnum(static_cast<unsigned char>(sql[i])) || sql[i] == '_' || sql[i] == '`' || sql[i] == '.'); ++i)
+            {
+                if (sql[i] == '.')
+                    word.clear();
+                else if (sql[i] != '`')
+                    word += char(std::tolower(static_cast<unsigned char>(sql[i])));
+            }
+
+            tokens.push_back(std::move(word));
+        }
+        else
+        {
+            if (!std::isspace(static_cast<unsigned char>(c)))
+                tokens.emplace_back(1, c);
+            ++i;
+        }
+    }
+
+    static std::vector<std::string> const keywords =
+    {
+        "as", "by", "cross", "for", "from", "group", "having", "ignore", "inner", "into", "join", "left", "limit", "lock", "low_priority",
+        "natural", "on", "order", "outer", "right", "select", "set", "straight_join", "table", "union", "update", "using", "values", "where"
+    };
+
+    auto isKeyword = [](std::string const& token) { return std::find(keywords.begin(), keywords.end(), token) != keywords.end(); };
+    auto isIdentifier = [&](std::string const& token) { return !token.empty() && (std::isalnum(static_cast<unsigned char>(token[0])) || token[0] == '_') && !isKeyword(token); };
+
+    std::size_t first = 0;
+    while (first < tokens.size() && tokens[first] == "(")
+        ++first;
+
+    isWrite = first >= tokens.size() || tokens[first] != "select";
+
+    std::vector<std::string> tables;
+    for (std::size_t i = 0; i < tokens.size(); ++i)
+    {
+        std::string const& token = tokens[i];
+        bool isList = token == "from" || token == "update";
+        if (!isList && token != "join" && token != "into" && token != "truncate" && token != "straight_join")
+            continue;
+
+        std::size_t j = i + 1;
+        while (j < tokens.size() && (tokens[j] == "table" || tokens[j] == "ignore" || tokens[j] == "low_priority"))
+            ++j;
+
+        while (j < tokens.size() && isIdentifier(tokens[j]))
+        {
+            tables.push_back(tokens[j++]);
+            if (!isList)
+                break;
+
+            // FROM a x, b y and UPDATE a, b name more than one table
+            if (j < tokens.size() && tokens[j] == "as")
+                ++j;
+            if (j < tokens.size() && isIdentifier(tokens[j]))
+                ++j;
+            if (j >= tokens.size() || tokens[j] != ",")
+                break;
+            ++j;
+        }
+    }
+
+    std::sort(tables.begin(), tables.end());
+    tables.erase(std::unique(tables.begin(), tables.end()), tables.end());
+    return tables;
+}
+
+std::string QueryResultCache::GetKey(PreparedStatementBase const* stmt)
+{
+    std::string key;
+    for (PreparedStatementData const& data : stmt->statement_data)
+    {
+        std::size_t size = 0;
+        switch (data.type)
+        {
+            case TYPE_BOOL:
+            case TYPE_UI8:
+            case TYPE_I8:
+                size = 1;
+                break;
+            case TYPE_UI16:
+            case TYPE_I16:
+                size = 2;
+                break;
+            case TYPE_UI32:
+            case TYPE_I32:
+            case TYPE_FLOAT:
+                size = 4;
+                break;
+            case TYPE_UI64:
+            case TYPE_I64:
+            case TYPE_DOUBLE:
+                size = 8;
+                break;
+            case TYPE_STRING:
+            case TYPE_BINARY:
+            {
+                uint32 length = uint32(data.binary.size());
+                key += char(data.type);
+                key.append(reinterpret_cast<char const*>(&length), sizeof(length));
+                key.append(reinterpret_cast<char const*>(data.binary.data()), data.binary.size());
+                continue;
+            }
+            case TYPE_NULL:
+                break;
+        }
+
+        key += char(data.type);
+        key.append(reinterpret_cast<char const*>(&data.data), size);
+    }
+
+    return key;
+}
+
+QueryResultCacheWriteTask::~QueryResultCacheWriteTask()
+{
+    delete m_operation;
+    m_cache->EndWrite(m_statements, m_account);
+}
+
+bool QueryResultCacheWriteTask::Execute()
+{
+    m_operation->SetConnection(m_conn);
+    m_operation->call();
+    return true;
+}
+
+CachedPreparedStatementTask::CachedPreparedStatementTask(PreparedStatementBase* stmt, QueryResultCache* cache, QueryResultCache::Ticket ticket)
+    : m_stmt(stmt), m_cache(cache), m_ticket(std::move(ticket))
+{
+}
+
+CachedPreparedStatementTask::~CachedPreparedStatementTask()
+{
+    delete m_stmt;
+}
+
+bool CachedPreparedStatementTask::Execute()
+{
+    PreparedQueryResult result = m_cache->Store(m_ticket, m_conn->Query(m_stmt));
+    m_result.set_value(result);
+    return result != nullptr;
+}
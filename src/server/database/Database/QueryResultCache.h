@@ -0,0 +1,166 @@
+/*
+ * This file is part of the TrinityCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _QUERYRESULTCACHE_H
+#define _QUERYRESULTCACHE_H
+
+#include "Define.h"
+#include "DatabaseEnvFwd.h"
+#include "SQLOperation.h"
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class TransactionBase;
+
+/// Results of prepared statements registered with a cache time, keyed by statement index and parameters.
+/// The tables every statement reads or writes are taken from its SQL, a write (prepared or ad-hoc) drops the cached results
+/// of all statements reading one of its tables. Results are not stored while a write to their tables is queued or running
+/// and results of queries that ran concurrently with a write are discarded, so a cached result is never older than the last write.
+/// Statements cached per account only lose the results of the account a write was made for (see DatabaseOrderScope), writes
+/// outside of any account drop all of them. Writes a session makes for another account are seen once the cache time passed.
+class TC_DATABASE_API QueryResultCache
+{
+public:
+    struct Ticket
+    {
+        uint32 Index;
+        uint64 Generation;
+        uint64 Account;
+        uint64 AccountGeneration;
+        std::string Key;
+    };
+
+    struct Stats
+    {
+        uint32 Index;
+        uint64 Hits;
+        uint64 Misses;
+        std::size_t Entries;
+    };
+
+    QueryResultCache();
+
+    /// Statements are registered once after preparing them, cacheTime in milliseconds (0 = not cached)
+    void SetStatement(uint32 index, std::string const& sql, uint32 cacheTime, bool perAccount);
+    /// Resolves which cached statements each write invalidates, call after all statements are registered
+    void Finalize();
+
+    bool IsCached(uint32 index) const { return index < _statements.size() && _statements[index].CacheTime.count() > 0; }
+
+    /// On a hit returns true and a result sharing the cached rows, on a miss fills the ticket Store needs
+    bool Get(PreparedStatementBase const* stmt, PreparedQueryResult& result, Ticket& ticket);
+    /// Takes ownership of the result of a missed query and returns it the same way the database layer would
+    PreparedQueryResult Store(Ticket const& ticket, PreparedResultSet* result);
+
+    /// Invalidates the statements the write affects until the matching EndWrite, returns them
+    /// account is the key of the DatabaseOrderScope the write was made in
+    std::vector<uint32> BeginWrite(uint32 index, uint64 account);
+    std::vector<uint32> BeginWrite(char const* sql, uint64 account);
+    std::vector<uint32> BeginWrite(TransactionBase const& transaction, uint64 account);
+    void EndWrite(std::vector<uint32> const& statements, uint64 account);
+
+    /// Returns hit and miss counts since the previous call of every cached statement
+    std::vector<Stats> CollectStats();
+
+    /// Identifies the parameters a statement is executed with
+    static std::string GetKey(PreparedStatementBase const* stmt);
+
+private:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    struct CacheEntry
+    {
+        std::shared_ptr<PreparedResultSet const> Result;    // null for queries without rows
+        TimePoint Expires;
+        uint64 Account;
+    };
+
+    struct AccountWrites
+    {
+        uint32 PendingWrites = 0;
+        uint64 Generation = 0;
+    };
+
+    struct StatementInfo
+    {
+        std::chrono::milliseconds CacheTime = std::chrono::milliseconds::zero();
+        bool IsWrite = false;
+        bool PerAccount = false;
+        std::vector<uint32> Tables;
+        std::vector<uint32> Invalidates;                    // cached statements reading a table this one writes
+
+        uint64 Generation = 0;
+        uint32 PendingWrites = 0;
+        uint64 Hits = 0;
+        uint64 Misses = 0;
+        std::unordered_map<std::string, CacheEntry> Entries;
+        std::unordered_map<uint64, AccountWrites> Accounts; // writes made for single accounts, 0 counts the writes of all of them
+    };
+
+    static std::vector<std::string> ParseTables(std::string const& sql, bool& isWrite);
+    std::vector<uint32> GetInvalidatedStatements(std::string const& sql);
+    void Invalidate(std::vector<uint32> const& statements, uint64 account);
+    static uint64 GetAccount(PreparedStatementBase const* stmt);
+
+    std::mutex _lock;
+    std::vector<StatementInfo> _statements;
+    std::unordered_map<std::string, uint32> _tableIds;
+    std::vector<std::vector<uint32>> _tableReaders;         // cached statements by table id
+    std::vector<uint32> _allCachedStatements;
+
+    QueryResultCache(QueryResultCache const& right) = delete;
+    QueryResultCache& operator=(QueryResultCache const& right) = delete;
+};
+
+/// Keeps the cached results a queued write affects invalid until the write was executed (or dropped)
+class TC_DATABASE_API QueryResultCacheWriteTask : public SQLOperation
+{
+public:
+    QueryResultCacheWriteTask(SQLOperation* operation, QueryResultCache* cache, std::vector<uint32> statements, uint64 account)
+        : m_operation(operation), m_cache(cache), m_statements(std::move(statements)), m_account(account) { }
+    ~QueryResultCacheWriteTask();
+
+    bool Execute() override;
+
+private:
+    SQLOperation* m_operation;
+    QueryResultCache* m_cache;
+    std::vector<uint32> m_statements;
+    uint64 m_account;
+};
+
+/// Executes a cached statement for a query that missed the cache and stores its result
+class TC_DATABASE_API CachedPreparedStatementTask : public SQLOperation
+{
+public:
+    CachedPreparedStatementTask(PreparedStatementBase* stmt, QueryResultCache* cache, QueryResultCache::Ticket ticket);
+    ~CachedPreparedStatementTask();
+
+    bool Execute() override;
+    PreparedQueryResultFuture GetFuture() { return m_result.get_future(); }
+
+private:
+    PreparedStatementBase* m_stmt;
+    QueryResultCache* m_cache;
+    QueryResultCache::Ticket m_ticket;
+    PreparedQueryResultPromise m_result;
+};
+
+#endif
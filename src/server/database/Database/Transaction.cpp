@@ -40,6 +40,25 @@ void TransactionBase::AppendPreparedStatement(PreparedStatementBase* stmt)
     m_queries.push_back(data);
 }
 
+std::size_t TransactionBase::GetPayloadSize() const
+{
+    std::size_t size = 0;
+    for (SQLElementData const& data : m_queries)
+    {
+        switch (data.type)
+        {
+            case SQL_ELEMENT_PREPARED:
+                size += data.element.stmt->GetPayloadSize();
+                break;
+            case SQL_ELEMENT_RAW:
+                size += strlen(data.element.query);
+                break;
+        }
+    }
+
+    return size;
+}
+
 void TransactionBase::Cleanup()
 {
     // This might be called by explicit calls to Cleanup or by the auto-destructor
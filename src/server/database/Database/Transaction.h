@@ -31,12 +31,14 @@ class TC_DATABASE_API TransactionBase
 {
     friend class TransactionTask;
     friend class MySQLConnection;
+    friend class DatabaseJournal;
+    friend class QueryResultCache;
 
     template <typename T>
     friend class DatabaseWorkerPool;
 
     public:
-        TransactionBase() : _cleanedUp(false) { }
+        TransactionBase() : _journalKey(0), _cleanedUp(false) { }
         virtual ~TransactionBase() { Cleanup(); }
 
         void Append(const char* sql);
@@ -47,6 +49,12 @@ class TC_DATABASE_API TransactionBase
         }
 
         std::size_t GetSize() const { return m_queries.size(); }
+        //- Bytes of query text and bound parameters, for statistics
+        std::size_t GetPayloadSize() const;
+
+        //- Non zero keys make the transaction go through the journal of its pool until it was committed
+        void SetJournalKey(uint64 key) { _journalKey = key; }
+        uint64 GetJournalKey() const { return _journalKey; }
 
     protected:
         void AppendPreparedStatement(PreparedStatementBase* statement);
@@ -54,6 +62,7 @@ class TC_DATABASE_API TransactionBase
         std::vector<SQLElementData> m_queries;
 
     private:
+        uint64 _journalKey;
         bool _cleanedUp;
 };
 
@@ -132,20 +132,11 @@ void SmartAIMgr::LoadSmartAIFromDB()
         mEventMap[i].clear();  //Drop Existing SmartAI List
 
     WorldDatabasePreparedStatement* stmt = WorldDatabase.GetPreparedStatement(WORLD_SEL_SMART_SCRIPTS);
-    PreparedQueryResult result = WorldDatabase.Query(stmt);
-
-    if (!result)
-    {
-        TC_LOG_INFO("server.loading", ">> Loaded 0 SmartAI scripts. DB table `smartai_scripts` is empty.");
-        return;
-    }
 
     uint32 count = 0;
 
-    do
+    uint64 rowCount = WorldDatabase.StreamQuery(stmt, [&](Field* fields)
     {
-        Field* fields = result->Fetch();
-
         SmartScriptHolder temp;
 
         temp.entryOrGuid = fields[0].GetInt64();
@@ -153,7 +144,7 @@ void SmartAIMgr::LoadSmartAIFromDB()
         if (source_type >= SMART_SCRIPT_TYPE_MAX)
         {
             TC_LOG_ERROR("sql.sql", "SmartAIMgr::LoadSmartAIFromDB: invalid source_type (%u), skipped loading.", uint32(source_type));
-            continue;
+            return;
         }
         if (temp.entryOrGuid >= 0)
         {
@@ -165,13 +156,13 @@ void SmartAIMgr::LoadSmartAIFromDB()
                     if (!creatureInfo)
                     {
                         TC_LOG_ERROR("sql.sql", "SmartAIMgr::LoadSmartAIFromDB: Creature entry (%u) does not exist, skipped loading.", uint32(temp.entryOrGuid));
-                        continue;
+                        return;
                     }
 
                     if (creatureInfo->AIName != "SmartAI")
                     {
                         TC_LOG_ERROR("sql.sql", "SmartAIMgr::LoadSmartAIFromDB: Creature entry (%u) is not using SmartAI, skipped loading.", uint32(temp.entryOrGuid));
-                        continue;
+                        return;
                     }
                     break;
                 }
@@ -181,13 +172,13 @@ void SmartAIMgr::LoadSmartAIFromDB()
                     if (!gameObjectInfo)
                     {
                         TC_LOG_ERROR("sql.sql", "SmartAIMgr::LoadSmartAIFromDB: GameObject entry (%u) does not exist, skipped loading.", uint32(temp.entryOrGuid));
-                        continue;
+                        return;
                     }
 
                     if (gameObjectInfo->AIName != "SmartGameObjectAI")
                     {
                         TC_LOG_ERROR("sql.sql", "SmartAIMgr::LoadSmartAIFromDB: GameObject entry (%u) is not using SmartGameObjectAI, skipped loading.", uint32(temp.entryOrGuid));
-                        continue;
+                        return;
                     }
                     break;
                 }
@@ -196,7 +187,7 @@ void SmartAIMgr::LoadSmartAIFromDB()
                     if (!sAreaTriggerStore.LookupEntry((uint32)temp.entryOrGuid))
                     {
                         TC_LOG_ERROR("sql.sql", "SmartAIMgr::LoadSmartAIFromDB: AreaTrigger entry (%u) does not exist, skipped loading.", uint32(temp.entryOrGuid));
-                        continue;
+                        return;
                     }
                     break;
                 }
@@ -205,7 +196,7 @@ void SmartAIMgr::LoadSmartAIFromDB()
                     if (!sObjectMgr->GetSceneTemplate((uint32)temp.entryOrGuid))
                     {
                         TC_LOG_ERROR("sql.sql", "SmartAIMgr::LoadSmartAIFromDB: Scene id (%u) does not exist, skipped loading.", uint32(temp.entryOrGuid));
-                        continue;
+                        return;
                     }
                     break;
                 }
@@ -213,7 +204,7 @@ void SmartAIMgr::LoadSmartAIFromDB()
                     break;//nothing to check, really
                 default:
                     TC_LOG_ERROR("sql.sql", "SmartAIMgr::LoadSmartAIFromDB: not yet implemented source_type %u", (uint32)source_type);
-                    continue;
+                    return;
             }
         }
         else
@@ -226,20 +217,20 @@ void SmartAIMgr::LoadSmartAIFromDB()
                     if (!creature)
                     {
                         TC_LOG_ERROR("sql.sql", "SmartAIMgr::LoadSmartAIFromDB: Creature guid (" SI64FMTD ") does not exist, skipped loading.", -temp.entryOrGuid);
-                        continue;
+                        return;
                     }
 
                     CreatureTemplate const* creatureInfo = sObjectMgr->GetCreatureTemplate(creature->id);
                     if (!creatureInfo)
                     {
                         TC_LOG_ERROR("sql.sql", "SmartAIMgr::LoadSmartAIFromDB: Creature entry (%u) guid (" SI64FMTD ") does not exist, skipped loading.", creature->id, -temp.entryOrGuid);
-                        continue;
+                        return;
                     }
 
                     if (creatureInfo->AIName != "SmartAI")
                     {
                         TC_LOG_ERROR("sql.sql", "SmartAIMgr::LoadSmartAIFromDB: Creature entry (%u) guid (" SI64FMTD ") is not using SmartAI, skipped loading.", creature->id, -temp.entryOrGuid);
-                        continue;
+                        return;
                     }
                     break;
                 }
@@ -249,26 +240,26 @@ void SmartAIMgr::LoadSmartAIFromDB()
                     if (!gameObject)
                     {
                         TC_LOG_ERROR("sql.sql", "SmartAIMgr::LoadSmartAIFromDB: GameObject guid (" SI64FMTD ") does not exist, skipped loading.", -temp.entryOrGuid);
-                        continue;
+                        return;
                     }
 
                     GameObjectTemplate const* gameObjectInfo = sObjectMgr->GetGameObjectTemplate(gameObject->id);
                     if (!gameObjectInfo)
                     {
                         TC_LOG_ERROR("sql.sql", "SmartAIMgr::LoadSmartAIFromDB: GameObject entry (%u) guid (" SI64FMTD ") does not exist, skipped loading.", gameObject->id, -temp.entryOrGuid);
-                        continue;
+                        return;
                     }
 
                     if (gameObjectInfo->AIName != "SmartGameObjectAI")
                     {
                         TC_LOG_ERROR("sql.sql", "SmartAIMgr::LoadSmartAIFromDB: GameObject entry (%u) guid (" SI64FMTD ") is not using SmartGameObjectAI, skipped loading.", gameObject->id, -temp.entryOrGuid);
-                        continue;
+                        return;
                     }
                     break;
                 }
                 default:
                     TC_LOG_ERROR("sql.sql", "SmartAIMgr::LoadSmartAIFromDB: GUID-specific scripting not yet implemented for source_type %u", (uint32)source_type);
-                    continue;
+                    return;
             }
         }
 
@@ -307,11 +298,11 @@ void SmartAIMgr::LoadSmartAIFromDB()
 
         //check target
         if (!IsTargetValid(temp))
-            continue;
+            return;
 
         // check all event and action params
         if (!IsEventValid(temp))
-            continue;
+            return;
 
         // specific check for timed events
         switch (temp.event.type)
@@ -366,8 +357,13 @@ void SmartAIMgr::LoadSmartAIFromDB()
         }
         // store the new event
         mEventMap[source_type][temp.entryOrGuid].push_back(temp);
+    });
+
+    if (!rowCount)
+    {
+        TC_LOG_INFO("server.loading", ">> Loaded 0 SmartAI scripts. DB table `smartai_scripts` is empty.");
+        return;
     }
-    while (result->NextRow());
 
     // Post Loading Validation
     for (uint8 i = 0; i < SMART_SCRIPT_TYPE_MAX; ++i)
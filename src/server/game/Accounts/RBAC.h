@@ -793,6 +793,8 @@ enum RBACPermissions
     RBAC_PERM_COMMAND_LFG_DEBUG = 2007,
     RBAC_PERM_COMMAND_TICKET_ADDON = 2008,
     RBAC_PERM_COMMAND_RELOAD_SPELL_SCRIPT_NAMES = 2009,
+    RBAC_PERM_COMMAND_SERVER_OPCODESTATS = 2010,
+    RBAC_PERM_COMMAND_SERVER_TICKPROFILE = 2011,
     RBAC_PERM_MAX
 };
 
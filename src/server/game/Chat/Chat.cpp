@@ -464,6 +464,8 @@ bool ChatHandler::ParseCommands(char const* text)
     if (text[0] == '!' || text[0] == '.')
         ++text;
 
+    // commands change characters of other accounts, their writes must not be attributed to the account of the caller
+    DatabaseOrderScope orderScope(0);
     if (!ExecuteCommandInTable(getCommandTable(), text, fullcmd))
     {
         if (m_session && !m_session->HasPermission(rbac::RBAC_PERM_COMMANDS_NOTIFY_COMMAND_NOT_FOUND_ERROR))
@@ -348,6 +348,7 @@ void Creature::AddToWorld()
         GetMap()->GetObjectsStore().Insert<Creature>(GetGUID(), this);
         if (m_spawnId)
             GetMap()->GetCreatureBySpawnIdStore().insert(std::make_pair(m_spawnId, this));
+        GetMap()->AddToEntryStore(this);
 
         Unit::AddToWorld();
         SearchFormation();
@@ -371,10 +372,23 @@ void Creature::RemoveFromWorld()
 
         if (m_spawnId)
             Trinity::Containers::MultimapErasePair(GetMap()->GetCreatureBySpawnIdStore(), m_spawnId, this);
+        GetMap()->RemoveFromEntryStore(this);
         GetMap()->GetObjectsStore().Remove<Creature>(GetGUID());
     }
 }
 
+void Creature::SetEntry(uint32 entry)
+{
+    // the map groups creatures in world by entry
+    if (IsInWorld())
+        GetMap()->RemoveFromEntryStore(this);
+
+    Unit::SetEntry(entry);
+
+    if (IsInWorld())
+        GetMap()->AddToEntryStore(this);
+}
+
 void Creature::DisappearAndDie()
 {
     ForcedDespawn(0);
@@ -455,7 +455,7 @@ void PlayerMenu::SendQuestGiverQuestDetails(Quest const* quest, ObjectGuid npcGU
         SpellInfo const* spellInfo = sSpellMgr->GetSpellInfo(quest->GetRewSpell());
         if (spellInfo->HasEffect(SPELL_EFFECT_LEARN_SPELL))
         {
-            SpellEffectInfoVector effects = spellInfo->GetEffectsForDifficulty(DIFFICULTY_NONE);
+            SpellEffectInfoVector const& effects = spellInfo->GetEffectsForDifficulty(DIFFICULTY_NONE);
             for (SpellEffectInfoVector::const_iterator itr = effects.begin(); itr != effects.end(); ++itr)
             {
                 if ((*itr)->IsEffect(SPELL_EFFECT_LEARN_SPELL))
@@ -213,6 +213,7 @@ void GameObject::AddToWorld()
         GetMap()->GetObjectsStore().Insert<GameObject>(GetGUID(), this);
         if (m_spawnId)
             GetMap()->GetGameObjectBySpawnIdStore().insert(std::make_pair(m_spawnId, this));
+        GetMap()->AddToEntryStore(this);
 
         // The state can be changed after GameObject::Create but before GameObject::AddToWorld
         bool toggledState = GetGoType() == GAMEOBJECT_TYPE_CHEST ? getLootState() == GO_READY : (GetGoState() == GO_STATE_READY || IsTransport());
@@ -246,10 +247,23 @@ void GameObject::RemoveFromWorld()
 
         if (m_spawnId)
             Trinity::Containers::MultimapErasePair(GetMap()->GetGameObjectBySpawnIdStore(), m_spawnId, this);
+        GetMap()->RemoveFromEntryStore(this);
         GetMap()->GetObjectsStore().Remove<GameObject>(GetGUID());
     }
 }
 
+void GameObject::SetEntry(uint32 entry)
+{
+    // the map groups gameobjects in world by entry
+    if (IsInWorld())
+        GetMap()->RemoveFromEntryStore(this);
+
+    WorldObject::SetEntry(entry);
+
+    if (IsInWorld())
+        GetMap()->AddToEntryStore(this);
+}
+
 bool GameObject::Create(uint32 entry, Map* map, Position const& pos, QuaternionData const& rotation, uint32 animProgress, GOState goState, uint32 artKit)
 {
     ASSERT(map);
@@ -2626,6 +2640,17 @@ void GameObject::BuildValuesUpdate(ByteBuffer* data, Player const* target) const
     data->put<uint32>(sizePos, data->wpos() - sizePos - 4);
 }
 
+bool GameObject::HasViewerDependentChanges() const
+{
+    if (Object::HasViewerDependentChanges())
+        return true;
+
+    UF::GameObjectData const& gameObjectData = *m_gameObjectData;
+    return gameObjectData.IsChanged(&UF::GameObjectData::Flags)
+        || gameObjectData.IsChanged(&UF::GameObjectData::Level)
+        || gameObjectData.IsChanged(&UF::GameObjectData::State);
+}
+
 void GameObject::BuildValuesUpdateForPlayerWithMask(UpdateData* data, UF::ObjectData::Mask const& requestedObjectMask,
     UF::GameObjectData::Mask const& requestedGameObjectMask, Player const* target) const
 {
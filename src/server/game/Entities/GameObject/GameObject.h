@@ -88,6 +88,7 @@ class TC_GAME_API GameObject : public WorldObject, public GridObject<GameObject>
     protected:
         void BuildValuesCreate(ByteBuffer* data, Player const* target) const override;
         void BuildValuesUpdate(ByteBuffer* data, Player const* target) const override;
+        bool HasViewerDependentChanges() const override;
         void ClearUpdateMask(bool remove) override;
 
     public:
@@ -96,6 +97,8 @@ class TC_GAME_API GameObject : public WorldObject, public GridObject<GameObject>
 
         void AddToWorld() override;
         void RemoveFromWorld() override;
+
+        void SetEntry(uint32 entry) override;
         void CleanupsBeforeDelete(bool finalCleanup = true) override;
 
     private:
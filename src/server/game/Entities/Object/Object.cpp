@@ -798,7 +798,13 @@ void Object::ClearUpdateMask(bool remove)
     }
 }
 
-void Object::BuildFieldsUpdate(Player* player, UpdateDataMapType& data_map) const
+bool Object::HasViewerDependentChanges() const
+{
+    return m_objectData->IsChanged(&UF::ObjectData::EntryID)
+        || m_objectData->IsChanged(&UF::ObjectData::DynamicFlags);
+}
+
+void Object::BuildFieldsUpdate(Player* player, UpdateDataMapType& data_map, ValuesUpdateBlockCache* sharedBlocks /*= nullptr*/) const
 {
     UpdateDataMapType::iterator iter = data_map.find(player);
 
@@ -809,7 +815,27 @@ void Object::BuildFieldsUpdate(Player* player, UpdateDataMapType& data_map) cons
         iter = p.first;
     }
 
-    BuildValuesUpdateBlockForPlayer(&iter->second, iter->first);
+    // the self view carries private fields (active player data), everything else only depends on the update field flags
+    // unless a viewer dependent field changed - serialize those blocks once and splice them into every receiver with the same flags
+    if (!sharedBlocks || player == this || HasViewerDependentChanges())
+    {
+        BuildValuesUpdateBlockForPlayer(&iter->second, iter->first);
+        return;
+    }
+
+    UF::UpdateFieldFlag flags = GetUpdateFieldFlagsFor(player);
+    auto block = std::find_if(sharedBlocks->begin(), sharedBlocks->end(), [flags](ValuesUpdateBlockCache::value_type const& cached)
+    {
+        return cached.first == flags;
+    });
+
+    if (block == sharedBlocks->end())
+    {
+        block = sharedBlocks->emplace(sharedBlocks->end(), flags, PrepareValuesUpdateBuffer());
+        BuildValuesUpdate(&block->second, player);
+    }
+
+    iter->second.AddUpdateBlock(block->second);
 }
 
 void MovementInfo::OutDebug()
@@ -2051,6 +2077,15 @@ Creature* WorldObject::FindNearestCreature(uint32 entry, float range, bool alive
 {
     Creature* creature = nullptr;
     Trinity::NearestCreatureEntryWithLiveStateInObjectRangeCheck checker(*this, entry, alive, range);
+    if (std::vector<Creature*> const* candidates = GetMap()->GetCreatureEntryScanCandidates(entry, GetPositionX(), GetPositionY(), range))
+    {
+        for (Creature* candidate : *candidates)
+            if (candidate->IsInGrid() && candidate->IsInPhase(this) && checker(candidate))
+                creature = candidate;
+
+        return creature;
+    }
+
     Trinity::CreatureLastSearcher<Trinity::NearestCreatureEntryWithLiveStateInObjectRangeCheck> searcher(this, creature, checker);
     Cell::VisitAllObjects(this, searcher, range);
     return creature;
@@ -2074,6 +2109,16 @@ GameObject* WorldObject::FindNearestGameObject(uint32 entry, float range) const
 {
     GameObject* go = nullptr;
     Trinity::NearestGameObjectEntryInObjectRangeCheck checker(*this, entry, range);
+    if (std::vector<GameObject*> const* candidates = GetMap()->GetGameObjectEntryScanCandidates(entry, GetPositionX(), GetPositionY(), range))
+    {
+        // world objects are stored in the world container which is not visited here
+        for (GameObject* candidate : *candidates)
+            if (candidate->IsInGrid() && !candidate->IsWorldObject() && candidate->IsInPhase(this) && checker(candidate))
+                go = candidate;
+
+        return go;
+    }
+
     Trinity::GameObjectLastSearcher<Trinity::NearestGameObjectEntryInObjectRangeCheck> searcher(this, go, checker);
     Cell::VisitGridObjects(this, searcher, range);
     return go;
@@ -2262,6 +2307,16 @@ template <typename Container>
 void WorldObject::GetGameObjectListWithEntryInGrid(Container& gameObjectContainer, uint32 entry, float maxSearchRange /*= 250.0f*/) const
 {
     Trinity::AllGameObjectsWithEntryInRange check(this, entry, maxSearchRange);
+    if (std::vector<GameObject*> const* candidates = GetMap()->GetGameObjectEntryScanCandidates(entry, GetPositionX(), GetPositionY(), maxSearchRange))
+    {
+        // world objects are stored in the world container which is not visited here
+        for (GameObject* candidate : *candidates)
+            if (candidate->IsInGrid() && !candidate->IsWorldObject() && candidate->IsInPhase(this) && check(candidate))
+                gameObjectContainer.push_back(candidate);
+
+        return;
+    }
+
     Trinity::GameObjectListSearcher<Trinity::AllGameObjectsWithEntryInRange> searcher(this, gameObjectContainer, check);
     Cell::VisitGridObjects(this, searcher, maxSearchRange);
 }
@@ -2270,6 +2325,16 @@ template <typename Container>
 void WorldObject::GetCreatureListWithEntryInGrid(Container& creatureContainer, uint32 entry, float maxSearchRange /*= 250.0f*/) const
 {
     Trinity::AllCreaturesOfEntryInRange check(this, entry, maxSearchRange);
+    if (std::vector<Creature*> const* candidates = GetMap()->GetCreatureEntryScanCandidates(entry, GetPositionX(), GetPositionY(), maxSearchRange))
+    {
+        // world objects are stored in the world container which is not visited here
+        for (Creature* candidate : *candidates)
+            if (candidate->IsInGrid() && !candidate->IsWorldObject() && candidate->IsInPhase(this) && check(candidate))
+                creatureContainer.push_back(candidate);
+
+        return;
+    }
+
     Trinity::CreatureListSearcher<Trinity::AllCreaturesOfEntryInRange> searcher(this, creatureContainer, check);
     Cell::VisitGridObjects(this, searcher, maxSearchRange);
 }
@@ -2598,6 +2663,7 @@ struct WorldObjectChangeAccumulator
     UpdateDataMapType& i_updateDatas;
     WorldObject& i_object;
     GuidSet plr_list;
+    ValuesUpdateBlockCache i_sharedBlocks;
     WorldObjectChangeAccumulator(WorldObject &obj, UpdateDataMapType &d) : i_updateDatas(d), i_object(obj) { }
     void Visit(PlayerMapType &m)
     {
@@ -2655,7 +2721,7 @@ struct WorldObjectChangeAccumulator
         // Only send update once to a player
         if (plr_list.find(player->GetGUID()) == plr_list.end() && player->HaveAtClient(&i_object))
         {
-            i_object.BuildFieldsUpdate(player, i_updateDatas);
+            i_object.BuildFieldsUpdate(player, i_updateDatas, &i_sharedBlocks);
             plr_list.insert(player->GetGUID());
         }
     }
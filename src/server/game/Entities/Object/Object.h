@@ -59,6 +59,8 @@ class ZoneScript;
 struct QuaternionData;
 
 typedef std::unordered_map<Player*, UpdateData> UpdateDataMapType;
+// values update blocks of one object serialized during a single BuildUpdate call, keyed by the update field flags they were built with
+typedef std::vector<std::pair<UF::UpdateFieldFlag, ByteBuffer>> ValuesUpdateBlockCache;
 
 struct CreateObjectBits
 {
@@ -139,7 +141,7 @@ class TC_GAME_API Object
 
         ObjectGuid const& GetGUID() const { return m_guid; }
         uint32 GetEntry() const { return m_objectData->EntryID; }
-        void SetEntry(uint32 entry) { SetUpdateFieldValue(m_values.ModifyValue(&Object::m_objectData).ModifyValue(&UF::ObjectData::EntryID), entry); }
+        virtual void SetEntry(uint32 entry) { SetUpdateFieldValue(m_values.ModifyValue(&Object::m_objectData).ModifyValue(&UF::ObjectData::EntryID), entry); }
 
         float GetObjectScale() const { return m_objectData->Scale; }
         virtual void SetObjectScale(float scale) { SetUpdateFieldValue(m_values.ModifyValue(&Object::m_objectData).ModifyValue(&UF::ObjectData::Scale), scale); }
@@ -171,7 +173,7 @@ class TC_GAME_API Object
         virtual bool hasQuest(uint32 /* quest_id */) const { return false; }
         virtual bool hasInvolvedQuest(uint32 /* quest_id */) const { return false; }
         virtual void BuildUpdate(UpdateDataMapType&) { }
-        void BuildFieldsUpdate(Player*, UpdateDataMapType &) const;
+        void BuildFieldsUpdate(Player*, UpdateDataMapType &, ValuesUpdateBlockCache* sharedBlocks = nullptr) const;
 
         inline bool IsPlayer() const { return GetTypeId() == TYPEID_PLAYER; }
         Player* ToPlayer() { if (IsPlayer()) return reinterpret_cast<Player*>(this); else return nullptr; }
@@ -329,6 +331,8 @@ class TC_GAME_API Object
         virtual UF::UpdateFieldFlag GetUpdateFieldFlagsFor(Player const* target) const;
         virtual void BuildValuesCreate(ByteBuffer* data, Player const* target) const = 0;
         virtual void BuildValuesUpdate(ByteBuffer* data, Player const* target) const = 0;
+        // true if any pending change is written through a ViewerDependentValue, making the values update block unique per receiver
+        virtual bool HasViewerDependentChanges() const;
 
     public:
         virtual void BuildValuesUpdateWithFlag(ByteBuffer* data, UF::UpdateFieldFlag flags, Player const* target) const;
@@ -462,6 +462,22 @@ namespace UF
             _changesMask.Reset(Bit);
         }
 
+        template<typename Derived, typename T, uint32 BlockBit, uint32 Bit>
+        bool IsChanged(UpdateField<T, BlockBit, Bit>(Derived::*)) const
+        {
+            static_assert(std::is_base_of<Base, Derived>::value, "Given field argument must belong to the same structure as this HasChangesMask");
+
+            return _changesMask[Bit];
+        }
+
+        template<typename Derived, typename T, std::size_t Size, uint32 Bit, uint32 FirstElementBit>
+        bool IsChanged(UpdateFieldArray<T, Size, Bit, FirstElementBit>(Derived::*)) const
+        {
+            static_assert(std::is_base_of<Base, Derived>::value, "Given field argument must belong to the same structure as this HasChangesMask");
+
+            return _changesMask[Bit];
+        }
+
         Mask const& GetChangesMask() const { return _changesMask; }
 
     protected:
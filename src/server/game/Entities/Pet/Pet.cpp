@@ -359,6 +359,9 @@ void Pet::SavePetToDB(PetSaveMode mode)
     uint32 curhealth = GetHealth();
     uint32 curmana = GetPower(POWER_MANA);
 
+    // unsummoning saves on map threads, outside of the session update
+    DatabaseOrderScope orderScope(GetOwner()->GetSession()->GetAccountId());
+
     CharacterDatabaseTransaction trans = CharacterDatabase.BeginTransaction();
     // save auras before possibly removing them
     _SaveAuras(trans);
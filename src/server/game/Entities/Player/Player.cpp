@@ -83,6 +83,7 @@
 #include "Mail.h"
 #include "MailPackets.h"
 #include "MapManager.h"
+#include "Metric.h"
 #include "MiscPackets.h"
 #include "MotionMaster.h"
 #include "MovementPackets.h"
@@ -250,6 +251,8 @@ Player::Player(WorldSession* session) : Unit(true), m_sceneMgr(this), m_archaeol
     m_mailsLoaded = false;
     m_mailsUpdated = false;
     unReadMails = 0;
+
+    m_changedSaveData = PLAYER_SAVE_DATA_ALL;
     m_nextMailDelivereTime = 0;
 
     m_itemUpdateQueueBlocked = false;
@@ -2977,7 +2980,11 @@ bool Player::AddTalent(TalentEntry const* talent, uint8 spec, bool learning)
 
     PlayerTalentMap::iterator itr = GetTalentMap(spec)->find(talent->ID);
     if (itr != GetTalentMap(spec)->end())
-        itr->second = PLAYERSPELL_UNCHANGED;
+    {
+        // removed talents always have a row, new ones are erased on removal
+        if (itr->second == PLAYERSPELL_REMOVED)
+            itr->second = PLAYERSPELL_UNCHANGED;
+    }
     else
         (*GetTalentMap(spec))[talent->ID] = learning ? PLAYERSPELL_NEW : PLAYERSPELL_UNCHANGED;
 
@@ -3003,7 +3010,12 @@ void Player::RemoveTalent(TalentEntry const* talent)
     // if this talent rank can be found in the PlayerTalentMap, mark the talent as removed so it gets deleted
     PlayerTalentMap::iterator plrTalent = GetTalentMap(GetActiveTalentGroup())->find(talent->ID);
     if (plrTalent != GetTalentMap(GetActiveTalentGroup())->end())
-        plrTalent->second = PLAYERSPELL_REMOVED;
+    {
+        if (plrTalent->second == PLAYERSPELL_NEW)
+            GetTalentMap(GetActiveTalentGroup())->erase(plrTalent);
+        else
+            plrTalent->second = PLAYERSPELL_REMOVED;
+    }
 }
 
 bool Player::AddSpell(uint32 spellId, bool active, bool learning, bool dependent, bool disabled, bool loading /*= false*/, int32 fromSkill /*= 0*/)
@@ -19170,6 +19182,9 @@ bool Player::LoadFromDB(ObjectGuid guid, CharacterDatabaseQueryHolder* holder)
     UpdateAverageItemLevel();
 
     m_questObjectiveCriteriaMgr->CheckAllQuestObjectiveCriteria(this);
+
+    // everything loaded above matches the database
+    m_changedSaveData = PLAYER_SAVE_DATA_AURAS;
     return true;
 }
 
@@ -20907,9 +20922,14 @@ bool Player::_LoadHomeBind(PreparedQueryResult result)
 
 void Player::SaveToDB(bool create /*=false*/)
 {
+    // periodic saves run on map threads, outside of the session update
+    DatabaseOrderScope orderScope(GetSession()->GetAccountId());
+
     CharacterDatabaseTransaction trans = CharacterDatabase.BeginTransaction();
     LoginDatabaseTransaction loginTransaction = LoginDatabase.BeginTransaction();
 
+    // journaled until committed, a crash replays it on the next start
+    trans->SetJournalKey(GetGUID().GetCounter());
     SaveToDB(loginTransaction, trans, create);
 
     CharacterDatabase.CommitTransaction(trans);
@@ -20937,6 +20957,10 @@ void Player::SaveToDB(LoginDatabaseTransaction loginTransaction, CharacterDataba
     if (!create)
         sScriptMgr->OnPlayerSave(this);
 
+    // the transaction can already hold statements of the caller
+    std::size_t savedStatements = trans->GetSize();
+    std::size_t savedBytes = sMetric->IsEnabled() ? trans->GetPayloadSize() : 0;
+
     CharacterDatabasePreparedStatement* stmt = nullptr;
     uint8 index = 0;
 
@@ -21318,6 +21342,12 @@ void Player::SaveToDB(LoginDatabaseTransaction loginTransaction, CharacterDataba
     loginStmt->setUInt32(6, time(nullptr));
     loginTransaction->Append(loginStmt);
 
+    if (sMetric->IsEnabled())
+    {
+        sMetric->LogValue("player_save_statements", uint64(trans->GetSize() - savedStatements));
+        sMetric->LogValue("player_save_bytes", uint64(trans->GetPayloadSize() - savedBytes));
+    }
+
     // save pet (hunter pet level and experience and all type pets health/mana).
     if (Pet* pet = GetPet())
         pet->SavePetToDB(PET_SAVE_CURRENT_STATE);
@@ -21389,6 +21419,17 @@ void Player::_SaveActions(CharacterDatabaseTransaction& trans)
 
 void Player::_SaveAuras(CharacterDatabaseTransaction& trans)
 {
+    bool hasSavedAuras = std::any_of(m_ownedAuras.begin(), m_ownedAuras.end(), [](AuraMap::value_type const& pair) { return pair.second->CanBeSaved(); });
+
+    // nothing was written by the previous save and nothing is to be written now
+    if (!hasSavedAuras && !(m_changedSaveData & PLAYER_SAVE_DATA_AURAS))
+        return;
+
+    if (hasSavedAuras)
+        m_changedSaveData |= PLAYER_SAVE_DATA_AURAS;
+    else
+        m_changedSaveData &= ~PLAYER_SAVE_DATA_AURAS;
+
     CharacterDatabasePreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_CHAR_AURA_EFFECT);
     stmt->setUInt64(0, GetGUID().GetCounter());
     trans->Append(stmt);
@@ -21397,6 +21438,9 @@ void Player::_SaveAuras(CharacterDatabaseTransaction& trans)
     stmt->setUInt64(0, GetGUID().GetCounter());
     trans->Append(stmt);
 
+    // effects follow all auras so each kind of statement can be batched
+    std::vector<CharacterDatabasePreparedStatement*> effectInserts;
+
     uint8 index;
     for (AuraMap::const_iterator itr = m_ownedAuras.begin(); itr != m_ownedAuras.end(); ++itr)
     {
@@ -21437,10 +21481,13 @@ void Player::_SaveAuras(CharacterDatabaseTransaction& trans)
                 stmt->setUInt8(index++, effect->GetEffIndex());
                 stmt->setInt32(index++, effect->GetAmount());
                 stmt->setInt32(index++, effect->GetBaseAmount());
-                trans->Append(stmt);
+                effectInserts.push_back(stmt);
             }
         }
     }
+
+    for (CharacterDatabasePreparedStatement* effectInsert : effectInserts)
+        trans->Append(effectInsert);
 }
 
 void Player::_SaveInventory(CharacterDatabaseTransaction& trans)
@@ -21492,6 +21539,9 @@ void Player::_SaveInventory(CharacterDatabaseTransaction& trans)
     if (m_itemUpdateQueue.empty())
         return;
 
+    // character_inventory rows are written after the items, in their original order, so each kind of statement can be batched
+    std::vector<CharacterDatabasePreparedStatement*> inventoryStmts;
+
     for (size_t i = 0; i < m_itemUpdateQueue.size(); ++i)
     {
         Item* item = m_itemUpdateQueue[i];
@@ -21515,7 +21565,7 @@ void Player::_SaveInventory(CharacterDatabaseTransaction& trans)
                 stmt->setUInt64(0, bagTestGUID);
                 stmt->setUInt8(1, item->GetSlot());
                 stmt->setUInt64(2, GetGUID().GetCounter());
-                trans->Append(stmt);
+                inventoryStmts.push_back(stmt);
 
                 RemoveTradeableItem(item);
                 RemoveEnchantmentDurationsReferences(item);
@@ -21548,12 +21598,12 @@ void Player::_SaveInventory(CharacterDatabaseTransaction& trans)
                 stmt->setUInt64(1, container ? container->GetGUID().GetCounter() : UI64LIT(0));
                 stmt->setUInt8 (2, item->GetSlot());
                 stmt->setUInt64(3, item->GetGUID().GetCounter());
-                trans->Append(stmt);
+                inventoryStmts.push_back(stmt);
                 break;
             case ITEM_REMOVED:
                 stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_CHAR_INVENTORY_BY_ITEM);
                 stmt->setUInt64(0, item->GetGUID().GetCounter());
-                trans->Append(stmt);
+                inventoryStmts.push_back(stmt);
             case ITEM_UNCHANGED:
                 break;
         }
@@ -21561,6 +21611,9 @@ void Player::_SaveInventory(CharacterDatabaseTransaction& trans)
         item->SaveToDB(trans);                                   // item have unchanged inventory record and can be save standalone
     }
     m_itemUpdateQueue.clear();
+
+    for (CharacterDatabasePreparedStatement* inventoryStmt : inventoryStmts)
+        trans->Append(inventoryStmt);
 }
 
 void Player::_SaveVoidStorage(CharacterDatabaseTransaction& trans)
@@ -21601,6 +21654,11 @@ void Player::_SaveVoidStorage(CharacterDatabaseTransaction& trans)
 
 void Player::_SaveCUFProfiles(CharacterDatabaseTransaction& trans)
 {
+    if (!(m_changedSaveData & PLAYER_SAVE_DATA_CUF_PROFILES))
+        return;
+
+    m_changedSaveData &= ~PLAYER_SAVE_DATA_CUF_PROFILES;
+
     CharacterDatabasePreparedStatement* stmt;
     for (uint8 i = 0; i < MAX_CUF_PROFILES; ++i)
     {
@@ -21720,6 +21778,10 @@ void Player::_SaveQuestStatus(CharacterDatabaseTransaction& trans)
 
     bool keepAbandoned = !(sWorld->GetCleaningFlags() & CharacterDatabaseCleaner::CLEANING_FLAG_QUESTSTATUS);
 
+    // every quest is either saved or deleted, so saved statuses and objectives can be grouped by statement to be batched
+    std::vector<CharacterDatabasePreparedStatement*> statusStmts;
+    std::vector<CharacterDatabasePreparedStatement*> objectiveStmts;
+
     for (saveItr = m_QuestStatusSave.begin(); saveItr != m_QuestStatusSave.end(); ++saveItr)
     {
         if (saveItr->second == QUEST_DEFAULT_SAVE_TYPE)
@@ -21736,7 +21798,7 @@ void Player::_SaveQuestStatus(CharacterDatabaseTransaction& trans)
                 stmt->setUInt8(2, uint8(qData.Status));
                 stmt->setUInt32(3, uint32(qData.Timer / IN_MILLISECONDS+ GameTime::GetGameTime()));
                 stmt->setBool(4, qData.Explored);
-                trans->Append(stmt);
+                statusStmts.push_back(stmt);
 
                 // Save objectives
                 for (uint32 i = 0; i < qData.ObjectiveData.size(); ++i)
@@ -21746,7 +21808,7 @@ void Player::_SaveQuestStatus(CharacterDatabaseTransaction& trans)
                     stmt->setUInt32(1, statusItr->first);
                     stmt->setUInt8(2, i);
                     stmt->setInt32(3, qData.ObjectiveData[i]);
-                    trans->Append(stmt);
+                    objectiveStmts.push_back(stmt);
                 }
             }
         }
@@ -21765,6 +21827,12 @@ void Player::_SaveQuestStatus(CharacterDatabaseTransaction& trans)
         }
     }
 
+    for (CharacterDatabasePreparedStatement* statusStmt : statusStmts)
+        trans->Append(statusStmt);
+
+    for (CharacterDatabasePreparedStatement* objectiveStmt : objectiveStmts)
+        trans->Append(objectiveStmt);
+
     m_QuestStatusSave.clear();
 
     for (saveItr = m_RewardedQuestsSave.begin(); saveItr != m_RewardedQuestsSave.end(); ++saveItr)
@@ -21955,6 +22023,9 @@ void Player::_SaveSpells(CharacterDatabaseTransaction& trans)
 {
     CharacterDatabasePreparedStatement* stmt;
 
+    // inserts follow all deletes so each kind of statement can be batched
+    std::vector<CharacterDatabasePreparedStatement*> inserts;
+
     for (PlayerSpellMap::iterator itr = m_spells.begin(); itr != m_spells.end();)
     {
         if (itr->second->state == PLAYERSPELL_REMOVED || itr->second->state == PLAYERSPELL_CHANGED)
@@ -21973,7 +22044,7 @@ void Player::_SaveSpells(CharacterDatabaseTransaction& trans)
             stmt->setUInt32(1, itr->first);
             stmt->setBool(2, itr->second->active);
             stmt->setBool(3, itr->second->disabled);
-            trans->Append(stmt);
+            inserts.push_back(stmt);
         }
 
         if (itr->second->state == PLAYERSPELL_REMOVED)
@@ -21987,6 +22058,9 @@ void Player::_SaveSpells(CharacterDatabaseTransaction& trans)
             ++itr;
         }
     }
+
+    for (CharacterDatabasePreparedStatement* insert : inserts)
+        trans->Append(insert);
 }
 
 // save player stats -- only for external usage
@@ -27432,6 +27506,7 @@ bool Player::AddPvpTalent(PvpTalentEntry const* talent, uint8 activeTalentGroup,
         AddOverrideSpell(talent->OverridesSpellID, talent->SpellID);
 
     GetPvpTalentMap(activeTalentGroup)[slot] = talent->ID;
+    SetSaveDataChanged(PLAYER_SAVE_DATA_PVP_TALENTS);
 
     return true;
 }
@@ -27451,7 +27526,10 @@ void Player::RemovePvpTalent(PvpTalentEntry const* talent)
     // if this talent rank can be found in the PlayerTalentMap, mark the talent as removed so it gets deleted
     auto plrPvpTalent = std::find(GetPvpTalentMap(GetActiveTalentGroup()).begin(), GetPvpTalentMap(GetActiveTalentGroup()).end(), talent->ID);
     if (plrPvpTalent != GetPvpTalentMap(GetActiveTalentGroup()).end())
+    {
         *plrPvpTalent = 0;
+        SetSaveDataChanged(PLAYER_SAVE_DATA_PVP_TALENTS);
+    }
 }
 
 void Player::TogglePvpTalents(bool enable)
@@ -27958,8 +28036,13 @@ void Player::_LoadGlyphs(PreparedQueryResult result)
     } while (result->NextRow());
 }
 
-void Player::_SaveGlyphs(CharacterDatabaseTransaction& trans) const
+void Player::_SaveGlyphs(CharacterDatabaseTransaction& trans)
 {
+    if (!(m_changedSaveData & PLAYER_SAVE_DATA_GLYPHS))
+        return;
+
+    m_changedSaveData &= ~PLAYER_SAVE_DATA_GLYPHS;
+
     CharacterDatabasePreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_CHAR_GLYPHS);
     stmt->setUInt64(0, GetGUID().GetCounter());
     trans->Append(stmt);
@@ -28007,30 +28090,43 @@ void Player::_LoadPvpTalents(PreparedQueryResult result)
 
 void Player::_SaveTalents(CharacterDatabaseTransaction& trans)
 {
-    CharacterDatabasePreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_CHAR_TALENT);
-    stmt->setUInt64(0, GetGUID().GetCounter());
-    trans->Append(stmt);
-
+    CharacterDatabasePreparedStatement* stmt;
     for (uint8 group = 0; group < MAX_SPECIALIZATIONS; ++group)
     {
         PlayerTalentMap* talents = GetTalentMap(group);
         for (auto itr = talents->begin(); itr != talents->end();)
         {
-            if (itr->second == PLAYERSPELL_REMOVED)
+            switch (itr->second)
             {
-                itr = talents->erase(itr);
-                continue;
+                case PLAYERSPELL_REMOVED:
+                    stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_CHAR_TALENT_BY_ID);
+                    stmt->setUInt64(0, GetGUID().GetCounter());
+                    stmt->setUInt32(1, itr->first);
+                    stmt->setUInt8(2, group);
+                    trans->Append(stmt);
+                    itr = talents->erase(itr);
+                    continue;
+                case PLAYERSPELL_NEW:
+                    stmt = CharacterDatabase.GetPreparedStatement(CHAR_INS_CHAR_TALENT);
+                    stmt->setUInt64(0, GetGUID().GetCounter());
+                    stmt->setUInt32(1, itr->first);
+                    stmt->setUInt8(2, group);
+                    trans->Append(stmt);
+                    itr->second = PLAYERSPELL_UNCHANGED;
+                    break;
+                default:
+                    break;
             }
 
-            stmt = CharacterDatabase.GetPreparedStatement(CHAR_INS_CHAR_TALENT);
-            stmt->setUInt64(0, GetGUID().GetCounter());
-            stmt->setUInt32(1, itr->first);
-            stmt->setUInt8(2, group);
-            trans->Append(stmt);
             ++itr;
         }
     }
 
+    if (!(m_changedSaveData & PLAYER_SAVE_DATA_PVP_TALENTS))
+        return;
+
+    m_changedSaveData &= ~PLAYER_SAVE_DATA_PVP_TALENTS;
+
     stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_CHAR_PVP_TALENT);
     stmt->setUInt64(0, GetGUID().GetCounter());
     trans->Append(stmt);
@@ -177,6 +177,17 @@ enum PlayerSpellState : uint8
     PLAYERSPELL_TEMPORARY = 4
 };
 
+// Collections that are saved by rewriting all their rows, skipped by Player::SaveToDB while unchanged
+enum PlayerSaveData
+{
+    PLAYER_SAVE_DATA_GLYPHS         = 0x01,
+    PLAYER_SAVE_DATA_PVP_TALENTS    = 0x02,
+    PLAYER_SAVE_DATA_CUF_PROFILES   = 0x04,
+    PLAYER_SAVE_DATA_AURAS          = 0x08,                 // set by _SaveAuras itself while saveable auras exist (durations change all the time)
+
+    PLAYER_SAVE_DATA_ALL            = 0x0F
+};
+
 struct PlayerSpell
 {
     PlayerSpellState state : 8;
@@ -1502,8 +1513,8 @@ class TC_GAME_API Player : public Unit, public GridObject<Player>
         void AddTimedQuest(uint32 questId) { m_timedquests.insert(questId); }
         void RemoveTimedQuest(uint32 questId) { m_timedquests.erase(questId); }
 
-        void SaveCUFProfile(uint8 id, std::nullptr_t) { _CUFProfiles[id] = nullptr; } ///> Empties a CUF profile at position 0-4
-        void SaveCUFProfile(uint8 id, std::unique_ptr<CUFProfile> profile) { _CUFProfiles[id] = std::move(profile); } ///> Replaces a CUF profile at position 0-4
+        void SaveCUFProfile(uint8 id, std::nullptr_t) { _CUFProfiles[id] = nullptr; SetSaveDataChanged(PLAYER_SAVE_DATA_CUF_PROFILES); } ///> Empties a CUF profile at position 0-4
+        void SaveCUFProfile(uint8 id, std::unique_ptr<CUFProfile> profile) { _CUFProfiles[id] = std::move(profile); SetSaveDataChanged(PLAYER_SAVE_DATA_CUF_PROFILES); } ///> Replaces a CUF profile at position 0-4
         CUFProfile* GetCUFProfile(uint8 id) const { return _CUFProfiles[id].get(); } ///> Retrieves a CUF profile at position 0-4
         uint8 GetCUFProfilesCount() const
         {
@@ -1705,6 +1716,7 @@ class TC_GAME_API Player : public Unit, public GridObject<Player>
         PlayerPvpTalentMap& GetPvpTalentMap(uint8 spec) { return _specializationInfo.PvpTalents[spec]; }
         std::vector<uint32> const& GetGlyphs(uint8 spec) const { return _specializationInfo.Glyphs[spec]; }
         std::vector<uint32>& GetGlyphs(uint8 spec) { return _specializationInfo.Glyphs[spec]; }
+        void SetSaveDataChanged(PlayerSaveData data) { m_changedSaveData |= data; }
         ActionButtonList const& GetActionButtons() const { return m_actionButtons; }
         void LoadActions(PreparedQueryResult result);
 
@@ -2742,7 +2754,7 @@ class TC_GAME_API Player : public Unit, public GridObject<Player>
         void _SaveEquipmentSets(CharacterDatabaseTransaction& trans);
         void _SaveArenaData(CharacterDatabaseTransaction& trans);
         void _SaveBGData(CharacterDatabaseTransaction& trans);
-        void _SaveGlyphs(CharacterDatabaseTransaction& trans) const;
+        void _SaveGlyphs(CharacterDatabaseTransaction& trans);
         void _SaveTalents(CharacterDatabaseTransaction& trans);
         void _SaveStats(CharacterDatabaseTransaction& trans) const;
         void _SaveInstanceTimeRestrictions(CharacterDatabaseTransaction& trans);
@@ -2907,6 +2919,8 @@ class TC_GAME_API Player : public Unit, public GridObject<Player>
 
         std::array<std::unique_ptr<CUFProfile>, MAX_CUF_PROFILES> _CUFProfiles;
 
+        uint32 m_changedSaveData;                           // PlayerSaveData mask of collections changed since the last save
+
     private:
         // internal common parts for CanStore/StoreItem functions
         InventoryResult CanStoreItem_InSpecificSlot(uint8 bag, uint8 slot, ItemPosCountVec& dest, ItemTemplate const* pProto, uint32& count, bool swap, Item* pSrcItem) const;
@@ -764,8 +764,9 @@ void Transport::BuildUpdate(UpdateDataMapType& data_map)
     if (players.isEmpty())
         return;
 
+    ValuesUpdateBlockCache sharedBlocks;
     for (Map::PlayerList::const_iterator itr = players.begin(); itr != players.end(); ++itr)
-        BuildFieldsUpdate(itr->GetSource(), data_map);
+        BuildFieldsUpdate(itr->GetSource(), data_map, &sharedBlocks);
 
     ClearUpdateMask(true);
 }
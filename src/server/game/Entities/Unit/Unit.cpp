@@ -290,7 +290,7 @@ Unit::Unit(bool isWorldObject) :
     IsAIEnabled(false), NeedChangeAI(false), LastCharmerGUID(),
     m_ControlledByPlayer(false), movespline(new Movement::MoveSpline()),
     i_AI(NULL), i_disabledAI(NULL), m_AutoRepeatFirstCast(false), m_procDeep(0),
-    m_removedAurasCount(0), i_motionMaster(new MotionMaster(this)), m_regenTimer(0), m_ThreatManager(this),
+    m_removedAurasCount(0), m_procAurasFlags(0), m_procAurasGeneration(0), i_motionMaster(new MotionMaster(this)), m_regenTimer(0), m_ThreatManager(this),
     m_vehicle(NULL), m_vehicleKit(NULL), m_unitTypeMask(UNIT_MASK_NONE),
     m_HostileRefManager(this), _aiAnimKitId(0), _movementAnimKitId(0), _meleeAnimKitId(0),
     _spellHistory(new SpellHistory(this)), _scheduler(this)
@@ -1875,7 +1875,7 @@ void Unit::CalcAbsorbResist(DamageInfo& damageInfo)
     // We're going to call functions which can modify content of the list during iteration over it's elements
     // Let's copy the list so we can prevent iterator invalidation
     AuraEffectList vSchoolAbsorbCopy(damageInfo.GetVictim()->GetAuraEffectsByType(SPELL_AURA_SCHOOL_ABSORB));
-    vSchoolAbsorbCopy.sort(Trinity::AbsorbAuraOrderPred());
+    std::stable_sort(vSchoolAbsorbCopy.begin(), vSchoolAbsorbCopy.end(), Trinity::AbsorbAuraOrderPred());
 
     // absorb without mana cost
     for (AuraEffectList::iterator itr = vSchoolAbsorbCopy.begin(); (itr != vSchoolAbsorbCopy.end()) && (damageInfo.GetDamage() > 0); ++itr)
@@ -2046,8 +2046,9 @@ void Unit::CalcHealAbsorb(HealInfo& healInfo) const
     bool existExpired = false;
 
     // absorb without mana cost
-    AuraEffectList const& vHealAbsorb = healInfo.GetTarget()->GetAuraEffectsByType(SPELL_AURA_SCHOOL_HEAL_ABSORB);
-    for (AuraEffectList::const_iterator i = vHealAbsorb.begin(); i != vHealAbsorb.end() && healInfo.GetHeal() > 0; ++i)
+    // copy, changing the amount moves the effect to the end of the list
+    AuraEffectList vHealAbsorbCopy(healInfo.GetTarget()->GetAuraEffectsByType(SPELL_AURA_SCHOOL_HEAL_ABSORB));
+    for (AuraEffectList::const_iterator i = vHealAbsorbCopy.begin(); i != vHealAbsorbCopy.end() && healInfo.GetHeal() > 0; ++i)
     {
         if (!((*i)->GetMiscValue() & healInfo.GetSpellInfo()->SchoolMask))
             continue;
@@ -2078,17 +2079,23 @@ void Unit::CalcHealAbsorb(HealInfo& healInfo) const
     // Remove all expired absorb auras
     if (existExpired)
     {
-        for (AuraEffectList::const_iterator i = vHealAbsorb.begin(); i != vHealAbsorb.end();)
+        AuraEffectList const& vHealAbsorb = healInfo.GetTarget()->GetAuraEffectsByType(SPELL_AURA_SCHOOL_HEAL_ABSORB);
+        for (std::size_t i = 0; i < vHealAbsorb.size();)
         {
-            AuraEffect* auraEff = *i;
-            ++i;
+            AuraEffect* auraEff = vHealAbsorb[i];
             if (auraEff->GetAmount() <= 0)
             {
                 uint32 removedAuras = healInfo.GetTarget()->m_removedAurasCount;
                 auraEff->GetBase()->Remove(AURA_REMOVE_BY_ENEMY_SPELL);
                 if (removedAuras + 1 < healInfo.GetTarget()->m_removedAurasCount)
-                    i = vHealAbsorb.begin();
+                {
+                    i = 0;
+                    continue;
+                }
             }
+
+            if (i < vHealAbsorb.size() && vHealAbsorb[i] == auraEff)
+                ++i;
         }
     }
 }
@@ -3500,6 +3507,7 @@ AuraApplication * Unit::_CreateAuraApplication(Aura* aura, uint32 effMask)
 
     AuraApplication * aurApp = new AuraApplication(this, caster, aura, effMask);
     m_appliedAuras.insert(AuraApplicationMap::value_type(aurId, aurApp));
+    _RegisterProcAura(aurApp, true);
 
     if (caster)
         caster->RegisterTargetAura(aurApp);
@@ -3588,6 +3596,7 @@ void Unit::_UnapplyAura(AuraApplicationMap::iterator &i, AuraRemoveMode removeMo
 
     // Remove all pointers from lists here to prevent possible pointer invalidation on spellcast/auraapply/auraremove
     m_appliedAuras.erase(i);
+    _RegisterProcAura(aurApp, false);
     if (caster)
         caster->UnregisterTargetAura(aurApp);
 
@@ -3711,10 +3720,65 @@ void Unit::_RemoveNoStackAurasDueToAura(Aura* aura)
 
 void Unit::_RegisterAuraEffect(AuraEffect* aurEff, bool apply)
 {
+    InvalidateAuraModifierCache(aurEff->GetAuraType());
+
     if (apply)
         m_modAuras[aurEff->GetAuraType()].push_back(aurEff);
     else
-        m_modAuras[aurEff->GetAuraType()].remove(aurEff);
+    {
+        AuraEffectList& auras = m_modAuras[aurEff->GetAuraType()];
+        auras.erase(std::remove(auras.begin(), auras.end(), aurEff), auras.end());
+    }
+}
+
+void Unit::_RegisterProcAura(AuraApplication* aurApp, bool apply)
+{
+    uint32 spellId = aurApp->GetBase()->GetId();
+    if (apply)
+    {
+        SpellProcEntry const* procEntry = sSpellMgr->GetSpellProcEntry(spellId);
+        if (!procEntry || !procEntry->ProcFlags)
+            return;
+
+        // after the applications of the same spell, like m_appliedAuras
+        auto itr = std::find_if(m_procAuras.begin(), m_procAuras.end(), [spellId](std::pair<uint32, AuraApplication*> const& procAura)
+        {
+            return procAura.second->GetBase()->GetId() > spellId;
+        });
+        m_procAuras.emplace(itr, procEntry->ProcFlags, aurApp);
+        m_procAurasFlags |= procEntry->ProcFlags;
+    }
+    else
+    {
+        auto itr = std::find_if(m_procAuras.begin(), m_procAuras.end(), [aurApp](std::pair<uint32, AuraApplication*> const& procAura)
+        {
+            return procAura.second == aurApp;
+        });
+        if (itr == m_procAuras.end())
+            return;
+
+        m_procAuras.erase(itr);
+        m_procAurasFlags = 0;
+        for (std::pair<uint32, AuraApplication*> const& procAura : m_procAuras)
+            m_procAurasFlags |= procAura.first;
+    }
+}
+
+void Unit::_RebuildProcAuras()
+{
+    m_procAuras.clear();
+    m_procAurasFlags = 0;
+    m_procAurasGeneration = sSpellMgr->GetSpellProcGeneration();
+
+    for (AuraApplicationMap::value_type const& pair : m_appliedAuras)
+    {
+        SpellProcEntry const* procEntry = sSpellMgr->GetSpellProcEntry(pair.first);
+        if (!procEntry || !procEntry->ProcFlags)
+            continue;
+
+        m_procAuras.emplace_back(procEntry->ProcFlags, pair.second);
+        m_procAurasFlags |= procEntry->ProcFlags;
+    }
 }
 
 // All aura base removes should go threw this function!
@@ -3977,20 +4041,28 @@ void Unit::RemoveOwnedAuras(uint32 spellId, std::function<bool(Aura const*)> con
 
 void Unit::RemoveAurasByType(AuraType auraType, std::function<bool(AuraApplication const*)> const& check)
 {
-    for (AuraEffectList::iterator iter = m_modAuras[auraType].begin(); iter != m_modAuras[auraType].end();)
+    AuraEffectList const& auras = m_modAuras[auraType];
+    for (std::size_t i = 0; i < auras.size();)
     {
-        Aura* aura = (*iter)->GetBase();
+        AuraEffect* aurEff = auras[i];
+        Aura* aura = aurEff->GetBase();
         AuraApplication * aurApp = aura->GetApplicationOfTarget(GetGUID());
         ASSERT(aurApp);
 
-        ++iter;
         if (check(aurApp))
         {
             uint32 removedAuras = m_removedAurasCount;
             RemoveAura(aurApp);
             if (m_removedAurasCount > removedAuras + 1)
-                iter = m_modAuras[auraType].begin();
+            {
+                i = 0;
+                continue;
+            }
         }
+
+        // removed effects are erased, the next one moved to the same index
+        if (i < auras.size() && auras[i] == aurEff)
+            ++i;
     }
 }
 
@@ -4147,21 +4219,28 @@ void Unit::RemoveAurasDueToItemSpell(uint32 spellId, ObjectGuid castItemGuid)
 
 void Unit::RemoveAurasByType(AuraType auraType, ObjectGuid casterGUID, Aura* except, bool negative, bool positive)
 {
-    for (AuraEffectList::iterator iter = m_modAuras[auraType].begin(); iter != m_modAuras[auraType].end();)
+    AuraEffectList const& auras = m_modAuras[auraType];
+    for (std::size_t i = 0; i < auras.size();)
     {
-        Aura* aura = (*iter)->GetBase();
+        AuraEffect* aurEff = auras[i];
+        Aura* aura = aurEff->GetBase();
         AuraApplication * aurApp = aura->GetApplicationOfTarget(GetGUID());
         ASSERT(aurApp);
 
-        ++iter;
         if (aura != except && (!casterGUID || aura->GetCasterGUID() == casterGUID)
             && ((negative && !aurApp->IsPositive()) || (positive && aurApp->IsPositive())))
         {
             uint32 removedAuras = m_removedAurasCount;
             RemoveAura(aurApp);
             if (m_removedAurasCount > removedAuras + 1)
-                iter = m_modAuras[auraType].begin();
+            {
+                i = 0;
+                continue;
+            }
         }
+
+        if (i < auras.size() && auras[i] == aurEff)
+            ++i;
     }
 }
 
@@ -5011,103 +5090,161 @@ int32 Unit::GetMaxNegativeAuraModifier(AuraType auratype, std::function<bool(Aur
     return modifier;
 }
 
+template<typename T, typename Calculate>
+T Unit::GetCachedAuraModifier(AuraType auratype, AuraModifierQuery query, AuraModifierFilter filter, int32 misc, Calculate calculate) const
+{
+    // the lists of most types are empty, nothing to save there
+    if (m_modAuras[auratype].empty())
+        return calculate();
+
+    std::vector<AuraModifierCacheEntry>& entries = m_auraModifierCache[auratype];
+    for (AuraModifierCacheEntry const& entry : entries)
+        if (entry.Query == query && entry.Filter == filter && entry.Misc == misc)
+            return T(entry.Value);
+
+    T value = calculate();
+    entries.push_back({ query, filter, misc, double(value) });
+    return value;
+}
+
 int32 Unit::GetTotalAuraModifier(AuraType auratype) const
 {
-    return GetTotalAuraModifier(auratype, [](AuraEffect const* /*aurEff*/) { return true; });
+    return GetCachedAuraModifier<int32>(auratype, AURA_MODIFIER_TOTAL, AURA_MODIFIER_FILTER_NONE, 0, [this, auratype]()
+    {
+        return GetTotalAuraModifier(auratype, [](AuraEffect const* /*aurEff*/) { return true; });
+    });
 }
 
 float Unit::GetTotalAuraMultiplier(AuraType auratype) const
 {
-    return GetTotalAuraMultiplier(auratype, [](AuraEffect const* /*aurEff*/) { return true; });
+    return GetCachedAuraModifier<float>(auratype, AURA_MODIFIER_MULTIPLIER, AURA_MODIFIER_FILTER_NONE, 0, [this, auratype]()
+    {
+        return GetTotalAuraMultiplier(auratype, [](AuraEffect const* /*aurEff*/) { return true; });
+    });
 }
 
 int32 Unit::GetMaxPositiveAuraModifier(AuraType auratype) const
 {
-    return GetMaxPositiveAuraModifier(auratype, [](AuraEffect const* /*aurEff*/) { return true; });
+    return GetCachedAuraModifier<int32>(auratype, AURA_MODIFIER_MAX_POSITIVE, AURA_MODIFIER_FILTER_NONE, 0, [this, auratype]()
+    {
+        return GetMaxPositiveAuraModifier(auratype, [](AuraEffect const* /*aurEff*/) { return true; });
+    });
 }
 
 int32 Unit::GetMaxNegativeAuraModifier(AuraType auratype) const
 {
-    return GetMaxNegativeAuraModifier(auratype, [](AuraEffect const* /*aurEff*/) { return true; });
+    return GetCachedAuraModifier<int32>(auratype, AURA_MODIFIER_MAX_NEGATIVE, AURA_MODIFIER_FILTER_NONE, 0, [this, auratype]()
+    {
+        return GetMaxNegativeAuraModifier(auratype, [](AuraEffect const* /*aurEff*/) { return true; });
+    });
 }
 
 int32 Unit::GetTotalAuraModifierByMiscMask(AuraType auratype, uint32 miscMask) const
 {
-    return GetTotalAuraModifier(auratype, [miscMask](AuraEffect const* aurEff) -> bool
+    return GetCachedAuraModifier<int32>(auratype, AURA_MODIFIER_TOTAL, AURA_MODIFIER_FILTER_MISC_MASK, int32(miscMask), [this, auratype, miscMask]()
     {
-        if ((aurEff->GetMiscValue() & miscMask) != 0)
-            return true;
-        return false;
+        return GetTotalAuraModifier(auratype, [miscMask](AuraEffect const* aurEff) -> bool
+        {
+            if ((aurEff->GetMiscValue() & miscMask) != 0)
+                return true;
+            return false;
+        });
     });
 }
 
 float Unit::GetTotalAuraMultiplierByMiscMask(AuraType auratype, uint32 miscMask) const
 {
-    return GetTotalAuraMultiplier(auratype, [miscMask](AuraEffect const* aurEff) -> bool
+    return GetCachedAuraModifier<float>(auratype, AURA_MODIFIER_MULTIPLIER, AURA_MODIFIER_FILTER_MISC_MASK, int32(miscMask), [this, auratype, miscMask]()
     {
-        if ((aurEff->GetMiscValue() & miscMask) != 0)
-            return true;
-        return false;
+        return GetTotalAuraMultiplier(auratype, [miscMask](AuraEffect const* aurEff) -> bool
+        {
+            if ((aurEff->GetMiscValue() & miscMask) != 0)
+                return true;
+            return false;
+        });
     });
 }
 
 int32 Unit::GetMaxPositiveAuraModifierByMiscMask(AuraType auratype, uint32 miscMask, AuraEffect const* except /*= nullptr*/) const
 {
-    return GetMaxPositiveAuraModifier(auratype, [miscMask, except](AuraEffect const* aurEff) -> bool
+    auto calculate = [this, auratype, miscMask, except]()
     {
-        if (except != aurEff && (aurEff->GetMiscValue() & miscMask) != 0)
-            return true;
-        return false;
-    });
+        return GetMaxPositiveAuraModifier(auratype, [miscMask, except](AuraEffect const* aurEff) -> bool
+        {
+            if (except != aurEff && (aurEff->GetMiscValue() & miscMask) != 0)
+                return true;
+            return false;
+        });
+    };
+
+    if (except)
+        return calculate();
+
+    return GetCachedAuraModifier<int32>(auratype, AURA_MODIFIER_MAX_POSITIVE, AURA_MODIFIER_FILTER_MISC_MASK, int32(miscMask), calculate);
 }
 
 int32 Unit::GetMaxNegativeAuraModifierByMiscMask(AuraType auratype, uint32 miscMask) const
 {
-    return GetMaxNegativeAuraModifier(auratype, [miscMask](AuraEffect const* aurEff) -> bool
+    return GetCachedAuraModifier<int32>(auratype, AURA_MODIFIER_MAX_NEGATIVE, AURA_MODIFIER_FILTER_MISC_MASK, int32(miscMask), [this, auratype, miscMask]()
     {
-        if ((aurEff->GetMiscValue() & miscMask) != 0)
-            return true;
-        return false;
+        return GetMaxNegativeAuraModifier(auratype, [miscMask](AuraEffect const* aurEff) -> bool
+        {
+            if ((aurEff->GetMiscValue() & miscMask) != 0)
+                return true;
+            return false;
+        });
     });
 }
 
 int32 Unit::GetTotalAuraModifierByMiscValue(AuraType auratype, int32 miscValue) const
 {
-    return GetTotalAuraModifier(auratype, [miscValue](AuraEffect const* aurEff) -> bool
+    return GetCachedAuraModifier<int32>(auratype, AURA_MODIFIER_TOTAL, AURA_MODIFIER_FILTER_MISC_VALUE, miscValue, [this, auratype, miscValue]()
     {
-        if (aurEff->GetMiscValue() == miscValue)
-            return true;
-        return false;
+        return GetTotalAuraModifier(auratype, [miscValue](AuraEffect const* aurEff) -> bool
+        {
+            if (aurEff->GetMiscValue() == miscValue)
+                return true;
+            return false;
+        });
     });
 }
 
 float Unit::GetTotalAuraMultiplierByMiscValue(AuraType auratype, int32 miscValue) const
 {
-    return GetTotalAuraMultiplier(auratype, [miscValue](AuraEffect const* aurEff) -> bool
+    return GetCachedAuraModifier<float>(auratype, AURA_MODIFIER_MULTIPLIER, AURA_MODIFIER_FILTER_MISC_VALUE, miscValue, [this, auratype, miscValue]()
     {
-        if (aurEff->GetMiscValue() == miscValue)
-            return true;
-        return false;
+        return GetTotalAuraMultiplier(auratype, [miscValue](AuraEffect const* aurEff) -> bool
+        {
+            if (aurEff->GetMiscValue() == miscValue)
+                return true;
+            return false;
+        });
     });
 }
 
 int32 Unit::GetMaxPositiveAuraModifierByMiscValue(AuraType auratype, int32 miscValue) const
 {
-    return GetMaxPositiveAuraModifier(auratype, [miscValue](AuraEffect const* aurEff) -> bool
+    return GetCachedAuraModifier<int32>(auratype, AURA_MODIFIER_MAX_POSITIVE, AURA_MODIFIER_FILTER_MISC_VALUE, miscValue, [this, auratype, miscValue]()
     {
-        if (aurEff->GetMiscValue() == miscValue)
-            return true;
-        return false;
+        return GetMaxPositiveAuraModifier(auratype, [miscValue](AuraEffect const* aurEff) -> bool
+        {
+            if (aurEff->GetMiscValue() == miscValue)
+                return true;
+            return false;
+        });
     });
 }
 
 int32 Unit::GetMaxNegativeAuraModifierByMiscValue(AuraType auratype, int32 miscValue) const
 {
-    return GetMaxNegativeAuraModifier(auratype, [miscValue](AuraEffect const* aurEff) -> bool
+    return GetCachedAuraModifier<int32>(auratype, AURA_MODIFIER_MAX_NEGATIVE, AURA_MODIFIER_FILTER_MISC_VALUE, miscValue, [this, auratype, miscValue]()
     {
-        if (aurEff->GetMiscValue() == miscValue)
-            return true;
-        return false;
+        return GetMaxNegativeAuraModifier(auratype, [miscValue](AuraEffect const* aurEff) -> bool
+        {
+            if (aurEff->GetMiscValue() == miscValue)
+                return true;
+            return false;
+        });
     });
 }
 
@@ -10820,12 +10957,24 @@ void Unit::GetProcAurasTriggeredOnEvent(AuraApplicationProcContainer& aurasTrigg
     // or generate one on our own
     else
     {
-        for (AuraApplicationMap::iterator itr = GetAppliedAuras().begin(); itr != GetAppliedAuras().end(); ++itr)
+        // proc entries were reloaded
+        if (m_procAurasGeneration != sSpellMgr->GetSpellProcGeneration())
+            _RebuildProcAuras();
+
+        // auras without an entry or with other proc flags can't pass Aura::GetProcEffectMask
+        if (!(eventInfo.GetTypeMask() & m_procAurasFlags))
+            return;
+
+        for (std::size_t i = 0; i < m_procAuras.size(); ++i)
         {
-            if (uint32 procEffectMask = itr->second->GetBase()->GetProcEffectMask(itr->second, eventInfo, now))
+            if (!(eventInfo.GetTypeMask() & m_procAuras[i].first))
+                continue;
+
+            AuraApplication* aurApp = m_procAuras[i].second;
+            if (uint32 procEffectMask = aurApp->GetBase()->GetProcEffectMask(aurApp, eventInfo, now))
             {
-                itr->second->GetBase()->PrepareProcToTrigger(itr->second, eventInfo, now);
-                aurasTriggeringProc.emplace_back(procEffectMask, itr->second);
+                aurApp->GetBase()->PrepareProcToTrigger(aurApp, eventInfo, now);
+                aurasTriggeringProc.emplace_back(procEffectMask, aurApp);
             }
         }
     }
@@ -14678,6 +14827,22 @@ void Unit::BuildValuesUpdate(ByteBuffer* data, Player const* target) const
     data->put<uint32>(sizePos, data->wpos() - sizePos - 4);
 }
 
+bool Unit::HasViewerDependentChanges() const
+{
+    if (Object::HasViewerDependentChanges())
+        return true;
+
+    UF::UnitData const& unitData = *m_unitData;
+    return unitData.IsChanged(&UF::UnitData::DisplayID)
+        || unitData.IsChanged(&UF::UnitData::NpcFlags)
+        || unitData.IsChanged(&UF::UnitData::FactionTemplate)
+        || unitData.IsChanged(&UF::UnitData::Flags)
+        || unitData.IsChanged(&UF::UnitData::Flags2)
+        || unitData.IsChanged(&UF::UnitData::Flags3)
+        || unitData.IsChanged(&UF::UnitData::AuraState)
+        || unitData.IsChanged(&UF::UnitData::PvpFlags);
+}
+
 void Unit::BuildValuesUpdateWithFlag(ByteBuffer* data, UF::UpdateFieldFlag flags, Player const* target) const
 {
     UpdateMask<NUM_CLIENT_OBJECT_TYPES> valuesMask;
@@ -14808,10 +14973,9 @@ bool Unit::IsHighestExclusiveAura(Aura const* aura, bool removeOtherAuraApplicat
             continue;
         AuraType const auraType = AuraType(aurEff->GetSpellEffectInfo()->ApplyAuraName);
         AuraEffectList const& auras = GetAuraEffectsByType(auraType);
-        for (Unit::AuraEffectList::const_iterator itr = auras.begin(); itr != auras.end();)
+        for (std::size_t i = 0; i < auras.size();)
         {
-            AuraEffect const* existingAurEff = (*itr);
-            ++itr;
+            AuraEffect const* existingAurEff = auras[i];
 
             if (sSpellMgr->CheckSpellGroupStackRules(aura->GetSpellInfo(), existingAurEff->GetSpellInfo())
                 == SPELL_GROUP_STACK_RULE_EXCLUSIVE_HIGHEST)
@@ -14832,13 +14996,19 @@ bool Unit::IsHighestExclusiveAura(Aura const* aura, bool removeOtherAuraApplicat
                             uint32 removedAuras = m_removedAurasCount;
                             RemoveAura(aurApp);
                             if (hasMoreThanOneEffect || m_removedAurasCount > removedAuras + 1)
-                                itr = auras.begin();
+                            {
+                                i = 0;
+                                continue;
+                            }
                         }
                     }
                 }
                 else if (diff < 0)
                     return false;
             }
+
+            if (i < auras.size() && auras[i] == existingAurEff)
+                ++i;
         }
     }
 
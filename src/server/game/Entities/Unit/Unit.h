@@ -937,7 +937,8 @@ class TC_GAME_API Unit : public WorldObject
         typedef std::multimap<AuraStateType,  AuraApplication*> AuraStateAurasMap;
         typedef std::pair<AuraStateAurasMap::const_iterator, AuraStateAurasMap::const_iterator> AuraStateAurasMapBounds;
 
-        typedef std::list<AuraEffect*> AuraEffectList;
+        // contiguous, adding or removing an effect of a type invalidates iterators over that type
+        typedef std::vector<AuraEffect*> AuraEffectList;
         typedef std::list<Aura*> AuraList;
         typedef std::list<AuraApplication *> AuraApplicationList;
         typedef std::array<DiminishingReturn, DIMINISHING_MAX> Diminishing;
@@ -1524,6 +1525,8 @@ class TC_GAME_API Unit : public WorldObject
         void _UnapplyAura(AuraApplication * aurApp, AuraRemoveMode removeMode);
         void _RemoveNoStackAurasDueToAura(Aura* aura);
         void _RegisterAuraEffect(AuraEffect* aurEff, bool apply);
+        void _RegisterProcAura(AuraApplication* aurApp, bool apply);
+        void _RebuildProcAuras();
 
         // m_ownedAuras container management
         AuraMap      & GetOwnedAuras()       { return m_ownedAuras; }
@@ -1653,6 +1656,10 @@ class TC_GAME_API Unit : public WorldObject
         float GetTotalAuraMultiplierByAffectMask(AuraType auratype, SpellInfo const* affectedSpell) const;
         int32 GetMaxPositiveAuraModifierByAffectMask(AuraType auratype, SpellInfo const* affectedSpell) const;
         int32 GetMaxNegativeAuraModifierByAffectMask(AuraType auratype, SpellInfo const* affectedSpell) const;
+
+        // results of the queries without predicate or affect mask are cached until an effect of the type is added, removed or changes its amount
+        void InvalidateAuraModifierCache(AuraType auratype) { m_auraModifierCache.erase(auratype); }
+
         int32 GetTotalSpellPowerValue(SpellSchoolMask mask, bool heal) const;
 
         void InitStatBuffMods();
@@ -2080,6 +2087,7 @@ class TC_GAME_API Unit : public WorldObject
         UF::UpdateFieldFlag GetUpdateFieldFlagsFor(Player const* target) const override;
         void BuildValuesCreate(ByteBuffer* data, Player const* target) const override;
         void BuildValuesUpdate(ByteBuffer* data, Player const* target) const override;
+        bool HasViewerDependentChanges() const override;
 
     public:
         void BuildValuesUpdateWithFlag(ByteBuffer* data, UF::UpdateFieldFlag flags, Player const* target) const override;
@@ -2128,9 +2136,42 @@ class TC_GAME_API Unit : public WorldObject
         AuraMap::iterator m_auraUpdateIterator;
         uint32 m_removedAurasCount;
 
+        // applied auras with a spell_proc entry in m_appliedAuras order, with the proc flags of the entry to skip the others without a lookup
+        std::vector<std::pair<uint32 /*procFlags*/, AuraApplication*>> m_procAuras;
+        uint32 m_procAurasFlags;                   // all proc flags of m_procAuras
+        uint32 m_procAurasGeneration;              // SpellMgr::GetSpellProcGeneration the entries were taken from
+
         TargetAuraContainer m_targetAuras;
 
         AuraEffectList m_modAuras[TOTAL_AURAS];
+
+        enum AuraModifierQuery : uint8
+        {
+            AURA_MODIFIER_TOTAL,
+            AURA_MODIFIER_MULTIPLIER,
+            AURA_MODIFIER_MAX_POSITIVE,
+            AURA_MODIFIER_MAX_NEGATIVE
+        };
+
+        enum AuraModifierFilter : uint8
+        {
+            AURA_MODIFIER_FILTER_NONE,
+            AURA_MODIFIER_FILTER_MISC_MASK,
+            AURA_MODIFIER_FILTER_MISC_VALUE
+        };
+
+        struct AuraModifierCacheEntry
+        {
+            AuraModifierQuery Query;
+            AuraModifierFilter Filter;
+            int32 Misc;
+            double Value;                          // holds both int32 modifiers and float multipliers exactly
+        };
+
+        template<typename T, typename Calculate>
+        T GetCachedAuraModifier(AuraType auratype, AuraModifierQuery query, AuraModifierFilter filter, int32 misc, Calculate calculate) const;
+
+        mutable std::unordered_map<uint32 /*AuraType*/, std::vector<AuraModifierCacheEntry>> m_auraModifierCache;
         AuraList m_scAuras;                        // cast singlecast auras
         AuraApplicationList m_interruptableAuras;  // auras which have interrupt mask applied on unit
         AuraStateAurasMap m_auraStateAuras;        // Used for improve performance of aura state checks on aura apply/remove
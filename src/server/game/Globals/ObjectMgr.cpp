@@ -2033,22 +2033,6 @@ void ObjectMgr::LoadCreatures()
 {
     uint32 oldMSTime = getMSTime();
 
-    //                                               0              1   2    3       4        5             6           7           8           9            10             11              12
-    QueryResult result = WorldDatabase.Query("SELECT creature.guid, id, map, areaId, modelid, equipment_id, position_x, position_y, position_z, orientation, spawntimesecs, corpsetimesecs, spawndist, "
-    //   12               14         15       16            17                 18          19          20                21                   22                    23
-        "currentwaypoint, curhealth, curmana, MovementType, spawnDifficulties, eventEntry, pool_entry, creature.npcflag, creature.unit_flags, creature.unit_flags2, creature.unit_flags3, "
-    //   24                     25                      26                27                   28                       29
-        "creature.dynamicflags, creature.phaseUseFlags, creature.phaseid, creature.phasegroup, creature.terrainSwapMap, creature.ScriptName "
-        "FROM creature "
-        "LEFT OUTER JOIN game_event_creature ON creature.guid = game_event_creature.guid "
-        "LEFT OUTER JOIN pool_creature ON creature.guid = pool_creature.guid");
-
-    if (!result)
-    {
-        TC_LOG_ERROR("server.loading", ">> Loaded 0 creatures. DB table `creature` is empty.");
-        return;
-    }
-
     // Build single time for check spawnmask
     std::unordered_map<uint32, std::set<Difficulty>> spawnMasks;
     for (auto& mapDifficultyPair : sDB2Manager.GetMapDifficulties())
@@ -2057,14 +2041,18 @@ void ObjectMgr::LoadCreatures()
 
     PhaseShift phaseShift;
 
-    _creatureDataStore.reserve(result->GetRowCount());
-
     WorldDatabaseTransaction updateAreaTransaction = WorldDatabase.BeginTransaction();
 
-    do
+    //                                                  0              1   2    3       4        5             6           7           8           9            10             11              12
+    uint64 rowCount = WorldDatabase.StreamQuery("SELECT creature.guid, id, map, areaId, modelid, equipment_id, position_x, position_y, position_z, orientation, spawntimesecs, corpsetimesecs, spawndist, "
+    //   12               14         15       16            17                 18          19          20                21                   22                    23
+        "currentwaypoint, curhealth, curmana, MovementType, spawnDifficulties, eventEntry, pool_entry, creature.npcflag, creature.unit_flags, creature.unit_flags2, creature.unit_flags3, "
+    //   24                     25                      26                27                   28                       29
+        "creature.dynamicflags, creature.phaseUseFlags, creature.phaseid, creature.phasegroup, creature.terrainSwapMap, creature.ScriptName "
+        "FROM creature "
+        "LEFT OUTER JOIN game_event_creature ON creature.guid = game_event_creature.guid "
+        "LEFT OUTER JOIN pool_creature ON creature.guid = pool_creature.guid", [&](Field* fields)
     {
-        Field* fields = result->Fetch();
-
         ObjectGuid::LowType guid = fields[0].GetUInt64();
         uint32 entry        = fields[1].GetUInt32();
 
@@ -2072,7 +2060,7 @@ void ObjectMgr::LoadCreatures()
         if (!cInfo)
         {
             TC_LOG_ERROR("sql.sql", "Table `creature` has creature (GUID: " UI64FMTD ") with non existing creature entry %u, skipped.", guid, entry);
-            continue;
+            return;
         }
 
         CreatureData& data = _creatureDataStore[guid];
@@ -2110,7 +2098,7 @@ void ObjectMgr::LoadCreatures()
         if (!mapEntry)
         {
             TC_LOG_ERROR("sql.sql", "Table `creature` has creature (GUID: " UI64FMTD ") that spawned at nonexistent map (Id: %u), skipped.", guid, data.mapid);
-            continue;
+            return;
         }
 
         if (sWorld->getBoolConfig(CONFIG_CREATURE_CHECK_INVALID_POSITION))
@@ -2134,7 +2122,7 @@ void ObjectMgr::LoadCreatures()
         if (data.spawnDifficulties.empty())
         {
             TC_LOG_ERROR("sql.sql", "Table `creature` has creature (GUID: " UI64FMTD ") that is not spawned in any difficulty, skipped.", guid);
-            continue;
+            return;
         }
 
         bool ok = true;
@@ -2148,7 +2136,7 @@ void ObjectMgr::LoadCreatures()
             }
         }
         if (!ok)
-            continue;
+            return;
 
         // -1 random, 0 no equipment
         if (data.equipmentId != 0)
@@ -2267,8 +2255,13 @@ void ObjectMgr::LoadCreatures()
         // Add to grid if not managed by the game event or pool system
         if (gameEvent == 0 && PoolId == 0)
             AddCreatureToGrid(guid, &data);
+    });
+
+    if (!rowCount)
+    {
+        TC_LOG_ERROR("server.loading", ">> Loaded 0 creatures. DB table `creature` is empty.");
+        return;
     }
-    while (result->NextRow());
 
     WorldDatabase.CommitTransaction(updateAreaTransaction);
 
@@ -2400,21 +2393,6 @@ void ObjectMgr::LoadGameobjects()
 {
     uint32 oldMSTime = getMSTime();
 
-    //                                                0                1   2   3       4           5           6           7
-    QueryResult result = WorldDatabase.Query("SELECT gameobject.guid, id, map, areaId, position_x, position_y, position_z, orientation, "
-    //   8          9          10          11         12             13            14    15                 16          17
-        "rotation0, rotation1, rotation2, rotation3, spawntimesecs, animprogress, state, spawnDifficulties, eventEntry, pool_entry, "
-    //   18             19       20          21              22        23
-        "phaseUseFlags, phaseid, phasegroup, terrainSwapMap, isActive, ScriptName "
-        "FROM gameobject LEFT OUTER JOIN game_event_gameobject ON gameobject.guid = game_event_gameobject.guid "
-        "LEFT OUTER JOIN pool_gameobject ON gameobject.guid = pool_gameobject.guid");
-
-    if (!result)
-    {
-        TC_LOG_ERROR("server.loading", ">> Loaded 0 gameobjects. DB table `gameobject` is empty.");
-        return;
-    }
-
     // build single time for check spawnmask
     std::unordered_map<uint32, std::set<Difficulty>> spawnMasks;
     for (auto& mapDifficultyPair : sDB2Manager.GetMapDifficulties())
@@ -2423,14 +2401,17 @@ void ObjectMgr::LoadGameobjects()
 
     PhaseShift phaseShift;
 
-    _gameObjectDataStore.reserve(result->GetRowCount());
-
     WorldDatabaseTransaction updateAreaTransaction = WorldDatabase.BeginTransaction();
 
-    do
+    //                                                   0                1   2   3       4           5           6           7
+    uint64 rowCount = WorldDatabase.StreamQuery("SELECT gameobject.guid, id, map, areaId, position_x, position_y, position_z, orientation, "
+    //   8          9          10          11         12             13            14    15                 16          17
+        "rotation0, rotation1, rotation2, rotation3, spawntimesecs, animprogress, state, spawnDifficulties, eventEntry, pool_entry, "
+    //   18             19       20          21              22        23
+        "phaseUseFlags, phaseid, phasegroup, terrainSwapMap, isActive, ScriptName "
+        "FROM gameobject LEFT OUTER JOIN game_event_gameobject ON gameobject.guid = game_event_gameobject.guid "
+        "LEFT OUTER JOIN pool_gameobject ON gameobject.guid = pool_gameobject.guid", [&](Field* fields)
     {
-        Field* fields = result->Fetch();
-
         ObjectGuid::LowType guid = fields[0].GetUInt64();
         uint32 entry        = fields[1].GetUInt32();
 
@@ -2438,7 +2419,7 @@ void ObjectMgr::LoadGameobjects()
         if (!gInfo)
         {
             TC_LOG_ERROR("sql.sql", "Table `gameobject` has gameobject (GUID: " UI64FMTD ") with non existing gameobject entry %u, skipped.", guid, entry);
-            continue;
+            return;
         }
 
         if (!gInfo->displayId)
@@ -2457,7 +2438,7 @@ void ObjectMgr::LoadGameobjects()
         if (gInfo->displayId && !sGameObjectDisplayInfoStore.LookupEntry(gInfo->displayId))
         {
             TC_LOG_ERROR("sql.sql", "Gameobject (GUID: " UI64FMTD " Entry %u GoType: %u) has an invalid displayId (%u), not loaded.", guid, entry, gInfo->type, gInfo->displayId);
-            continue;
+            return;
         }
 
         GameObjectData& data = _gameObjectDataStore[guid];
@@ -2479,7 +2460,7 @@ void ObjectMgr::LoadGameobjects()
         if (!mapEntry)
         {
             TC_LOG_ERROR("sql.sql", "Table `gameobject` has gameobject (GUID: " UI64FMTD " Entry: %u) spawned on a non-existed map (Id: %u), skip", guid, data.id, data.mapid);
-            continue;
+            return;
         }
 
         if (sWorld->getBoolConfig(CONFIG_GAME_OBJECT_CHECK_INVALID_POSITION))
@@ -2514,7 +2495,7 @@ void ObjectMgr::LoadGameobjects()
             if (gInfo->type != GAMEOBJECT_TYPE_TRANSPORT || go_state > GO_STATE_TRANSPORT_ACTIVE + MAX_GO_STATE_TRANSPORT_STOP_FRAMES)
             {
                 TC_LOG_ERROR("sql.sql", "Table `gameobject` has gameobject (GUID: " UI64FMTD " Entry: %u) with invalid `state` (%u) value, skip", guid, data.id, go_state);
-                continue;
+                return;
             }
         }
         data.go_state       = GOState(go_state);
@@ -2523,7 +2504,7 @@ void ObjectMgr::LoadGameobjects()
         if (data.spawnDifficulties.empty())
         {
             TC_LOG_ERROR("sql.sql", "Table `creature` has creature (GUID: " UI64FMTD ") that is not spawned in any difficulty, skipped.", guid);
-            continue;
+            return;
         }
 
         int16 gameEvent     = fields[16].GetInt8();
@@ -2600,31 +2581,31 @@ void ObjectMgr::LoadGameobjects()
         if (data.rotation.x < -1.0f || data.rotation.x > 1.0f)
         {
             TC_LOG_ERROR("sql.sql", "Table `gameobject` has gameobject (GUID: " UI64FMTD " Entry: %u) with invalid rotationX (%f) value, skip", guid, data.id, data.rotation.x);
-            continue;
+            return;
         }
 
         if (data.rotation.y < -1.0f || data.rotation.y > 1.0f)
         {
             TC_LOG_ERROR("sql.sql", "Table `gameobject` has gameobject (GUID: " UI64FMTD " Entry: %u) with invalid rotationY (%f) value, skip", guid, data.id, data.rotation.y);
-            continue;
+            return;
         }
 
         if (data.rotation.z < -1.0f || data.rotation.z > 1.0f)
         {
             TC_LOG_ERROR("sql.sql", "Table `gameobject` has gameobject (GUID: " UI64FMTD " Entry: %u) with invalid rotationZ (%f) value, skip", guid, data.id, data.rotation.z);
-            continue;
+            return;
         }
 
         if (data.rotation.w < -1.0f || data.rotation.w > 1.0f)
         {
             TC_LOG_ERROR("sql.sql", "Table `gameobject` has gameobject (GUID: " UI64FMTD " Entry: %u) with invalid rotationW (%f) value, skip", guid, data.id, data.rotation.w);
-            continue;
+            return;
         }
 
         if (!MapManager::IsValidMapCoord(data.mapid, data.posX, data.posY, data.posZ, data.orientation))
         {
             TC_LOG_ERROR("sql.sql", "Table `gameobject` has gameobject (GUID: " UI64FMTD " Entry: %u) with invalid coordinates, skip", guid, data.id);
-            continue;
+            return;
         }
 
         if (!data.areaId)
@@ -2655,8 +2636,13 @@ void ObjectMgr::LoadGameobjects()
         // if not this is to be managed by GameEvent System or Pool system
         else if (gameEvent == 0 && PoolId == 0)
             AddGameobjectToGrid(guid, &data);
+    });
+
+    if (!rowCount)
+    {
+        TC_LOG_ERROR("server.loading", ">> Loaded 0 gameobjects. DB table `gameobject` is empty.");
+        return;
     }
-    while (result->NextRow());
 
     WorldDatabase.CommitTransaction(updateAreaTransaction);
 
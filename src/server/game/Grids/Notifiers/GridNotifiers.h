@@ -31,6 +31,7 @@
 #include "SpellInfo.h"
 #include "UnitAI.h"
 #include "UpdateData.h"
+#include "WorldSession.h"
 
 namespace Trinity
 {
@@ -123,6 +124,7 @@ namespace Trinity
     {
         WorldObject const* i_source;
         WorldPacket const* i_message;
+        std::shared_ptr<SharedPacketCompression> i_sharedCompression;
         float i_distSq;
         uint32 team;
         Player const* skipped_receiver;
@@ -134,6 +136,10 @@ namespace Trinity
             if (own_team_only)
                 if (Player const* player = src->ToPlayer())
                     team = player->GetTeam();
+
+            // compress large broadcasts once for all receivers
+            if (msg->CanShareCompression())
+                i_sharedCompression = msg->ShareCompression();
         }
 
         void Visit(PlayerMapType &m);
@@ -150,7 +156,7 @@ namespace Trinity
             if (!player->HaveAtClient(i_source))
                 return;
 
-            player->SendDirectMessage(i_message);
+            player->GetSession()->SendPacket(i_message, false, i_sharedCompression);
         }
     };
 
@@ -158,11 +164,15 @@ namespace Trinity
     {
         Unit* i_source;
         WorldPacket const* i_message;
+        std::shared_ptr<SharedPacketCompression> i_sharedCompression;
         float i_distSq;
 
         MessageDistDelivererToHostile(Unit* src, WorldPacket const* msg, float dist)
             : i_source(src), i_message(msg), i_distSq(dist * dist)
         {
+            // compress large broadcasts once for all receivers
+            if (msg->CanShareCompression())
+                i_sharedCompression = msg->ShareCompression();
         }
 
         void Visit(PlayerMapType &m);
@@ -176,7 +186,7 @@ namespace Trinity
             if (player == i_source || !player->HaveAtClient(i_source) || player->IsFriendlyTo(i_source))
                 return;
 
-            player->SendDirectMessage(i_message);
+            player->GetSession()->SendPacket(i_message, false, i_sharedCompression);
         }
     };
 
@@ -384,12 +384,9 @@ void WorldSession::HandleCharEnum(PreparedQueryResult result)
 
 void WorldSession::HandleCharEnumOpcode(WorldPackets::Character::EnumCharacters& /*enumCharacters*/)
 {
-    // remove expired bans
-    CharacterDatabasePreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_EXPIRED_BANS);
-    CharacterDatabase.Execute(stmt);
-
     /// get all the data necessary for loading all characters (along with their pets) on the account
-
+    /// expired bans are skipped by the query itself, so the result can be cached, see World::Update for their cleanup
+    CharacterDatabasePreparedStatement* stmt;
     if (sWorld->getBoolConfig(CONFIG_DECLINED_NAMES_USED))
         stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_ENUM_DECLINED_NAME);
     else
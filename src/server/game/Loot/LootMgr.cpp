@@ -134,17 +134,15 @@ uint32 LootStore::LoadLootTable()
     // Clearing store (for reloading case)
     Clear();
 
-    //                                                  0     1            2               3         4         5             6
-    QueryResult result = WorldDatabase.PQuery("SELECT Entry, Item, Reference, Chance, QuestRequired, LootMode, GroupId, MinCount, MaxCount FROM %s", GetName());
-
-    if (!result)
-        return 0;
-
     uint32 count = 0;
+    bool invalidGroup = false;
 
-    do
+    //                                                                             0     1            2               3         4         5             6
+    WorldDatabase.StreamQuery(Trinity::StringFormat("SELECT Entry, Item, Reference, Chance, QuestRequired, LootMode, GroupId, MinCount, MaxCount FROM %s", GetName()).c_str(), [&](Field* fields)
     {
-        Field* fields = result->Fetch();
+        // remaining rows still have to be received
+        if (invalidGroup)
+            return;
 
         uint32 entry               = fields[0].GetUInt32();
         int32  item                = fields[1].GetInt32();
@@ -160,7 +158,8 @@ uint32 LootStore::LoadLootTable()
         if (groupid >= 1 << 7)                                     // it stored in 7 bit field
         {
             TC_LOG_ERROR("sql.sql", "Table '%s' Entry %d Item %d: GroupId (%u) must be less %u - skipped", GetName(), entry, item, groupid, 1 << 7);
-            return 0;
+            invalidGroup = true;
+            return;
         }
 
         LootStoreItem* storeitem = new LootStoreItem(std::abs(item), type, reference, chance, needsquest, lootmode, groupid, mincount, maxcount);
@@ -168,7 +167,7 @@ uint32 LootStore::LoadLootTable()
         if (!storeitem->IsValid(*this, entry))            // Validity checks
         {
             delete storeitem;
-            continue;
+            return;
         }
 
         // Looking for the template of the entry
@@ -189,8 +188,10 @@ uint32 LootStore::LoadLootTable()
         // Adds current row to the template
         tab->second->AddEntry(storeitem);
         ++count;
-    }
-    while (result->NextRow());
+    });
+
+    if (invalidGroup)
+        return 0;
 
     Verify();                                           // Checks validity of the loot store
 
@@ -43,6 +43,7 @@
 #include "SceneObject.h"
 #include "PhasingHandler.h"
 #include "ScriptMgr.h"
+#include "TickProfiler.h"
 #include "Transport.h"
 #include "Vehicle.h"
 #include "VMapFactory.h"
@@ -50,6 +51,9 @@
 #include "WeatherMgr.h"
 #include "World.h"
 #include "WorldSession.h"
+#include <boost/thread/shared_mutex.hpp>
+#include <atomic>
+#include <condition_variable>
 
 u_map_magic MapMagic        = { {'M','A','P','S'} };
 u_map_magic MapVersionMagic = { {'v','1','.','9'} };
@@ -272,7 +276,7 @@ void Map::DeleteStateMachine()
 
 Map::Map(uint32 id, time_t expiry, uint32 InstanceId, Difficulty SpawnMode, Map* _parent):
 _creatureToMoveLock(false), _gameObjectsToMoveLock(false), _dynamicObjectsToMoveLock(false), _areaTriggersToMoveLock(false),
-i_mapEntry(sMapStore.LookupEntry(id)), i_spawnMode(SpawnMode), i_InstanceId(InstanceId),
+_regionUpdateInProgress(false), _dynamicTreeLock(Trinity::make_unique<boost::shared_mutex>()), _activeCellGeneration(0), _activeCellsDirty(false), i_mapEntry(sMapStore.LookupEntry(id)), i_spawnMode(SpawnMode), i_InstanceId(InstanceId),
 m_unloadTimer(0), m_VisibleDistance(DEFAULT_VISIBILITY_DISTANCE),
 m_VisibilityNotifyPeriod(DEFAULT_VISIBILITY_NOTIFY_PERIOD),
 m_activeNonPlayersIter(m_activeNonPlayers.end()), _transportsUpdateIter(_transports.end()),
@@ -554,6 +558,8 @@ void Map::EnsureGridLoadedForActiveObject(const Cell &cell, WorldObject* object)
 //Create NGrid and load the object data in it
 bool Map::EnsureGridLoaded(const Cell &cell)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+
     EnsureGridCreated(GridCoord(cell.GridX(), cell.GridY()));
     NGridType *grid = getNGrid(cell.GridX(), cell.GridY());
 
@@ -638,6 +644,8 @@ void Map::InitializeObject(GameObject* obj)
 template<class T>
 bool Map::AddToMap(T* obj)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+
     /// @todo Needs clean up. An object should not be added to map twice.
     if (obj->IsInWorld())
     {
@@ -717,131 +725,304 @@ bool Map::AddToMap(Transport* obj)
     return true;
 }
 
+template<class T>
+void Map::AddToEntryStore(std::unordered_map<uint32, std::vector<T*>>& store, T* obj)
+{
+    std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+
+    store[obj->GetEntry()].push_back(obj);
+}
+
+template<class T>
+void Map::RemoveFromEntryStore(std::unordered_map<uint32, std::vector<T*>>& store, T* obj)
+{
+    std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+
+    // entry changes go through Creature::SetEntry and GameObject::SetEntry, the bucket always matches the current entry
+    auto itr = store.find(obj->GetEntry());
+    ASSERT(itr != store.end());
+
+    auto objItr = std::find(itr->second.begin(), itr->second.end(), obj);
+    ASSERT(objItr != itr->second.end());
+
+    *objItr = itr->second.back();
+    itr->second.pop_back();
+    if (itr->second.empty())
+        store.erase(itr);
+}
+
+template<class T>
+std::vector<T*> const* Map::GetEntryScanCandidates(std::unordered_map<uint32, std::vector<T*>> const& store, uint32 entry, float x, float y, float radius) const
+{
+    // bucket scans are only worth it while they touch fewer objects than the grid visit would
+    static uint32 const ExpectedObjectsPerCell = 8;
+    static std::vector<T*> const NoCandidates;
+
+    // entry 0 means any entry, buckets may also be modified by other regions while those are updated concurrently
+    if (!entry || _regionUpdateInProgress)
+        return nullptr;
+
+    auto itr = store.find(entry);
+    if (itr == store.end())
+        return &NoCandidates;
+
+    CellArea area = Cell::CalculateCellArea(x, y, radius);
+    uint32 cellCount = (area.high_bound.x_coord - area.low_bound.x_coord + 1) * (area.high_bound.y_coord - area.low_bound.y_coord + 1);
+    if (itr->second.size() > cellCount * ExpectedObjectsPerCell)
+        return nullptr;
+
+    return &itr->second;
+}
+
+void Map::AddToEntryStore(Creature* creature)
+{
+    AddToEntryStore(_creatureByEntryStore, creature);
+}
+
+void Map::RemoveFromEntryStore(Creature* creature)
+{
+    RemoveFromEntryStore(_creatureByEntryStore, creature);
+}
+
+void Map::AddToEntryStore(GameObject* go)
+{
+    AddToEntryStore(_gameobjectByEntryStore, go);
+}
+
+void Map::RemoveFromEntryStore(GameObject* go)
+{
+    RemoveFromEntryStore(_gameobjectByEntryStore, go);
+}
+
+std::vector<Creature*> const* Map::GetCreatureEntryScanCandidates(uint32 entry, float x, float y, float radius) const
+{
+    return GetEntryScanCandidates(_creatureByEntryStore, entry, x, y, radius);
+}
+
+std::vector<GameObject*> const* Map::GetGameObjectEntryScanCandidates(uint32 entry, float x, float y, float radius) const
+{
+    return GetEntryScanCandidates(_gameobjectByEntryStore, entry, x, y, radius);
+}
+
 bool Map::IsGridLoaded(const GridCoord &p) const
 {
     return (getNGrid(p.x_coord, p.y_coord) && isGridObjectDataLoaded(p.x_coord, p.y_coord));
 }
 
-void Map::VisitNearbyCellsOf(WorldObject* obj, TypeContainerVisitor<Trinity::ObjectUpdater, GridTypeMapContainer> &gridVisitor, TypeContainerVisitor<Trinity::ObjectUpdater, WorldTypeMapContainer> &worldVisitor)
+uint32 Map::AddUpdateAnchor(WorldObject* obj, uint32 linkedAnchor /*= NO_LINKED_ANCHOR*/)
 {
     // Check for valid position
     if (!obj->IsPositionValid())
-        return;
+        return linkedAnchor;
 
     // Update mobs/objects in ALL visible cells around object!
     CellArea area = Cell::CalculateCellArea(obj->GetPositionX(), obj->GetPositionY(), obj->GetGridActivationRange());
+    TrackActiveCellArea(obj->GetGUID(), area);
+
+    if (_regionCellLabels.empty())
+        return linkedAnchor;
+
+    _updateAnchors.push_back({ area, linkedAnchor });
+    return uint32(_updateAnchors.size() - 1);
+}
+
+void Map::TrackActiveCellArea(ObjectGuid const& guid, CellArea const& area)
+{
+    auto itr = _activeCellSources.find(guid);
+    if (itr == _activeCellSources.end())
+    {
+        _activeCellSources.emplace(guid, TrackedCellArea{ area, _activeCellGeneration });
+        AcquireActiveCells(area);
+        return;
+    }
+
+    // the same object can be reached several times per tick (combat target of many players)
+    itr->second.LastSeen = _activeCellGeneration;
+    if (itr->second.Area.low_bound == area.low_bound && itr->second.Area.high_bound == area.high_bound)
+        return;
+
+    // only objects crossing a cell boundary change the active set
+    ReleaseActiveCells(itr->second.Area);
+    AcquireActiveCells(area);
+    itr->second.Area = area;
+}
 
+void Map::AcquireActiveCells(CellArea const& area)
+{
     for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
     {
         for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
         {
-            // marked cells are those that have been visited
-            // don't visit the same cell twice
             uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
-            if (isCellMarked(cell_id))
+            if (_activeCellRefs[cell_id]++)
                 continue;
 
             markCell(cell_id);
-            CellCoord pair(x, y);
-            Cell cell(pair);
-            cell.SetNoCreate();
-            Visit(cell, gridVisitor);
-            Visit(cell, worldVisitor);
+            _activeCellsDirty = true;
         }
     }
 }
 
+void Map::ReleaseActiveCells(CellArea const& area)
+{
+    for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
+    {
+        for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
+        {
+            uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
+            auto itr = _activeCellRefs.find(cell_id);
+            ASSERT(itr != _activeCellRefs.end());
+            if (--itr->second)
+                continue;
+
+            _activeCellRefs.erase(itr);
+            marked_cells.reset(cell_id);
+            _activeCellsDirty = true;
+        }
+    }
+}
+
+void Map::RefreshActiveCells()
+{
+    // objects that stopped keeping cells active (left the map, logged out, left combat...) were not seen this tick
+    for (auto itr = _activeCellSources.begin(); itr != _activeCellSources.end();)
+    {
+        if (itr->second.LastSeen != _activeCellGeneration)
+        {
+            ReleaseActiveCells(itr->second.Area);
+            itr = _activeCellSources.erase(itr);
+        }
+        else
+            ++itr;
+    }
+
+    if (!_activeCellsDirty)
+        return;
+
+    _activeCells.clear();
+    _activeCells.reserve(_activeCellRefs.size());
+    for (auto const& cellRefs : _activeCellRefs)
+        _activeCells.push_back(cellRefs.first);
+
+    // row major order, neighbouring cells are visited one after another
+    std::sort(_activeCells.begin(), _activeCells.end());
+    _activeCellsDirty = false;
+}
+
+bool Map::CanUpdateRegionsConcurrently() const
+{
+    // instances are small enough to be handled by a single worker, continents are not
+    if (Instanceable() || !sWorld->getBoolConfig(CONFIG_MAP_UPDATE_PARALLEL_REGIONS))
+        return false;
+
+    MapUpdater* updater = sMapMgr->GetMapUpdater();
+    return updater->activated() && updater->thread_count() > 1;
+}
+
 void Map::Update(const uint32 t_diff)
 {
+    TC_PROFILE_MAP_SCOPE("Map::Update", this);
+
     _dynamicTree.update(t_diff);
     /// update worldsessions for existing players
-    for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
     {
-        Player* player = m_mapRefIter->GetSource();
-        if (player && player->IsInWorld())
+        TC_PROFILE_SCOPE("Map::UpdateSessions");
+        for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
         {
-            //player->Update(t_diff);
-            WorldSession* session = player->GetSession();
-            MapSessionFilter updater(session);
-            session->Update(t_diff, updater);
+            Player* player = m_mapRefIter->GetSource();
+            if (player && player->IsInWorld())
+            {
+                //player->Update(t_diff);
+                WorldSession* session = player->GetSession();
+                MapSessionFilter updater(session);
+                session->Update(t_diff, updater);
+            }
         }
     }
-    /// update active cells around players and active objects
-    resetMarkedCells();
+    /// collect active cells around players and active objects
+    ++_activeCellGeneration;
+    _updateAnchors.clear();
 
-    Trinity::ObjectUpdater updater(t_diff);
-    // for creature
-    TypeContainerVisitor<Trinity::ObjectUpdater, GridTypeMapContainer  > grid_object_update(updater);
-    // for pets
-    TypeContainerVisitor<Trinity::ObjectUpdater, WorldTypeMapContainer > world_object_update(updater);
-
-    // the player iterator is stored in the map object
-    // to make sure calls to Map::Remove don't invalidate it
-    for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
+    if (CanUpdateRegionsConcurrently())
     {
-        Player* player = m_mapRefIter->GetSource();
+        if (_regionCellLabels.empty())
+            _regionCellLabels.resize(TOTAL_NUMBER_OF_CELLS_PER_MAP * TOTAL_NUMBER_OF_CELLS_PER_MAP, 0);
+    }
+    else if (!_regionCellLabels.empty())
+        std::vector<uint32>().swap(_regionCellLabels);
 
-        if (!player || !player->IsInWorld())
-            continue;
+    {
+        TC_PROFILE_SCOPE("Map::UpdatePlayers");
+        // the player iterator is stored in the map object
+        // to make sure calls to Map::Remove don't invalidate it
+        for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
+        {
+            Player* player = m_mapRefIter->GetSource();
 
-        // update players at tick
-        player->Update(t_diff);
+            if (!player || !player->IsInWorld())
+                continue;
 
-        VisitNearbyCellsOf(player, grid_object_update, world_object_update);
+            // update players at tick
+            player->Update(t_diff);
 
-        // If player is using far sight or mind vision, visit that object too
-        if (WorldObject* viewPoint = player->GetViewpoint())
-            VisitNearbyCellsOf(viewPoint, grid_object_update, world_object_update);
+            uint32 playerAnchor = AddUpdateAnchor(player);
 
-        // Handle updates for creatures in combat with player and are more than 60 yards away
-        if (player->IsInCombat())
-        {
-            std::vector<Creature*> updateList;
-            HostileReference* ref = player->getHostileRefManager().getFirst();
+            // If player is using far sight or mind vision, visit that object too
+            if (WorldObject* viewPoint = player->GetViewpoint())
+                AddUpdateAnchor(viewPoint, playerAnchor);
 
-            while (ref)
+            // Handle updates for creatures in combat with player and are more than 60 yards away
+            if (player->IsInCombat())
             {
-                if (Unit* unit = ref->GetSource()->GetOwner())
-                    if (unit->ToCreature() && unit->GetMapId() == player->GetMapId() && !unit->IsWithinDistInMap(player, GetVisibilityRange(), false))
-                        updateList.push_back(unit->ToCreature());
+                HostileReference* ref = player->getHostileRefManager().getFirst();
 
-                ref = ref->next();
-            }
+                while (ref)
+                {
+                    if (Unit* unit = ref->GetSource()->GetOwner())
+                        if (unit->ToCreature() && unit->GetMapId() == player->GetMapId() && !unit->IsWithinDistInMap(player, GetVisibilityRange(), false))
+                            AddUpdateAnchor(unit, playerAnchor);
 
-            // Process deferred update list for player
-            for (Creature* c : updateList)
-                VisitNearbyCellsOf(c, grid_object_update, world_object_update);
+                    ref = ref->next();
+                }
+            }
         }
     }
 
-    // non-player active objects, increasing iterator in the loop in case of object removal
-    for (m_activeNonPlayersIter = m_activeNonPlayers.begin(); m_activeNonPlayersIter != m_activeNonPlayers.end();)
-    {
-        WorldObject* obj = *m_activeNonPlayersIter;
-        ++m_activeNonPlayersIter;
-
-        if (!obj || !obj->IsInWorld())
-            continue;
+    // non-player active objects
+    for (WorldObject* obj : m_activeNonPlayers)
+        if (obj && obj->IsInWorld())
+            AddUpdateAnchor(obj);
 
-        VisitNearbyCellsOf(obj, grid_object_update, world_object_update);
+    /// update active cells around players and active objects, each of them exactly once
+    {
+        TC_PROFILE_SCOPE("Map::UpdateActiveCells");
+        RefreshActiveCells();
+        UpdateActiveCells(t_diff);
     }
 
-    for (_transportsUpdateIter = _transports.begin(); _transportsUpdateIter != _transports.end();)
     {
-        WorldObject* obj = *_transportsUpdateIter;
-        ++_transportsUpdateIter;
+        TC_PROFILE_SCOPE("Map::UpdateTransports");
+        for (_transportsUpdateIter = _transports.begin(); _transportsUpdateIter != _transports.end();)
+        {
+            WorldObject* obj = *_transportsUpdateIter;
+            ++_transportsUpdateIter;
 
-        if (!obj->IsInWorld())
-            continue;
+            if (!obj->IsInWorld())
+                continue;
 
-        obj->Update(t_diff);
+            obj->Update(t_diff);
+        }
     }
 
-    SendObjectUpdates();
+    {
+        TC_PROFILE_SCOPE("Map::SendObjectUpdates");
+        SendObjectUpdates();
+    }
 
     ///- Process necessary scripts
     if (!m_scriptSchedule.empty())
     {
+        TC_PROFILE_SCOPE("Map::ScriptsProcess");
         i_scriptLock = true;
         ScriptsProcess();
         i_scriptLock = false;
@@ -856,16 +1037,230 @@ void Map::Update(const uint32 t_diff)
         _weatherUpdateTimer.Reset();
     }
 
-    MoveAllCreaturesInMoveList();
-    MoveAllGameObjectsInMoveList();
-    MoveAllAreaTriggersInMoveList();
+    {
+        TC_PROFILE_SCOPE("Map::MoveLists");
+        MoveAllCreaturesInMoveList();
+        MoveAllGameObjectsInMoveList();
+        MoveAllAreaTriggersInMoveList();
+    }
 
     if (!m_mapRefManager.isEmpty() || !m_activeNonPlayers.empty())
+    {
+        TC_PROFILE_SCOPE("Map::ProcessRelocationNotifies");
         ProcessRelocationNotifies(t_diff);
+    }
 
+    TC_PROFILE_SCOPE("ScriptMgr::OnMapUpdate");
     sScriptMgr->OnMapUpdate(this, t_diff);
 }
 
+void Map::UpdateActiveCells(uint32 diff)
+{
+    if (!_updateAnchors.empty())
+    {
+        std::vector<std::vector<uint32>> regions;
+        BuildUpdateRegions(regions);
+        if (regions.size() > 1)
+        {
+            UpdateRegionsConcurrently(std::move(regions), diff);
+            return;
+        }
+    }
+
+    Trinity::ObjectUpdater updater(diff);
+    // for creature
+    TypeContainerVisitor<Trinity::ObjectUpdater, GridTypeMapContainer  > grid_object_update(updater);
+    // for pets
+    TypeContainerVisitor<Trinity::ObjectUpdater, WorldTypeMapContainer > world_object_update(updater);
+
+    for (uint32 cell_id : _activeCells)
+    {
+        Cell cell(CellCoord(cell_id % TOTAL_NUMBER_OF_CELLS_PER_MAP, cell_id / TOTAL_NUMBER_OF_CELLS_PER_MAP));
+        cell.SetNoCreate();
+        Visit(cell, grid_object_update);
+        Visit(cell, world_object_update);
+    }
+}
+
+void Map::BuildUpdateRegions(std::vector<std::vector<uint32>>& regions)
+{
+    static uint32 const UNLABELED_CELL = std::numeric_limits<uint32>::max();
+
+    // Two anchors end up in different regions only when more than MAX_VISIBILITY_DISTANCE separates their cell areas,
+    // so nothing updated in one region can see, search or relocate into cells updated by another one.
+    // Each area is grown by half of that distance and overlapping (or touching) areas are merged with a flood fill.
+    int32 const halfGap = int32(std::ceil(MAX_VISIBILITY_DISTANCE / SIZE_OF_GRID_CELL / 2.0f));
+    int32 const maxCoord = TOTAL_NUMBER_OF_CELLS_PER_MAP - 1;
+
+    std::vector<uint32> touchedCells;
+    for (UpdateAnchor const& anchor : _updateAnchors)
+    {
+        int32 lowX = std::max<int32>(int32(anchor.Area.low_bound.x_coord) - halfGap, 0);
+        int32 lowY = std::max<int32>(int32(anchor.Area.low_bound.y_coord) - halfGap, 0);
+        int32 highX = std::min<int32>(int32(anchor.Area.high_bound.x_coord) + halfGap, maxCoord);
+        int32 highY = std::min<int32>(int32(anchor.Area.high_bound.y_coord) + halfGap, maxCoord);
+        for (int32 x = lowX; x <= highX; ++x)
+        {
+            for (int32 y = lowY; y <= highY; ++y)
+            {
+                uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
+                if (_regionCellLabels[cell_id])
+                    continue;
+
+                _regionCellLabels[cell_id] = UNLABELED_CELL;
+                touchedCells.push_back(cell_id);
+            }
+        }
+    }
+
+    // label 0 means "not part of any region", labels start at 1
+    uint32 labelCount = 0;
+    std::vector<uint32> pending;
+    for (uint32 seed : touchedCells)
+    {
+        if (_regionCellLabels[seed] != UNLABELED_CELL)
+            continue;
+
+        uint32 label = ++labelCount;
+        _regionCellLabels[seed] = label;
+        pending.push_back(seed);
+        while (!pending.empty())
+        {
+            uint32 cell_id = pending.back();
+            pending.pop_back();
+
+            int32 cellX = int32(cell_id % TOTAL_NUMBER_OF_CELLS_PER_MAP);
+            int32 cellY = int32(cell_id / TOTAL_NUMBER_OF_CELLS_PER_MAP);
+            for (int32 x = std::max(cellX - 1, 0); x <= std::min(cellX + 1, maxCoord); ++x)
+            {
+                for (int32 y = std::max(cellY - 1, 0); y <= std::min(cellY + 1, maxCoord); ++y)
+                {
+                    uint32 neighbour = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
+                    if (_regionCellLabels[neighbour] != UNLABELED_CELL)
+                        continue;
+
+                    _regionCellLabels[neighbour] = label;
+                    pending.push_back(neighbour);
+                }
+            }
+        }
+    }
+
+    // Far sight targets and distant combat targets interact with the player that owns them,
+    // so their regions are merged with the player's one regardless of the distance
+    std::vector<uint32> parents(labelCount + 1);
+    for (uint32 i = 0; i <= labelCount; ++i)
+        parents[i] = i;
+
+    auto findRoot = [&parents](uint32 label)
+    {
+        while (parents[label] != label)
+        {
+            parents[label] = parents[parents[label]];
+            label = parents[label];
+        }
+        return label;
+    };
+
+    auto anchorLabel = [this](UpdateAnchor const& anchor)
+    {
+        return _regionCellLabels[(anchor.Area.low_bound.y_coord * TOTAL_NUMBER_OF_CELLS_PER_MAP) + anchor.Area.low_bound.x_coord];
+    };
+
+    for (UpdateAnchor const& anchor : _updateAnchors)
+    {
+        if (anchor.LinkedAnchor == NO_LINKED_ANCHOR)
+            continue;
+
+        uint32 root = findRoot(anchorLabel(anchor));
+        uint32 linkedRoot = findRoot(anchorLabel(_updateAnchors[anchor.LinkedAnchor]));
+        if (root != linkedRoot)
+            parents[std::max(root, linkedRoot)] = std::min(root, linkedRoot);
+    }
+
+    std::vector<uint32> regionByRoot(labelCount + 1, std::numeric_limits<uint32>::max());
+    for (uint32 cell_id : _activeCells)
+    {
+        uint32 root = findRoot(_regionCellLabels[cell_id]);
+        if (regionByRoot[root] == std::numeric_limits<uint32>::max())
+        {
+            regionByRoot[root] = uint32(regions.size());
+            regions.emplace_back();
+        }
+
+        regions[regionByRoot[root]].push_back(cell_id);
+    }
+
+    for (uint32 cell_id : touchedCells)
+        _regionCellLabels[cell_id] = 0;
+
+    // hand out the most expensive regions first so small ones fill the gaps at the end of the tick
+    std::sort(regions.begin(), regions.end(), [](std::vector<uint32> const& left, std::vector<uint32> const& right)
+    {
+        return left.size() > right.size();
+    });
+}
+
+struct MapRegionUpdateBatch
+{
+    explicit MapRegionUpdateBatch(std::vector<std::vector<uint32>>&& regions) : Regions(std::move(regions)), NextRegion(0), FinishedRegions(0) { }
+
+    std::vector<std::vector<uint32>> Regions;
+    std::atomic<size_t> NextRegion;
+    std::atomic<size_t> FinishedRegions;
+    std::mutex Lock;
+    std::condition_variable Finished;
+};
+
+void Map::UpdateRegionsConcurrently(std::vector<std::vector<uint32>>&& regions, uint32 diff)
+{
+    std::shared_ptr<MapRegionUpdateBatch> batch = std::make_shared<MapRegionUpdateBatch>(std::move(regions));
+
+    // Helpers and the map thread itself pull regions until none are left, the map thread never
+    // blocks on a helper that has not started yet so this can't starve the shared worker pool
+    auto processRegions = [this, batch, diff]()
+    {
+        TC_PROFILE_MAP_SCOPE("Map::UpdateRegions", this);
+
+        Trinity::ObjectUpdater updater(diff);
+        TypeContainerVisitor<Trinity::ObjectUpdater, GridTypeMapContainer  > grid_object_update(updater);
+        TypeContainerVisitor<Trinity::ObjectUpdater, WorldTypeMapContainer > world_object_update(updater);
+
+        for (size_t region = batch->NextRegion++; region < batch->Regions.size(); region = batch->NextRegion++)
+        {
+            for (uint32 cell_id : batch->Regions[region])
+            {
+                Cell cell(CellCoord(cell_id % TOTAL_NUMBER_OF_CELLS_PER_MAP, cell_id / TOTAL_NUMBER_OF_CELLS_PER_MAP));
+                cell.SetNoCreate();
+                Visit(cell, grid_object_update);
+                Visit(cell, world_object_update);
+            }
+
+            if (++batch->FinishedRegions == batch->Regions.size())
+            {
+                std::lock_guard<std::mutex> lock(batch->Lock);
+                batch->Finished.notify_all();
+            }
+        }
+    };
+
+    _regionUpdateInProgress = true;
+
+    MapUpdater* mapUpdater = sMapMgr->GetMapUpdater();
+    size_t helpers = std::min(batch->Regions.size() - 1, mapUpdater->thread_count() - 1);
+    for (size_t i = 0; i < helpers; ++i)
+        mapUpdater->schedule_task(processRegions);
+
+    processRegions();
+
+    {
+        std::unique_lock<std::mutex> lock(batch->Lock);
+        batch->Finished.wait(lock, [&batch]() { return batch->FinishedRegions == batch->Regions.size(); });
+    }
+
+    _regionUpdateInProgress = false;
+}
+
 struct ResetNotifier
 {
     template<class T>inline void resetNotify(GridRefManager<T> &m)
@@ -980,6 +1375,8 @@ void Map::RemovePlayerFromMap(Player* player, bool remove)
 template<class T>
 void Map::RemoveFromMap(T *obj, bool remove)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+
     bool const inWorld = obj->IsInWorld() && obj->GetTypeId() >= TYPEID_UNIT && obj->GetTypeId() <= TYPEID_GAMEOBJECT;
     obj->RemoveFromWorld();
     if (obj->isActiveObject())
@@ -1215,6 +1612,8 @@ void Map::AreaTriggerRelocation(AreaTrigger* at, float x, float y, float z, floa
 
 void Map::AddCreatureToMoveList(Creature* c, float x, float y, float z, float ang)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+
     if (_creatureToMoveLock) //can this happen?
         return;
 
@@ -1225,6 +1624,8 @@ void Map::AddCreatureToMoveList(Creature* c, float x, float y, float z, float an
 
 void Map::RemoveCreatureFromMoveList(Creature* c)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+
     if (_creatureToMoveLock) //can this happen?
         return;
 
@@ -1234,6 +1635,8 @@ void Map::RemoveCreatureFromMoveList(Creature* c)
 
 void Map::AddGameObjectToMoveList(GameObject* go, float x, float y, float z, float ang)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+
     if (_gameObjectsToMoveLock) //can this happen?
         return;
 
@@ -1244,6 +1647,8 @@ void Map::AddGameObjectToMoveList(GameObject* go, float x, float y, float z, flo
 
 void Map::RemoveGameObjectFromMoveList(GameObject* go)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+
     if (_gameObjectsToMoveLock) //can this happen?
         return;
 
@@ -1253,6 +1658,8 @@ void Map::RemoveGameObjectFromMoveList(GameObject* go)
 
 void Map::AddDynamicObjectToMoveList(DynamicObject* dynObj, float x, float y, float z, float ang)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+
     if (_dynamicObjectsToMoveLock) //can this happen?
         return;
 
@@ -1263,6 +1670,8 @@ void Map::AddDynamicObjectToMoveList(DynamicObject* dynObj, float x, float y, fl
 
 void Map::RemoveDynamicObjectFromMoveList(DynamicObject* dynObj)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+
     if (_dynamicObjectsToMoveLock) //can this happen?
         return;
 
@@ -1272,6 +1681,8 @@ void Map::RemoveDynamicObjectFromMoveList(DynamicObject* dynObj)
 
 void Map::AddAreaTriggerToMoveList(AreaTrigger* at, float x, float y, float z, float ang)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+
     if (_areaTriggersToMoveLock) //can this happen?
         return;
 
@@ -1282,6 +1693,8 @@ void Map::AddAreaTriggerToMoveList(AreaTrigger* at, float x, float y, float z, f
 
 void Map::RemoveAreaTriggerFromMoveList(AreaTrigger* at)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+
     if (_areaTriggersToMoveLock) //can this happen?
         return;
 
@@ -2692,7 +3105,15 @@ bool Map::GetAreaInfo(PhaseShift const& phaseShift, float x, float y, float z, u
     int32 dgroupId;
 
     bool hasVmapAreaInfo = vmgr->getAreaInfo(terrainMapId, x, y, vmap_z, vflags, vadtId, vrootId, vgroupId);
-    bool hasDynamicAreaInfo = _dynamicTree.getAreaInfo(x, y, dynamic_z, phaseShift, dflags, dadtId, drootId, dgroupId);
+    bool hasDynamicAreaInfo;
+    {
+        boost::shared_lock<boost::shared_mutex> lock(*_dynamicTreeLock, boost::defer_lock);
+        if (_regionUpdateInProgress)
+            lock.lock();
+
+        hasDynamicAreaInfo = _dynamicTree.getAreaInfo(x, y, dynamic_z, phaseShift, dflags, dadtId, drootId, dgroupId);
+    }
+
     auto useVmap = [&]() { check_z = vmap_z; flags = vflags; adtId = vadtId; rootId = vrootId; groupId = vgroupId; };
     auto useDyn = [&]() { check_z = dynamic_z; flags = dflags; adtId = dadtId; rootId = drootId; groupId = dgroupId; };
 
@@ -2890,8 +3311,14 @@ float Map::GetWaterLevel(PhaseShift const& phaseShift, float x, float y) const
 
 bool Map::isInLineOfSight(PhaseShift const& phaseShift, float x1, float y1, float z1, float x2, float y2, float z2, VMAP::ModelIgnoreFlags ignoreFlags) const
 {
-    return VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(PhasingHandler::GetTerrainMapId(phaseShift, this, x1, y1), x1, y1, z1, x2, y2, z2, ignoreFlags)
-        && _dynamicTree.isInLineOfSight({ x1, y1, z1 }, { x2, y2, z2 }, phaseShift);
+    if (!VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(PhasingHandler::GetTerrainMapId(phaseShift, this, x1, y1), x1, y1, z1, x2, y2, z2, ignoreFlags))
+        return false;
+
+    boost::shared_lock<boost::shared_mutex> lock(*_dynamicTreeLock, boost::defer_lock);
+    if (_regionUpdateInProgress)
+        lock.lock();
+
+    return _dynamicTree.isInLineOfSight({ x1, y1, z1 }, { x2, y2, z2 }, phaseShift);
 }
 
 bool Map::getObjectHitPos(PhaseShift const& phaseShift, float x1, float y1, float z1, float x2, float y2, float z2, float& rx, float& ry, float& rz, float modifyDist)
@@ -2900,7 +3327,14 @@ bool Map::getObjectHitPos(PhaseShift const& phaseShift, float x1, float y1, floa
     G3D::Vector3 dstPos(x2, y2, z2);
 
     G3D::Vector3 resultPos;
-    bool result = _dynamicTree.getObjectHitPos(startPos, dstPos, resultPos, modifyDist, phaseShift);
+    bool result;
+    {
+        boost::shared_lock<boost::shared_mutex> lock(*_dynamicTreeLock, boost::defer_lock);
+        if (_regionUpdateInProgress)
+            lock.lock();
+
+        result = _dynamicTree.getObjectHitPos(startPos, dstPos, resultPos, modifyDist, phaseShift);
+    }
 
     rx = resultPos.x;
     ry = resultPos.y;
@@ -2910,7 +3344,49 @@ bool Map::getObjectHitPos(PhaseShift const& phaseShift, float x1, float y1, floa
 
 float Map::GetHeight(PhaseShift const& phaseShift, float x, float y, float z, bool vmap /*= true*/, float maxSearchDist /*= DEFAULT_HEIGHT_SEARCH*/) const
 {
-    return std::max<float>(GetStaticHeight(phaseShift, x, y, z, vmap, maxSearchDist), _dynamicTree.getHeight(x, y, z, maxSearchDist, phaseShift));
+    float staticHeight = GetStaticHeight(phaseShift, x, y, z, vmap, maxSearchDist);
+
+    boost::shared_lock<boost::shared_mutex> lock(*_dynamicTreeLock, boost::defer_lock);
+    if (_regionUpdateInProgress)
+        lock.lock();
+
+    return std::max<float>(staticHeight, _dynamicTree.getHeight(x, y, z, maxSearchDist, phaseShift));
+}
+
+void Map::Balance()
+{
+    std::unique_lock<boost::shared_mutex> lock(*_dynamicTreeLock, std::defer_lock);
+    if (_regionUpdateInProgress)
+        lock.lock();
+
+    _dynamicTree.balance();
+}
+
+void Map::RemoveGameObjectModel(const GameObjectModel& model)
+{
+    std::unique_lock<boost::shared_mutex> lock(*_dynamicTreeLock, std::defer_lock);
+    if (_regionUpdateInProgress)
+        lock.lock();
+
+    _dynamicTree.remove(model);
+}
+
+void Map::InsertGameObjectModel(const GameObjectModel& model)
+{
+    std::unique_lock<boost::shared_mutex> lock(*_dynamicTreeLock, std::defer_lock);
+    if (_regionUpdateInProgress)
+        lock.lock();
+
+    _dynamicTree.insert(model);
+}
+
+bool Map::ContainsGameObjectModel(const GameObjectModel& model) const
+{
+    boost::shared_lock<boost::shared_mutex> lock(*_dynamicTreeLock, boost::defer_lock);
+    if (_regionUpdateInProgress)
+        lock.lock();
+
+    return _dynamicTree.contains(model);
 }
 
 bool Map::IsInWater(PhaseShift const& phaseShift, float x, float y, float pZ, LiquidData* data) const
@@ -3100,6 +3576,8 @@ void Map::DelayedUpdate(const uint32 t_diff)
 
 void Map::AddObjectToRemoveList(WorldObject* obj)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+
     ASSERT(obj->GetMapId() == GetId() && obj->GetInstanceId() == GetInstanceId());
 
     obj->CleanupsBeforeDelete(false);                            // remove or simplify at least cross referenced links
@@ -3110,6 +3588,8 @@ void Map::AddObjectToRemoveList(WorldObject* obj)
 
 void Map::AddObjectToSwitchList(WorldObject* obj, bool on)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+
     ASSERT(obj->GetMapId() == GetId() && obj->GetInstanceId() == GetInstanceId());
     // i_objectsToSwitch is iterated only in Map::RemoveAllObjectsInRemoveList() and it uses
     // the contained objects only if GetTypeId() == TYPEID_UNIT , so we can return in all other cases
@@ -4023,6 +4503,8 @@ void Map::UpdateIteratorBack(Player* player)
 
 void Map::SaveCreatureRespawnTime(ObjectGuid::LowType dbGuid, time_t respawnTime)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+
     if (!respawnTime)
     {
         // Delete only
@@ -4042,6 +4524,8 @@ void Map::SaveCreatureRespawnTime(ObjectGuid::LowType dbGuid, time_t respawnTime
 
 void Map::RemoveCreatureRespawnTime(ObjectGuid::LowType dbGuid)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+
     _creatureRespawnTimes.erase(dbGuid);
 
     CharacterDatabasePreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_CREATURE_RESPAWN);
@@ -4053,6 +4537,8 @@ void Map::RemoveCreatureRespawnTime(ObjectGuid::LowType dbGuid)
 
 void Map::SaveGORespawnTime(ObjectGuid::LowType dbGuid, time_t respawnTime)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+
     if (!respawnTime)
     {
         // Delete only
@@ -4072,6 +4558,8 @@ void Map::SaveGORespawnTime(ObjectGuid::LowType dbGuid, time_t respawnTime)
 
 void Map::RemoveGORespawnTime(ObjectGuid::LowType dbGuid)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+
     _goRespawnTimes.erase(dbGuid);
 
     CharacterDatabasePreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_GO_RESPAWN);
@@ -30,11 +30,13 @@
 #include "ObjectGuid.h"
 
 #include <bitset>
+#include <limits>
 #include <list>
 #include <memory>
 #include <mutex>
 #include <set>
 #include <unordered_set>
+#include <vector>
 
 class Battleground;
 class BattlegroundMap;
@@ -67,7 +69,7 @@ enum Difficulty : uint8;
 enum WeatherState : uint32;
 enum class ItemContext : uint8;
 
-namespace Trinity { struct ObjectUpdater; }
+namespace boost { class shared_mutex; }
 namespace G3D { class Plane; }
 namespace VMAP { enum class ModelIgnoreFlags : uint32; }
 
@@ -289,7 +291,6 @@ class TC_GAME_API Map : public GridRefManager<NGridType>
         template<class T> bool AddToMap(T *);
         template<class T> void RemoveFromMap(T *, bool);
 
-        void VisitNearbyCellsOf(WorldObject* obj, TypeContainerVisitor<Trinity::ObjectUpdater, GridTypeMapContainer> &gridVisitor, TypeContainerVisitor<Trinity::ObjectUpdater, WorldTypeMapContainer> &worldVisitor);
         virtual void Update(const uint32);
 
         float GetVisibilityRange() const { return m_VisibleDistance; }
@@ -421,7 +422,6 @@ class TC_GAME_API Map : public GridRefManager<NGridType>
         void AddObjectToSwitchList(WorldObject* obj, bool on);
         virtual void DelayedUpdate(const uint32 diff);
 
-        void resetMarkedCells() { marked_cells.reset(); }
         bool isCellMarked(uint32 pCellId) { return marked_cells.test(pCellId); }
         void markCell(uint32 pCellId) { marked_cells.set(pCellId); }
 
@@ -429,8 +429,8 @@ class TC_GAME_API Map : public GridRefManager<NGridType>
         uint32 GetPlayersCountExceptGMs() const;
         bool ActiveObjectsNearGrid(NGridType const& ngrid) const;
 
-        void AddWorldObject(WorldObject* obj) { i_worldObjects.insert(obj); }
-        void RemoveWorldObject(WorldObject* obj) { i_worldObjects.erase(obj); }
+        void AddWorldObject(WorldObject* obj) { std::unique_lock<std::recursive_mutex> lock = LockSharedState(); i_worldObjects.insert(obj); }
+        void RemoveWorldObject(WorldObject* obj) { std::unique_lock<std::recursive_mutex> lock = LockSharedState(); i_worldObjects.erase(obj); }
 
         void SendToPlayers(WorldPacket const* data) const;
 
@@ -476,6 +476,20 @@ class TC_GAME_API Map : public GridRefManager<NGridType>
         typedef std::unordered_multimap<ObjectGuid::LowType, GameObject*> GameObjectBySpawnIdContainer;
         GameObjectBySpawnIdContainer& GetGameObjectBySpawnIdStore() { return _gameobjectBySpawnIdStore; }
 
+        // Creatures and gameobjects in world grouped by entry, entry based area searches scan the (usually
+        // very short) bucket of the requested entry instead of every object in the cells of the search area
+        typedef std::unordered_map<uint32 /*entry*/, std::vector<Creature*>> CreatureByEntryContainer;
+        typedef std::unordered_map<uint32 /*entry*/, std::vector<GameObject*>> GameObjectByEntryContainer;
+
+        void AddToEntryStore(Creature* creature);
+        void RemoveFromEntryStore(Creature* creature);
+        void AddToEntryStore(GameObject* go);
+        void RemoveFromEntryStore(GameObject* go);
+
+        // nullptr when visiting the cells around x, y is expected to be cheaper than scanning the bucket
+        std::vector<Creature*> const* GetCreatureEntryScanCandidates(uint32 entry, float x, float y, float radius) const;
+        std::vector<GameObject*> const* GetGameObjectEntryScanCandidates(uint32 entry, float x, float y, float radius) const;
+
         std::unordered_set<Corpse*> const* GetCorpsesInCell(uint32 cellId) const
         {
             auto itr = _corpsesByCell.find(cellId);
@@ -506,10 +520,10 @@ class TC_GAME_API Map : public GridRefManager<NGridType>
         float GetWaterOrGroundLevel(PhaseShift const& phaseShift, float x, float y, float z, float* ground = nullptr, bool swim = false) const;
         float GetHeight(PhaseShift const& phaseShift, float x, float y, float z, bool vmap = true, float maxSearchDist = DEFAULT_HEIGHT_SEARCH) const;
         bool isInLineOfSight(PhaseShift const& phaseShift, float x1, float y1, float z1, float x2, float y2, float z2, VMAP::ModelIgnoreFlags ignoreFlags) const;
-        void Balance() { _dynamicTree.balance(); }
-        void RemoveGameObjectModel(const GameObjectModel& model) { _dynamicTree.remove(model); }
-        void InsertGameObjectModel(const GameObjectModel& model) { _dynamicTree.insert(model); }
-        bool ContainsGameObjectModel(const GameObjectModel& model) const { return _dynamicTree.contains(model);}
+        void Balance();
+        void RemoveGameObjectModel(const GameObjectModel& model);
+        void InsertGameObjectModel(const GameObjectModel& model);
+        bool ContainsGameObjectModel(const GameObjectModel& model) const;
         bool getObjectHitPos(PhaseShift const& phaseShift, float x1, float y1, float z1, float x2, float y2, float z2, float& rx, float &ry, float& rz, float modifyDist);
 
         virtual ObjectGuid::LowType GetOwnerGuildId(uint32 /*team*/ = TEAM_OTHER) const { return UI64LIT(0); }
@@ -569,19 +583,32 @@ class TC_GAME_API Map : public GridRefManager<NGridType>
         inline ObjectGuid::LowType GenerateLowGuid()
         {
             static_assert(ObjectGuidTraits<high>::SequenceSource.HasFlag(ObjectGuidSequenceSource::Map), "Only map specific guid can be generated in Map context");
+            std::unique_lock<std::recursive_mutex> lock = LockSharedState();
             return GetGuidSequenceGenerator<high>().Generate();
         }
 
         void AddUpdateObject(Object* obj)
         {
+            std::unique_lock<std::recursive_mutex> lock = LockSharedState();
             _updateObjects.insert(obj);
         }
 
         void RemoveUpdateObject(Object* obj)
         {
+            std::unique_lock<std::recursive_mutex> lock = LockSharedState();
             _updateObjects.erase(obj);
         }
 
+        // Map wide containers can be modified from several threads while cell regions are updated concurrently,
+        // the returned lock is only engaged during that phase so the regular single threaded update stays lock free
+        std::unique_lock<std::recursive_mutex> LockSharedState()
+        {
+            if (_regionUpdateInProgress)
+                return std::unique_lock<std::recursive_mutex>(_sharedStateLock);
+
+            return std::unique_lock<std::recursive_mutex>();
+        }
+
     private:
         void LoadMapAndVMap(int gx, int gy);
         void LoadVMap(int gx, int gy);
@@ -595,6 +622,13 @@ class TC_GAME_API Map : public GridRefManager<NGridType>
 
         void SetTimer(uint32 t) { i_gridExpiry = t < MIN_GRID_DELAY ? MIN_GRID_DELAY : t; }
 
+        template<class T>
+        void AddToEntryStore(std::unordered_map<uint32, std::vector<T*>>& store, T* obj);
+        template<class T>
+        void RemoveFromEntryStore(std::unordered_map<uint32, std::vector<T*>>& store, T* obj);
+        template<class T>
+        std::vector<T*> const* GetEntryScanCandidates(std::unordered_map<uint32, std::vector<T*>> const& store, uint32 entry, float x, float y, float radius) const;
+
         void SendInitSelf(Player* player);
 
         bool CreatureCellRelocation(Creature* creature, Cell new_cell);
@@ -646,6 +680,47 @@ class TC_GAME_API Map : public GridRefManager<NGridType>
 
         void SendObjectUpdates();
 
+        // Every player, viewpoint, far away combat target and active object keeps the cells around it updated.
+        // Anchors are only recorded when the map is allowed to split its cell update into independent regions.
+        struct UpdateAnchor
+        {
+            CellArea Area;
+            uint32 LinkedAnchor;
+        };
+
+        static uint32 const NO_LINKED_ANCHOR = std::numeric_limits<uint32>::max();
+
+        uint32 AddUpdateAnchor(WorldObject* obj, uint32 linkedAnchor = NO_LINKED_ANCHOR);
+        bool CanUpdateRegionsConcurrently() const;
+        void UpdateActiveCells(uint32 diff);
+        void BuildUpdateRegions(std::vector<std::vector<uint32>>& regions);
+        void UpdateRegionsConcurrently(std::vector<std::vector<uint32>>&& regions, uint32 diff);
+
+        // Active cells are reference counted by the objects keeping them active and only change
+        // when one of those objects crosses a cell boundary, _activeCells is kept sorted by cell id
+        struct TrackedCellArea
+        {
+            CellArea Area;
+            uint32 LastSeen;
+        };
+
+        void TrackActiveCellArea(ObjectGuid const& guid, CellArea const& area);
+        void AcquireActiveCells(CellArea const& area);
+        void ReleaseActiveCells(CellArea const& area);
+        void RefreshActiveCells();
+
+        bool _regionUpdateInProgress;
+        std::recursive_mutex _sharedStateLock;
+        // gameobject models move while other regions run line of sight and height queries, only taken during the region update
+        std::unique_ptr<boost::shared_mutex> _dynamicTreeLock;
+        uint32 _activeCellGeneration;
+        bool _activeCellsDirty;
+        std::unordered_map<ObjectGuid, TrackedCellArea> _activeCellSources;
+        std::unordered_map<uint32 /*cellId*/, uint32 /*refCount*/> _activeCellRefs;
+        std::vector<uint32> _activeCells;
+        std::vector<UpdateAnchor> _updateAnchors;
+        std::vector<uint32> _regionCellLabels;
+
     protected:
         virtual void LoadGridObjects(NGridType* grid, Cell const& cell);
 
@@ -717,11 +792,13 @@ class TC_GAME_API Map : public GridRefManager<NGridType>
 
         void AddToActiveHelper(WorldObject* obj)
         {
+            std::unique_lock<std::recursive_mutex> lock = LockSharedState();
             m_activeNonPlayers.insert(obj);
         }
 
         void RemoveFromActiveHelper(WorldObject* obj)
         {
+            std::unique_lock<std::recursive_mutex> lock = LockSharedState();
             // Map::Update for active object in proccess
             if (m_activeNonPlayersIter != m_activeNonPlayers.end())
             {
@@ -757,6 +834,8 @@ class TC_GAME_API Map : public GridRefManager<NGridType>
         MapStoredObjectTypesContainer _objectsStore;
         CreatureBySpawnIdContainer _creatureBySpawnIdStore;
         GameObjectBySpawnIdContainer _gameobjectBySpawnIdStore;
+        CreatureByEntryContainer _creatureByEntryStore;
+        GameObjectByEntryContainer _gameobjectByEntryStore;
         std::unordered_map<uint32/*cellId*/, std::unordered_set<Corpse*>> _corpsesByCell;
         std::unordered_map<ObjectGuid, Corpse*> _corpsesByPlayer;
         std::unordered_set<Corpse*> _corpseBones;
@@ -35,6 +35,8 @@
 /// Put scripts in the execution queue
 void Map::ScriptsStart(ScriptMapMap const& scripts, uint32 id, Object* source, Object* target)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+
     ///- Find the script map
     ScriptMapMap::const_iterator s = scripts.find(id);
     if (s == scripts.end())
@@ -73,6 +75,8 @@ void Map::ScriptsStart(ScriptMapMap const& scripts, uint32 id, Object* source, O
 
 void Map::ScriptCommandStart(ScriptInfo const& script, uint32 delay, Object* source, Object* target)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+
     // NOTE: script record _must_ exist until command executed
 
     // prepare static data
@@ -22,24 +22,61 @@
 
 
 class MapUpdateRequest
+{
+    protected:
+
+        MapUpdater& m_updater;
+
+    public:
+
+        explicit MapUpdateRequest(MapUpdater& u) : m_updater(u) { }
+        virtual ~MapUpdateRequest() { }
+
+        virtual void call() = 0;
+
+    protected:
+
+        void finished() { m_updater.update_finished(); }
+};
+
+class MapUpdateMapRequest : public MapUpdateRequest
 {
     private:
 
         Map& m_map;
-        MapUpdater& m_updater;
         uint32 m_diff;
 
     public:
 
-        MapUpdateRequest(Map& m, MapUpdater& u, uint32 d)
-            : m_map(m), m_updater(u), m_diff(d)
+        MapUpdateMapRequest(Map& m, MapUpdater& u, uint32 d)
+            : MapUpdateRequest(u), m_map(m), m_diff(d)
         {
         }
 
-        void call()
+        void call() override
         {
             m_map.Update (m_diff);
-            m_updater.update_finished();
+            finished();
+        }
+};
+
+class MapUpdateTaskRequest : public MapUpdateRequest
+{
+    private:
+
+        std::function<void()> m_task;
+
+    public:
+
+        MapUpdateTaskRequest(std::function<void()>&& task, MapUpdater& u)
+            : MapUpdateRequest(u), m_task(std::move(task))
+        {
+        }
+
+        void call() override
+        {
+            m_task();
+            finished();
         }
 };
 
@@ -81,7 +118,16 @@ void MapUpdater::schedule_update(Map& map, uint32 diff)
 
     ++pending_requests;
 
-    _queue.Push(new MapUpdateRequest(map, *this, diff));
+    _queue.Push(new MapUpdateMapRequest(map, *this, diff));
+}
+
+void MapUpdater::schedule_task(std::function<void()>&& task)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    ++pending_requests;
+
+    _queue.Push(new MapUpdateTaskRequest(std::move(task), *this));
 }
 
 bool MapUpdater::activated()
@@ -22,6 +22,7 @@
 #include <mutex>
 #include <thread>
 #include <condition_variable>
+#include <functional>
 #include "ProducerConsumerQueue.h"
 
 class MapUpdateRequest;
@@ -38,6 +39,9 @@ class TC_GAME_API MapUpdater
 
         void schedule_update(Map& map, uint32 diff);
 
+        // runs an arbitrary job on the worker pool, used by maps to split their own update into independent parts
+        void schedule_task(std::function<void()>&& task);
+
         void wait();
 
         void activate(size_t num_threads);
@@ -46,6 +50,8 @@ class TC_GAME_API MapUpdater
 
         bool activated();
 
+        size_t thread_count() const { return _workerThreads.size(); }
+
     private:
 
         ProducerConsumerQueue<MapUpdateRequest*> _queue;
@@ -0,0 +1,232 @@
+/*
+ * This file is part of the TrinityCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OpcodeStats.h"
+#include "Metric.h"
+#include "Opcodes.h"
+
+struct OpcodeStats::Counters
+{
+    std::atomic<uint64> Count;
+    std::atomic<uint64> Bytes;
+    std::atomic<uint64> TotalTime;
+    std::atomic<uint64> MaxTime;
+    std::array<std::atomic<uint64>, OPCODE_STATS_HISTOGRAM_BUCKETS> Histogram;
+
+    Counters() : Count(0), Bytes(0), TotalTime(0), MaxTime(0)
+    {
+        for (std::atomic<uint64>& bucket : Histogram)
+            bucket.store(0, std::memory_order_relaxed);
+    }
+
+    // only the owning thread writes, so a plain load and store is enough and avoids locked instructions
+    static void Add(std::atomic<uint64>& counter, uint64 value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+};
+
+struct OpcodeStats::ThreadCounters
+{
+    // allocated on first use of an opcode by the owning thread, read by anyone
+    std::array<std::atomic<Counters*>, NUM_OPCODE_HANDLERS> Handled;
+    std::array<std::atomic<Counters*>, NUM_OPCODE_HANDLERS> Sent;
+
+    ThreadCounters()
+    {
+        for (std::atomic<Counters*>& counters : Handled)
+            counters.store(nullptr, std::memory_order_relaxed);
+        for (std::atomic<Counters*>& counters : Sent)
+            counters.store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~ThreadCounters()
+    {
+        for (std::atomic<Counters*>& counters : Handled)
+            delete counters.load(std::memory_order_relaxed);
+        for (std::atomic<Counters*>& counters : Sent)
+            delete counters.load(std::memory_order_relaxed);
+    }
+
+    static Counters& Get(std::array<std::atomic<Counters*>, NUM_OPCODE_HANDLERS>& table, uint32 opcode)
+    {
+        Counters* counters = table[opcode].load(std::memory_order_relaxed);
+        if (!counters)
+        {
+            counters = new Counters();
+            table[opcode].store(counters, std::memory_order_release);
+        }
+
+        return *counters;
+    }
+};
+
+uint64 OpcodeStatsEntry::GetPercentileTime(uint32 percentile) const
+{
+    if (!Count)
+        return 0;
+
+    uint64 threshold = (Count * percentile + 99) / 100;
+    uint64 seen = 0;
+    for (uint32 i = 0; i < OPCODE_STATS_HISTOGRAM_BUCKETS; ++i)
+    {
+        seen += Histogram[i];
+        if (seen >= threshold)
+            return i + 1 < OPCODE_STATS_HISTOGRAM_BUCKETS ? std::min(uint64(1) << i, MaxTime) : MaxTime;
+    }
+
+    return MaxTime;
+}
+
+OpcodeStats::OpcodeStats() = default;
+OpcodeStats::~OpcodeStats() = default;
+
+OpcodeStats* OpcodeStats::instance()
+{
+    static OpcodeStats instance;
+    return &instance;
+}
+
+OpcodeStats::ThreadCounters& OpcodeStats::GetThreadCounters()
+{
+    // owned by _threads so the counters of finished threads stay visible
+    thread_local ThreadCounters* threadCounters = nullptr;
+    if (!threadCounters)
+    {
+        std::lock_guard<std::mutex> lock(_threadsLock);
+        _threads.push_back(std::make_unique<ThreadCounters>());
+        threadCounters = _threads.back().get();
+    }
+
+    return *threadCounters;
+}
+
+void OpcodeStats::RecordHandled(uint32 opcode, std::size_t size, std::chrono::steady_clock::duration elapsed)
+{
+    if (opcode >= NUM_OPCODE_HANDLERS)
+        return;
+
+    uint64 time = uint64(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    uint32 bucket = 0;
+    while (bucket + 1 < OPCODE_STATS_HISTOGRAM_BUCKETS && time >= (uint64(1) << bucket))
+        ++bucket;
+
+    Counters& counters = ThreadCounters::Get(GetThreadCounters().Handled, opcode);
+    Counters::Add(counters.Count, 1);
+    Counters::Add(counters.Bytes, size);
+    Counters::Add(counters.TotalTime, time);
+    Counters::Add(counters.Histogram[bucket], 1);
+    if (time > counters.MaxTime.load(std::memory_order_relaxed))
+        counters.MaxTime.store(time, std::memory_order_relaxed);
+}
+
+void OpcodeStats::RecordSent(uint32 opcode, std::size_t size)
+{
+    if (opcode >= NUM_OPCODE_HANDLERS)
+        return;
+
+    Counters& counters = ThreadCounters::Get(GetThreadCounters().Sent, opcode);
+    Counters::Add(counters.Count, 1);
+    Counters::Add(counters.Bytes, size);
+}
+
+std::vector<OpcodeStatsEntry> OpcodeStats::Collect(bool handled) const
+{
+    std::unordered_map<uint32, OpcodeStatsEntry> totals;
+
+    {
+        std::lock_guard<std::mutex> lock(_threadsLock);
+        for (std::unique_ptr<ThreadCounters> const& threadCounters : _threads)
+        {
+            std::array<std::atomic<Counters*>, NUM_OPCODE_HANDLERS> const& table = handled ? threadCounters->Handled : threadCounters->Sent;
+            for (uint32 opcode = 0; opcode < NUM_OPCODE_HANDLERS; ++opcode)
+            {
+                Counters const* counters = table[opcode].load(std::memory_order_acquire);
+                if (!counters)
+                    continue;
+
+                OpcodeStatsEntry& entry = totals[opcode];
+                entry.Opcode = opcode;
+                entry.Count += counters->Count.load(std::memory_order_relaxed);
+                entry.Bytes += counters->Bytes.load(std::memory_order_relaxed);
+                entry.TotalTime += counters->TotalTime.load(std::memory_order_relaxed);
+                entry.MaxTime = std::max(entry.MaxTime, counters->MaxTime.load(std::memory_order_relaxed));
+                for (uint32 i = 0; i < OPCODE_STATS_HISTOGRAM_BUCKETS; ++i)
+                    entry.Histogram[i] += counters->Histogram[i].load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::vector<OpcodeStatsEntry> result;
+    result.reserve(totals.size());
+    for (auto const& pair : totals)
+        result.push_back(pair.second);
+
+    return result;
+}
+
+std::vector<OpcodeStatsEntry> OpcodeStats::GetHandledStats() const
+{
+    return Collect(true);
+}
+
+std::vector<OpcodeStatsEntry> OpcodeStats::GetSentStats() const
+{
+    return Collect(false);
+}
+
+void OpcodeStats::LogMetrics()
+{
+    if (!sMetric->IsEnabled())
+        return;
+
+    for (OpcodeStatsEntry const& entry : GetHandledStats())
+    {
+        OpcodeStatsEntry& last = _lastLoggedHandled[entry.Opcode];
+        if (entry.Count == last.Count)
+            continue;
+
+        OpcodeStatsEntry delta = entry;
+        delta.Count -= last.Count;
+        delta.Bytes -= last.Bytes;
+        delta.TotalTime -= last.TotalTime;
+        for (uint32 i = 0; i < OPCODE_STATS_HISTOGRAM_BUCKETS; ++i)
+            delta.Histogram[i] -= last.Histogram[i];
+        last = entry;
+
+        std::string name = opcodeTable[static_cast<OpcodeClient>(entry.Opcode)] ? opcodeTable[static_cast<OpcodeClient>(entry.Opcode)]->Name : std::to_string(entry.Opcode);
+        TC_METRIC_VALUE("opcode_handled", delta.Count, TC_METRIC_TAG("opcode", name));
+        TC_METRIC_VALUE("opcode_bytes_in", delta.Bytes, TC_METRIC_TAG("opcode", name));
+        TC_METRIC_VALUE("opcode_handle_time", delta.TotalTime, TC_METRIC_TAG("opcode", name));
+        TC_METRIC_VALUE("opcode_handle_time_p95", delta.GetPercentileTime(95), TC_METRIC_TAG("opcode", name));
+    }
+
+    for (OpcodeStatsEntry const& entry : GetSentStats())
+    {
+        OpcodeStatsEntry& last = _lastLoggedSent[entry.Opcode];
+        if (entry.Count == last.Count)
+            continue;
+
+        uint64 count = entry.Count - last.Count;
+        uint64 bytes = entry.Bytes - last.Bytes;
+        last = entry;
+
+        std::string name = opcodeTable[static_cast<OpcodeServer>(entry.Opcode)] ? opcodeTable[static_cast<OpcodeServer>(entry.Opcode)]->Name : std::to_string(entry.Opcode);
+        TC_METRIC_VALUE("opcode_sent", count, TC_METRIC_TAG("opcode", name));
+        TC_METRIC_VALUE("opcode_bytes_out", bytes, TC_METRIC_TAG("opcode", name));
+    }
+}
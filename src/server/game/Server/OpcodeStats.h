@@ -0,0 +1,82 @@
+/*
+ * This file is part of the TrinityCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OpcodeStats_h__
+#define OpcodeStats_h__
+
+#include "Define.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// handling time histogram, bucket 0 holds times below 1us, bucket i times in [2^(i-1), 2^i) us, the last one everything above
+#define OPCODE_STATS_HISTOGRAM_BUCKETS 24
+
+struct OpcodeStatsEntry
+{
+    uint32 Opcode = 0;
+    uint64 Count = 0;
+    uint64 Bytes = 0;
+    uint64 TotalTime = 0;                                   // microseconds
+    uint64 MaxTime = 0;                                     // microseconds
+    std::array<uint64, OPCODE_STATS_HISTOGRAM_BUCKETS> Histogram = { };
+
+    /// Upper bound (in microseconds) of the histogram bucket containing the given percentile (0-100)
+    uint64 GetPercentileTime(uint32 percentile) const;
+    uint64 GetAverageTime() const { return Count ? TotalTime / Count : 0; }
+};
+
+/// Per opcode counters for handled client packets (count, handling time, bytes) and sent server packets (count, bytes)
+/// Every thread records into its own counters without locking, readers sum them up
+class TC_GAME_API OpcodeStats
+{
+    struct Counters;
+    struct ThreadCounters;
+
+public:
+    static OpcodeStats* instance();
+
+    void RecordHandled(uint32 opcode, std::size_t size, std::chrono::steady_clock::duration elapsed);
+    void RecordSent(uint32 opcode, std::size_t size);
+
+    std::vector<OpcodeStatsEntry> GetHandledStats() const;
+    std::vector<OpcodeStatsEntry> GetSentStats() const;
+
+    /// Sends everything recorded since the previous call through Metric, must only be called from a single thread
+    void LogMetrics();
+
+private:
+    OpcodeStats();
+    ~OpcodeStats();
+
+    ThreadCounters& GetThreadCounters();
+    std::vector<OpcodeStatsEntry> Collect(bool handled) const;
+
+    mutable std::mutex _threadsLock;
+    std::vector<std::unique_ptr<ThreadCounters>> _threads;
+
+    std::unordered_map<uint32, OpcodeStatsEntry> _lastLoggedHandled;
+    std::unordered_map<uint32, OpcodeStatsEntry> _lastLoggedSent;
+};
+
+#define sOpcodeStats OpcodeStats::instance()
+
+#endif // OpcodeStats_h__
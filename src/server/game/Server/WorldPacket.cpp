@@ -0,0 +1,31 @@
+/*
+ * This file is part of the TrinityCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WorldPacket.h"
+#include "World.h"
+#include "WorldSocket.h"
+
+bool WorldPacket::CanShareCompression() const
+{
+    uint32 minSize = sWorld->getIntConfig(CONFIG_COMPRESSION_SHARED_MIN_SIZE);
+    return minSize && size() > std::max(minSize, WorldSocket::MinSizeForCompression);
+}
+
+std::shared_ptr<SharedPacketCompression> WorldPacket::ShareCompression() const
+{
+    return std::make_shared<SharedPacketCompression>(*this);
+}
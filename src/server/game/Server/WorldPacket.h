@@ -20,7 +20,11 @@
 
 #include "ByteBuffer.h"
 #include "Opcodes.h"
+#include <atomic>
 #include <chrono>
+#include <memory>
+
+class SharedPacketCompression;
 
 class WorldPacket : public ByteBuffer
 {
@@ -46,11 +50,13 @@ class WorldPacket : public ByteBuffer
         WorldPacket(uint32 opcode, size_t res, ConnectionType connection = CONNECTION_TYPE_DEFAULT) : WorldPacket(opcode, res, Reserve{}, connection) { }
 
         WorldPacket(WorldPacket&& packet) noexcept : ByteBuffer(std::move(packet)), m_opcode(packet.m_opcode), _connection(packet._connection)
-
         {
         }
 
-        WorldPacket(WorldPacket const& right) = default;
+        WorldPacket(WorldPacket const& right) : ByteBuffer(right), m_opcode(right.m_opcode), _connection(right._connection),
+            m_receivedTime(right.m_receivedTime)
+        {
+        }
 
         WorldPacket& operator=(WorldPacket const& right)
         {
@@ -93,6 +99,14 @@ class WorldPacket : public ByteBuffer
 
         std::chrono::steady_clock::time_point GetReceivedTime() const { return m_receivedTime; }
 
+        // large packets sent to many sockets can have their payload compressed once for all receivers,
+        // the returned handle holds its own copy of opcode and payload and is passed along with the packet to WorldSession::SendPacket
+        bool CanShareCompression() const;
+        std::shared_ptr<SharedPacketCompression> ShareCompression() const;
+
+        // link used by WorldSession's lock free receive queue, not copied with the packet
+        std::atomic<WorldPacket*> QueueLink;
+
     protected:
         uint32 m_opcode;
         ConnectionType _connection;
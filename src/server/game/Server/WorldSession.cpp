@@ -40,6 +40,7 @@
 #include "Metric.h"
 #include "MiscPackets.h"
 #include "ObjectMgr.h"
+#include "OpcodeStats.h"
 #include "OutdoorPvPMgr.h"
 #include "PacketUtilities.h"
 #include "Player.h"
@@ -132,6 +133,7 @@ WorldSession::WorldSession(uint32 id, std::string&& name, uint32 battlenetAccoun
     _filterAddonMessages(false),
     recruiterId(recruiter),
     isRecruiter(isARecruiter),
+    _recvDeferred(nullptr),
     _RBACData(NULL),
     expireTime(60000), // 1 min after socket loss, session is deleted
     forceExit(false),
@@ -175,8 +177,14 @@ WorldSession::~WorldSession()
     delete _RBACData;
 
     ///- empty incoming packet queue
+    while (WorldPacket* packet = _recvDeferred)
+    {
+        _recvDeferred = packet->QueueLink.load(std::memory_order_relaxed);
+        delete packet;
+    }
+
     WorldPacket* packet = NULL;
-    while (_recvQueue.next(packet))
+    while (_recvQueue.Dequeue(packet))
         delete packet;
 
     LoginDatabase.PExecute("UPDATE account SET online = 0 WHERE id = %u;", GetAccountId());     // One-time query
@@ -209,7 +217,7 @@ std::string WorldSession::GetPlayerInfo() const
 }
 
 /// Send a packet to the client
-void WorldSession::SendPacket(WorldPacket const* packet, bool forced /*= false*/)
+void WorldSession::SendPacket(WorldPacket const* packet, bool forced /*= false*/, std::shared_ptr<SharedPacketCompression> const& sharedCompression /*= nullptr*/)
 {
     if (packet->GetOpcode() == NULL_OPCODE)
     {
@@ -297,13 +305,50 @@ void WorldSession::SendPacket(WorldPacket const* packet, bool forced /*= false*/
     sScriptMgr->OnPacketSend(this, *packet);
 
     TC_LOG_TRACE("network.opcode", "S->C: %s %s", GetPlayerInfo().c_str(), GetOpcodeNameForLogging(static_cast<OpcodeServer>(packet->GetOpcode())).c_str());
-    m_Socket[conIdx]->SendPacket(*packet);
+
+    if (sWorld->getBoolConfig(CONFIG_OPCODE_STATS))
+        sOpcodeStats->RecordSent(packet->GetOpcode(), packet->size());
+
+    m_Socket[conIdx]->SendPacket(*packet, sharedCompression);
 }
 
 /// Add an incoming packet to the queue
 void WorldSession::QueuePacket(WorldPacket* new_packet)
 {
-    _recvQueue.add(new_packet);
+    _recvQueue.Enqueue(new_packet);
+}
+
+/// Take the next packet from the receive queue if the filter allows processing it now
+bool WorldSession::NextReceivedPacket(WorldPacket*& packet, PacketFilter& updater)
+{
+    if (_recvDeferred)
+    {
+        packet = _recvDeferred;
+        if (!updater.Process(packet))
+            return false;
+
+        _recvDeferred = packet->QueueLink.load(std::memory_order_relaxed);
+        return true;
+    }
+
+    if (!_recvQueue.Dequeue(packet))
+        return false;
+
+    if (!updater.Process(packet))
+    {
+        // keep it in front of everything still queued until an update with a matching filter takes it
+        DeferReceivedPackets(packet, packet);
+        return false;
+    }
+
+    return true;
+}
+
+/// Put an already linked chain of packets back in front of the receive queue
+void WorldSession::DeferReceivedPackets(WorldPacket* first, WorldPacket* last)
+{
+    last->QueueLink.store(_recvDeferred, std::memory_order_relaxed);
+    _recvDeferred = first;
 }
 
 /// Logging helper for unexpected opcodes
@@ -327,6 +372,9 @@ void WorldSession::LogUnprocessedTail(WorldPacket const* packet)
 /// Update the WorldSession (triggered by World update)
 bool WorldSession::Update(uint32 diff, PacketFilter& updater)
 {
+    // queries of this account must see the saves it queued before
+    DatabaseOrderScope orderScope(GetAccountId());
+
     /// Update Timeout timer.
     UpdateTimeOutTime(diff);
 
@@ -340,13 +388,19 @@ bool WorldSession::Update(uint32 diff, PacketFilter& updater)
     WorldPacket* packet = NULL;
     //! Delete packet after processing by default
     bool deletePacket = true;
-    std::vector<WorldPacket*> requeuePackets;
+    WorldPacket* requeueFirst = nullptr;
+    WorldPacket* requeueLast = nullptr;
     uint32 processedPackets = 0;
     time_t currentTime = time(NULL);
+    bool const recordOpcodeStats = sWorld->getBoolConfig(CONFIG_OPCODE_STATS);
 
-    while (m_Socket[CONNECTION_TYPE_REALM] && _recvQueue.next(packet, updater))
+    while (m_Socket[CONNECTION_TYPE_REALM] && NextReceivedPacket(packet, updater))
     {
         ClientOpcodeHandler const* opHandle = opcodeTable[static_cast<OpcodeClient>(packet->GetOpcode())];
+        std::chrono::steady_clock::time_point handleStart;
+        if (recordOpcodeStats)
+            handleStart = std::chrono::steady_clock::now();
+
         try
         {
             switch (opHandle->Status)
@@ -359,7 +413,11 @@ bool WorldSession::Update(uint32 diff, PacketFilter& updater)
                         //! the client to be in world yet. We will re-add the packets to the bottom of the queue and process them later.
                         if (!m_playerRecentlyLogout)
                         {
-                            requeuePackets.push_back(packet);
+                            if (requeueLast)
+                                requeueLast->QueueLink.store(packet, std::memory_order_relaxed);
+                            else
+                                requeueFirst = packet;
+                            requeueLast = packet;
                             deletePacket = false;
                             TC_LOG_DEBUG("network", "Re-enqueueing packet with opcode %s with with status STATUS_LOGGEDIN. "
                                 "Player is currently not in world yet.", GetOpcodeNameForLogging(static_cast<OpcodeClient>(packet->GetOpcode())).c_str());
@@ -435,6 +493,10 @@ bool WorldSession::Update(uint32 diff, PacketFilter& updater)
             packet->hexlike();
         }
 
+        // re-enqueued packets are recorded once they are actually handled
+        if (recordOpcodeStats && deletePacket)
+            sOpcodeStats->RecordHandled(packet->GetOpcode(), packet->size(), std::chrono::steady_clock::now() - handleStart);
+
         if (deletePacket)
             delete packet;
 
@@ -451,7 +513,8 @@ bool WorldSession::Update(uint32 diff, PacketFilter& updater)
 
     TC_METRIC_VALUE("processed_packets", processedPackets);
 
-    _recvQueue.readd(requeuePackets.begin(), requeuePackets.end());
+    if (requeueFirst)
+        DeferReceivedPackets(requeueFirst, requeueLast);
 
     if (m_Socket[CONNECTION_TYPE_REALM] && m_Socket[CONNECTION_TYPE_REALM]->IsOpen() && _warden)
         _warden->Update();
@@ -500,6 +563,8 @@ bool WorldSession::Update(uint32 diff, PacketFilter& updater)
 /// %Log the player out
 void WorldSession::LogoutPlayer(bool save)
 {
+    DatabaseOrderScope orderScope(GetAccountId());
+
     // finish pending transfers before starting the logout
     while (_player && _player->IsBeingTeleportedFar())
         HandleMoveWorldportAck();
@@ -26,7 +26,7 @@
 #include "AsyncCallbackProcessor.h"
 #include "DatabaseEnvFwd.h"
 #include "Duration.h"
-#include "LockedQueue.h"
+#include "MPSCQueue.h"
 #include "ObjectGuid.h"
 #include "Packet.h"
 #include "SharedDefines.h"
@@ -45,6 +45,7 @@ class InstanceSave;
 class Item;
 class LoginQueryHolder;
 class Player;
+class SharedPacketCompression;
 class Unit;
 class Warden;
 class WorldSession;
@@ -981,7 +982,7 @@ class TC_GAME_API WorldSession
 
         bool IsAddonRegistered(const std::string& prefix) const;
 
-        void SendPacket(WorldPacket const* packet, bool forced = false);
+        void SendPacket(WorldPacket const* packet, bool forced = false, std::shared_ptr<SharedPacketCompression> const& sharedCompression = nullptr);
         void AddInstanceConnection(std::shared_ptr<WorldSocket> sock) { m_Socket[CONNECTION_TYPE_INSTANCE] = sock; }
 
         void SendNotification(char const* format, ...) ATTR_PRINTF(2, 3);
@@ -1916,6 +1917,10 @@ class TC_GAME_API WorldSession
         // logging helper
         void LogUnexpectedOpcode(WorldPacket* packet, const char* status, const char *reason);
 
+        // receive queue helpers
+        bool NextReceivedPacket(WorldPacket*& packet, PacketFilter& updater);
+        void DeferReceivedPackets(WorldPacket* first, WorldPacket* last);
+
         // EnumData helpers
         bool IsLegitCharacterForAccount(ObjectGuid lowGUID)
         {
@@ -1965,7 +1970,10 @@ class TC_GAME_API WorldSession
         bool _filterAddonMessages;
         uint32 recruiterId;
         bool isRecruiter;
-        LockedQueue<WorldPacket*> _recvQueue;
+        MPSCQueueIntrusive<WorldPacket, &WorldPacket::QueueLink> _recvQueue;
+        // packets already taken out of _recvQueue but not handled yet (filtered out or re-enqueued), they go before anything still in _recvQueue
+        // linked through WorldPacket::QueueLink, only touched by the thread currently updating the session
+        WorldPacket* _recvDeferred;
         rbac::RBACData* _RBACData;
         uint32 expireTime;
         bool forceExit;
@@ -35,26 +35,86 @@
 #include "WorldSession.h"
 #include <zlib.h>
 
-#pragma pack(push, 1)
+SharedPacketCompression::SharedPacketCompression(WorldPacket const& packet) : _level(sWorld->getIntConfig(CONFIG_COMPRESSION_SHARED_LEVEL)), _compressed(false)
+{
+    uint16 opcode = packet.GetOpcode();
+    _uncompressed.resize(sizeof(opcode) + packet.size());
+    memcpy(_uncompressed.data(), &opcode, sizeof(opcode));
+    if (!packet.empty())
+        memcpy(_uncompressed.data() + sizeof(opcode), packet.contents(), packet.size());
+}
 
-struct CompressedWorldPacket
+bool SharedPacketCompression::Compress()
 {
-    uint32 UncompressedSize;
-    uint32 UncompressedAdler;
-    uint32 CompressedAdler;
-};
+    std::call_once(_compressOnce, [this]()
+    {
+        z_stream stream = { };
+        int32 z_res = deflateInit2(&stream, _level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+        if (z_res != Z_OK)
+        {
+            TC_LOG_ERROR("network", "Can't initialize shared packet compression (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
+            return;
+        }
 
-#pragma pack(pop)
+        _data.resize(deflateBound(&stream, _uncompressed.size()) + 6 /*sync flush marker*/);
+        stream.next_in = _uncompressed.data();
+        stream.avail_in = _uncompressed.size();
+        stream.next_out = _data.data();
+        stream.avail_out = _data.size();
+
+        z_res = deflate(&stream, Z_SYNC_FLUSH);
+        if (z_res == Z_OK && !stream.avail_in && stream.avail_out)
+        {
+            _data.resize(_data.size() - stream.avail_out);
+            _header.UncompressedSize = _uncompressed.size();
+            _header.UncompressedAdler = adler32(0x9827D8F1, _uncompressed.data(), _uncompressed.size());
+            _header.CompressedAdler = adler32(0x9827D8F1, _data.data(), _data.size());
+            _compressed = true;
+        }
+        else
+            TC_LOG_ERROR("network", "Can't compress shared packet (zlib: deflate) Error code: %i (%s, msg: %s)", z_res, zError(z_res), stream.msg);
+
+        deflateEnd(&stream);
+    });
+
+    return _compressed;
+}
 
-class EncryptablePacket : public WorldPacket
+class EncryptablePacket
 {
 public:
-    EncryptablePacket(WorldPacket const& packet, bool encrypt) : WorldPacket(packet), _encrypt(encrypt) { }
+    // payload is copied once, right behind the space reserved for header and opcode, so the frame can be encrypted in place and written as is
+    // packets with shared compression keep a reference to the shared payload instead
+    EncryptablePacket(WorldPacket const& packet, bool encrypt, std::shared_ptr<SharedPacketCompression> const& sharedCompression)
+        : _frame(0), _opcode(packet.GetOpcode()), _encrypt(encrypt)
+    {
+        if (encrypt && sharedCompression)
+        {
+            _sharedCompression = sharedCompression;
+            return;
+        }
 
+        _frame.Resize(sizeof(PacketHeader) + sizeof(uint16) + packet.size());
+        _frame.WriteCompleted(sizeof(PacketHeader) + sizeof(uint16));
+        if (!packet.empty())
+            _frame.Write(packet.contents(), packet.size());
+    }
+
+    uint16 GetOpcode() const { return _opcode; }
     bool NeedsEncryption() const { return _encrypt; }
 
+    uint8* GetPayload() { return _frame.GetBasePointer() + sizeof(PacketHeader) + sizeof(uint16); }
+    uint32 GetPayloadSize() const { return uint32(_frame.GetActiveSize() - sizeof(PacketHeader) - sizeof(uint16)); }
+
+    MessageBuffer& GetFrame() { return _frame; }
+
+    SharedPacketCompression* GetSharedCompression() const { return _sharedCompression.get(); }
+
 private:
+    MessageBuffer _frame;
+    uint16 _opcode;
     bool _encrypt;
+    std::shared_ptr<SharedPacketCompression> _sharedCompression;
 };
 
 using boost::asio::ip::tcp;
@@ -70,7 +130,7 @@ uint8 const WorldSocket::EncryptionKeySeed[16] = { 0xE9, 0x75, 0x3C, 0x50, 0x90,
 
 WorldSocket::WorldSocket(tcp::socket&& socket) : Socket(std::move(socket)),
     _type(CONNECTION_TYPE_REALM), _key(0), _OverSpeedPings(0),
-    _worldSession(nullptr), _authed(false), _sendBufferSize(4096), _compressionStream(nullptr)
+    _worldSession(nullptr), _authed(false), _compressionStream(nullptr)
 {
     _serverChallenge.SetRand(8 * 16);
     memset(_encryptKey, 0, sizeof(_encryptKey));
@@ -199,34 +259,46 @@ void WorldSocket::InitializeHandler(boost::system::error_code error, std::size_t
 bool WorldSocket::Update()
 {
     EncryptablePacket* queued;
-    MessageBuffer buffer(_sendBufferSize);
     while (_bufferQueue.Dequeue(queued))
     {
-        uint32 packetSize = queued->size();
-        if (packetSize > MinSizeForCompression && queued->NeedsEncryption())
-            packetSize = compressBound(packetSize) + sizeof(CompressedWorldPacket);
-
-        if (buffer.GetRemainingSpace() < packetSize + sizeof(PacketHeader))
+        if (SharedPacketCompression* sharedCompression = queued->GetSharedCompression())
         {
-            QueuePacket(std::move(buffer));
-            buffer.Resize(_sendBufferSize);
-        }
+            bool sent = false;
+            if (sharedCompression->Compress())
+            {
+                MessageBuffer packetBuffer(sizeof(PacketHeader) + sizeof(uint16) + sizeof(CompressedWorldPacket) + sharedCompression->GetCompressedSize());
+                if (WriteSharedCompressedPacketToBuffer(*sharedCompression, packetBuffer))
+                {
+                    QueuePacket(std::move(packetBuffer));
+                    sent = true;
+                }
+            }
 
-        if (buffer.GetRemainingSpace() >= packetSize + sizeof(PacketHeader))
-            WritePacketToBuffer(*queued, buffer);
-        else    // single packet larger than 4096 bytes
+            if (!sent)
+            {
+                MessageBuffer packetBuffer(sizeof(PacketHeader) + sizeof(uint16) + sizeof(CompressedWorldPacket)
+                    + deflateBound(_compressionStream, sharedCompression->GetPayloadSize() + sizeof(uint16)));
+                WriteCompressedPacketToBuffer(sharedCompression->GetOpcode(), sharedCompression->GetPayload(), sharedCompression->GetPayloadSize(), packetBuffer);
+                QueuePacket(std::move(packetBuffer));
+            }
+        }
+        else if (queued->GetPayloadSize() > MinSizeForCompression && queued->NeedsEncryption())
         {
-            MessageBuffer packetBuffer(packetSize + sizeof(PacketHeader));
-            WritePacketToBuffer(*queued, packetBuffer);
+            MessageBuffer packetBuffer(sizeof(PacketHeader) + sizeof(uint16) + sizeof(CompressedWorldPacket)
+                + deflateBound(_compressionStream, queued->GetPayloadSize() + sizeof(uint16)));
+            WriteCompressedPacketToBuffer(queued->GetOpcode(), queued->GetPayload(), queued->GetPayloadSize(), packetBuffer);
             QueuePacket(std::move(packetBuffer));
         }
+        else
+        {
+            // frames are queued without copying, Socket gathers consecutive ones into a single write
+            EncryptFrame(*queued);
+            QueuePacket(std::move(queued->GetFrame()));
+        }
 
         delete queued;
     }
 
-    if (buffer.GetActiveSize() > 0)
-        QueuePacket(std::move(buffer));
-
     if (!BaseSocket::Update())
         return false;
 
@@ -517,7 +589,7 @@ void WorldSocket::SendPacketAndLogOpcode(WorldPacket const& packet)
     SendPacket(packet);
 }
 
-void WorldSocket::SendPacket(WorldPacket const& packet)
+void WorldSocket::SendPacket(WorldPacket const& packet, std::shared_ptr<SharedPacketCompression> const& sharedCompression /*= nullptr*/)
 {
     if (!IsOpen())
         return;
@@ -525,57 +597,81 @@ void WorldSocket::SendPacket(WorldPacket const& packet)
     if (sPacketLog->CanLogPacket())
         sPacketLog->LogPacket(packet, SERVER_TO_CLIENT, GetRemoteIpAddress(), GetRemotePort(), GetConnectionType());
 
-    _bufferQueue.Enqueue(new EncryptablePacket(packet, _authCrypt.IsInitialized()));
+    _bufferQueue.Enqueue(new EncryptablePacket(packet, _authCrypt.IsInitialized(), sharedCompression));
 }
 
-void WorldSocket::WritePacketToBuffer(EncryptablePacket const& packet, MessageBuffer& buffer)
+void WorldSocket::EncryptFrame(EncryptablePacket& packet)
 {
+    MessageBuffer& frame = packet.GetFrame();
     uint16 opcode = packet.GetOpcode();
-    uint32 packetSize = packet.size();
+    memcpy(frame.GetBasePointer() + sizeof(PacketHeader), &opcode, sizeof(opcode));
+
+    EncryptFrame(frame.GetBasePointer(), packet.GetPayloadSize() + 2 /*opcode*/);
+}
+
+void WorldSocket::EncryptFrame(uint8* headerPos, uint32 dataSize)
+{
+    PacketHeader header;
+    header.Size = dataSize;
+    _authCrypt.EncryptSend(headerPos + sizeof(PacketHeader), header.Size, header.Tag);
+
+    memcpy(headerPos, &header, sizeof(PacketHeader));
+}
 
-    // Reserve space for buffer
+void WorldSocket::WriteCompressedPacketToBuffer(uint16 opcode, uint8 const* payload, uint32 payloadSize, MessageBuffer& buffer)
+{
+    // Reserve space for header and opcode
     uint8* headerPos = buffer.GetWritePointer();
-    buffer.WriteCompleted(sizeof(PacketHeader));
-    uint8* dataPos = buffer.GetWritePointer();
-    buffer.WriteCompleted(sizeof(opcode));
+    buffer.WriteCompleted(sizeof(PacketHeader) + sizeof(opcode));
 
-    if (packetSize > MinSizeForCompression && packet.NeedsEncryption())
-    {
-        CompressedWorldPacket cmp;
-        cmp.UncompressedSize = packetSize + 2;
-        cmp.UncompressedAdler = adler32(adler32(0x9827D8F1, (Bytef*)&opcode, 2), packet.contents(), packetSize);
+    CompressedWorldPacket cmp;
+    cmp.UncompressedSize = payloadSize + 2;
+    cmp.UncompressedAdler = adler32(adler32(0x9827D8F1, (Bytef*)&opcode, 2), payload, payloadSize);
+
+    // Reserve space for compression info - uncompressed size and checksums
+    uint8* compressionInfo = buffer.GetWritePointer();
+    buffer.WriteCompleted(sizeof(CompressedWorldPacket));
 
-        // Reserve space for compression info - uncompressed size and checksums
-        uint8* compressionInfo = buffer.GetWritePointer();
-        buffer.WriteCompleted(sizeof(CompressedWorldPacket));
+    uint32 compressedSize = CompressPacket(buffer.GetWritePointer(), opcode, payload, payloadSize);
 
-        uint32 compressedSize = CompressPacket(buffer.GetWritePointer(), packet);
+    cmp.CompressedAdler = adler32(0x9827D8F1, buffer.GetWritePointer(), compressedSize);
 
-        cmp.CompressedAdler = adler32(0x9827D8F1, buffer.GetWritePointer(), compressedSize);
+    memcpy(compressionInfo, &cmp, sizeof(CompressedWorldPacket));
+    buffer.WriteCompleted(compressedSize);
 
-        memcpy(compressionInfo, &cmp, sizeof(CompressedWorldPacket));
-        buffer.WriteCompleted(compressedSize);
-        packetSize = compressedSize + sizeof(CompressedWorldPacket);
+    uint16 compressedOpcode = SMSG_COMPRESSED_PACKET;
+    memcpy(headerPos + sizeof(PacketHeader), &compressedOpcode, sizeof(compressedOpcode));
 
-        opcode = SMSG_COMPRESSED_PACKET;
+    EncryptFrame(headerPos, compressedSize + sizeof(CompressedWorldPacket) + 2 /*opcode*/);
+}
+
+bool WorldSocket::WriteSharedCompressedPacketToBuffer(SharedPacketCompression const& sharedCompression, MessageBuffer& buffer)
+{
+    // the client inflates the shared block on top of its history for this connection, append the same data to our deflate window
+    // so packets compressed per connection afterwards keep referencing what the client actually has
+    // zlib leaves the stream untouched when this fails, the caller then compresses the packet on this connection instead
+    int32 z_res = deflateSetDictionary(_compressionStream, sharedCompression.GetUncompressedData(), sharedCompression.GetUncompressedSize());
+    if (z_res != Z_OK)
+    {
+        TC_LOG_ERROR("network", "Can't synchronize packet compression history (zlib: deflateSetDictionary) Error code: %i (%s)", z_res, zError(z_res));
+        return false;
     }
-    else if (!packet.empty())
-        buffer.Write(packet.contents(), packet.size());
 
-    memcpy(dataPos, &opcode, sizeof(opcode));
-    packetSize += 2 /*opcode*/;
+    uint8* headerPos = buffer.GetWritePointer();
+    buffer.WriteCompleted(sizeof(PacketHeader));
 
-    PacketHeader header;
-    header.Size = packetSize;
-    _authCrypt.EncryptSend(dataPos, header.Size, header.Tag);
+    uint16 compressedOpcode = SMSG_COMPRESSED_PACKET;
+    buffer.Write(&compressedOpcode, sizeof(compressedOpcode));
+    buffer.Write(&sharedCompression.GetCompressionHeader(), sizeof(CompressedWorldPacket));
+    buffer.Write(sharedCompression.GetCompressedData(), sharedCompression.GetCompressedSize());
 
-    memcpy(headerPos, &header, sizeof(PacketHeader));
+    EncryptFrame(headerPos, sharedCompression.GetCompressedSize() + sizeof(CompressedWorldPacket) + 2 /*opcode*/);
+    return true;
 }
 
-uint32 WorldSocket::CompressPacket(uint8* buffer, WorldPacket const& packet)
+uint32 WorldSocket::CompressPacket(uint8* buffer, uint16 opcode, uint8 const* payload, uint32 payloadSize)
 {
-    uint32 opcode = packet.GetOpcode();
-    uint32 bufferSize = deflateBound(_compressionStream, packet.size() + sizeof(uint16));
+    uint32 bufferSize = deflateBound(_compressionStream, payloadSize + sizeof(uint16));
 
     _compressionStream->next_out = buffer;
     _compressionStream->avail_out = bufferSize;
@@ -589,8 +685,8 @@ uint32 WorldSocket::CompressPacket(uint8* buffer, WorldPacket const& packet)
         return 0;
     }
 
-    _compressionStream->next_in = (Bytef*)packet.contents();
-    _compressionStream->avail_in = packet.size();
+    _compressionStream->next_in = (Bytef*)payload;
+    _compressionStream->avail_in = payloadSize;
 
     z_res = deflate(_compressionStream, Z_SYNC_FLUSH);
     if (z_res != Z_OK)
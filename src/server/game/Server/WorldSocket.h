@@ -28,7 +28,9 @@
 #include "MPSCQueue.h"
 #include <chrono>
 #include <functional>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 typedef struct z_stream_s z_stream;
 class EncryptablePacket;
@@ -59,13 +61,54 @@ struct PacketHeader
     bool IsValidSize() { return Size < 0x40000; }
 };
 
+struct CompressedWorldPacket
+{
+    uint32 UncompressedSize;
+    uint32 UncompressedAdler;
+    uint32 CompressedAdler;
+};
+
 #pragma pack(pop)
 
+/// Payload of a large packet sent to many sockets, compressed once for all of them
+class TC_GAME_API SharedPacketCompression
+{
+public:
+    explicit SharedPacketCompression(WorldPacket const& packet);
+
+    SharedPacketCompression(SharedPacketCompression const& right) = delete;
+    SharedPacketCompression& operator=(SharedPacketCompression const& right) = delete;
+
+    /// Deflates opcode and payload once, with a fresh raw deflate stream ending on a sync flush.
+    /// The output never references earlier data and ends on a byte boundary so it is a valid continuation of every client's stream.
+    /// Called from network threads, only the first caller compresses
+    bool Compress();
+
+    uint16 GetOpcode() const { return *reinterpret_cast<uint16 const*>(_uncompressed.data()); }
+    uint8 const* GetPayload() const { return _uncompressed.data() + sizeof(uint16); }
+    uint32 GetPayloadSize() const { return uint32(_uncompressed.size() - sizeof(uint16)); }
+
+    // opcode followed by payload, what the client appends to its inflate history
+    uint8 const* GetUncompressedData() const { return _uncompressed.data(); }
+    uint32 GetUncompressedSize() const { return uint32(_uncompressed.size()); }
+
+    CompressedWorldPacket const& GetCompressionHeader() const { return _header; }
+    uint8 const* GetCompressedData() const { return _data.data(); }
+    uint32 GetCompressedSize() const { return uint32(_data.size()); }
+
+private:
+    int32 _level;
+    std::vector<uint8> _uncompressed;
+    std::vector<uint8> _data;
+    CompressedWorldPacket _header;
+    std::once_flag _compressOnce;
+    bool _compressed;
+};
+
 class TC_GAME_API WorldSocket : public Socket<WorldSocket>
 {
     static std::string const ServerConnectionInitialize;
     static std::string const ClientConnectionInitialize;
-    static uint32 const MinSizeForCompression;
 
     static uint8 const AuthCheckSeed[16];
     static uint8 const SessionKeySeed[16];
@@ -75,6 +118,8 @@ class TC_GAME_API WorldSocket : public Socket<WorldSocket>
     typedef Socket<WorldSocket> BaseSocket;
 
 public:
+    static uint32 const MinSizeForCompression;
+
     WorldSocket(boost::asio::ip::tcp::socket&& socket);
     ~WorldSocket();
 
@@ -84,13 +129,13 @@ public:
     void Start() override;
     bool Update() override;
 
-    void SendPacket(WorldPacket const& packet);
+    void SendPacket(WorldPacket const& packet, std::shared_ptr<SharedPacketCompression> const& sharedCompression = nullptr);
 
     ConnectionType GetConnectionType() const { return _type; }
 
     void SendAuthResponseError(uint32 code);
     void SetWorldSession(WorldSession* session);
-    void SetSendBufferSize(std::size_t sendBufferSize) { _sendBufferSize = sendBufferSize; }
+    void SetSendBufferSize(std::size_t sendBufferSize) { SetMaxWriteSize(sendBufferSize); }
 
 protected:
     void OnClose() override;
@@ -114,8 +159,11 @@ private:
     void LogOpcodeText(OpcodeClient opcode, std::unique_lock<std::mutex> const& guard) const;
     /// sends and logs network.opcode without accessing WorldSession
     void SendPacketAndLogOpcode(WorldPacket const& packet);
-    void WritePacketToBuffer(EncryptablePacket const& packet, MessageBuffer& buffer);
-    uint32 CompressPacket(uint8* buffer, WorldPacket const& packet);
+    void EncryptFrame(EncryptablePacket& packet);
+    void EncryptFrame(uint8* headerPos, uint32 dataSize);
+    void WriteCompressedPacketToBuffer(uint16 opcode, uint8 const* payload, uint32 payloadSize, MessageBuffer& buffer);
+    bool WriteSharedCompressedPacketToBuffer(SharedPacketCompression const& sharedCompression, MessageBuffer& buffer);
+    uint32 CompressPacket(uint8* buffer, uint16 opcode, uint8 const* payload, uint32 payloadSize);
 
     void HandleSendAuthSession();
     void HandleAuthSession(std::shared_ptr<WorldPackets::Auth::AuthSession> authSession);
@@ -145,7 +193,6 @@ private:
     MessageBuffer _headerBuffer;
     MessageBuffer _packetBuffer;
     MPSCQueue<EncryptablePacket> _bufferQueue;
-    std::size_t _sendBufferSize;
 
     z_stream* _compressionStream;
 
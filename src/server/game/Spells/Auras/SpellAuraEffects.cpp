@@ -781,6 +781,16 @@ void AuraEffect::CalculateSpellMod()
     GetBase()->CallScriptEffectCalcSpellModHandlers(this, m_spellmod);
 }
 
+void AuraEffect::SetAmount(int32 amount)
+{
+    m_amount = amount;
+    m_canBeRecalculated = false;
+
+    // cached modifier totals of the targets contain the previous amount
+    for (auto const& pair : GetBase()->GetApplicationMap())
+        pair.second->GetTarget()->InvalidateAuraModifierCache(GetAuraType());
+}
+
 void AuraEffect::ChangeAmount(int32 newAmount, bool mark, bool onStackOrReapply)
 {
     // Reapply if amount change
@@ -529,7 +529,7 @@ void SpellCastTargets::OutDebug() const
 SpellValue::SpellValue(Difficulty diff, SpellInfo const* proto, Unit const* caster)
 {
     // todo 6.x
-    SpellEffectInfoVector effects = proto->GetEffectsForDifficulty(diff);
+    SpellEffectInfoVector const& effects = proto->GetEffectsForDifficulty(diff);
     ASSERT(effects.size() <= MAX_SPELL_EFFECTS);
     memset(EffectBasePoints, 0, sizeof(EffectBasePoints));
     memset(EffectTriggerSpell, 0, sizeof(EffectTriggerSpell));
@@ -569,6 +569,7 @@ m_spellValue(new SpellValue(caster->GetMap()->GetDifficultyID(), m_spellInfo, ca
     _effects = info->GetEffectsForDifficulty(caster->GetMap()->GetDifficultyID());
 
     m_customError = SPELL_CUSTOM_ERROR_NONE;
+    m_cacheTargetCandidates = false;
     m_skipCheck = skipCheck;
     m_fromClient = false;
     m_selfContainer = NULL;
@@ -794,6 +795,7 @@ void Spell::SelectSpellTargets()
     SelectExplicitTargets();
 
     uint32 processedAreaEffectsMask = 0;
+    m_cacheTargetCandidates = HasSharedTargetSearches();
 
     for (SpellEffectInfo const* effect : GetEffects())
     {
@@ -839,10 +841,75 @@ void Spell::SelectSpellTargets()
         }
     }
 
+    // objects found now may be gone once the spell hits
+    m_cacheTargetCandidates = false;
+    m_targetCandidates.clear();
+
     if (uint64 dstDelay = CalculateDelayMomentForDst(m_spellInfo->LaunchDelay))
         m_delayMoment = dstDelay;
 }
 
+bool Spell::HasSharedTargetSearches()
+{
+    struct TargetSearch
+    {
+        SpellEffectInfo const* Effect;
+        SpellTargetReferenceTypes Reference;
+        float Radius;
+        uint32 ContainerMask;
+    };
+
+    std::vector<TargetSearch> searches;
+    for (SpellEffectInfo const* effect : GetEffects())
+    {
+        if (!effect || !effect->IsEffect())
+            continue;
+
+        for (SpellImplicitTargetInfo const* targetType : { &effect->TargetA, &effect->TargetB })
+        {
+            SpellTargetReferenceTypes reference;
+            switch (targetType->GetSelectionCategory())
+            {
+                case TARGET_SELECT_CATEGORY_CONE:
+                    reference = TARGET_REFERENCE_TYPE_CASTER;
+                    break;
+                case TARGET_SELECT_CATEGORY_AREA:
+                    if (targetType->GetTarget() == TARGET_UNIT_CASTER_PET)
+                        continue;
+                    reference = targetType->GetReferenceType();
+                    break;
+                default:
+                    continue;
+            }
+
+            float radius = effect->CalcRadius(m_caster);
+            uint32 containerMask = GetSearcherTypeMask(targetType->GetObjectType(), effect->ImplicitTargetConditions);
+            if (!radius || !containerMask)
+                continue;
+
+            for (TargetSearch const& search : searches)
+            {
+                if (search.Reference != reference || search.Radius != radius || search.ContainerMask != containerMask)
+                    continue;
+
+                // effects with the same targets are selected once by SelectEffectImplicitTargets
+                if (search.Effect != effect &&
+                    search.Effect->TargetA.GetTarget() == effect->TargetA.GetTarget() &&
+                    search.Effect->TargetB.GetTarget() == effect->TargetB.GetTarget() &&
+                    search.Effect->ImplicitTargetConditions == effect->ImplicitTargetConditions &&
+                    CheckScriptEffectImplicitTargets(search.Effect->EffectIndex, effect->EffectIndex))
+                    continue;
+
+                return true;
+            }
+
+            searches.push_back({ effect, reference, radius, containerMask });
+        }
+    }
+
+    return false;
+}
+
 uint64 Spell::CalculateDelayMomentForDst(float launchDelay) const
 {
     if (m_targets.HasDst())
@@ -1211,8 +1278,7 @@ void Spell::SelectImplicitConeTargets(SpellEffIndex effIndex, SpellImplicitTarge
     if (uint32 containerTypeMask = GetSearcherTypeMask(objectType, condList))
     {
         Trinity::WorldObjectSpellConeTargetCheck check(DegToRad(m_spellInfo->ConeAngle), radius, m_caster, m_spellInfo, selectionType, condList);
-        Trinity::WorldObjectListSearcher<Trinity::WorldObjectSpellConeTargetCheck> searcher(m_caster, targets, check, containerTypeMask);
-        SearchTargets<Trinity::WorldObjectListSearcher<Trinity::WorldObjectSpellConeTargetCheck> >(searcher, containerTypeMask, m_caster, m_caster, radius);
+        SearchTargetList(targets, check, containerTypeMask, m_caster, m_caster, radius);
 
         CallScriptObjectAreaTargetSelectHandlers(targets, effIndex, targetType);
 
@@ -1721,8 +1787,7 @@ void Spell::SelectImplicitTrajTargets(SpellEffIndex effIndex, SpellImplicitTarge
     SpellEffectInfo const* effect = m_spellInfo->GetEffect(effIndex);
     std::list<WorldObject*> targets;
     Trinity::WorldObjectSpellTrajTargetCheck check(dist2d, &srcPos, m_caster, m_spellInfo, targetType.GetCheckType(), effect->ImplicitTargetConditions);
-    Trinity::WorldObjectListSearcher<Trinity::WorldObjectSpellTrajTargetCheck> searcher(m_caster, targets, check, GRID_MAP_TYPE_MASK_ALL);
-    SearchTargets<Trinity::WorldObjectListSearcher<Trinity::WorldObjectSpellTrajTargetCheck> > (searcher, GRID_MAP_TYPE_MASK_ALL, m_caster, &srcPos, dist2d);
+    SearchTargetList(targets, check, GRID_MAP_TYPE_MASK_ALL, m_caster, &srcPos, dist2d);
     if (targets.empty())
         return;
 
@@ -1940,6 +2005,38 @@ void Spell::SearchTargets(SEARCHER& searcher, uint32 containerMask, Unit* refere
     }
 }
 
+template<class CHECK>
+void Spell::SearchTargetList(std::list<WorldObject*>& targets, CHECK& check, uint32 containerMask, Unit* referer, Position const* pos, float radius)
+{
+    if (!m_cacheTargetCandidates)
+    {
+        Trinity::WorldObjectListSearcher<CHECK> searcher(m_caster, targets, check, containerMask);
+        SearchTargets<Trinity::WorldObjectListSearcher<CHECK> >(searcher, containerMask, referer, pos, radius);
+        return;
+    }
+
+    // same objects in the same order as a visit with the check
+    // a script hook of an earlier effect may have removed the object from the map, the cell visit would not find it anymore
+    for (WorldObject* candidate : GetTargetCandidates(containerMask, referer, pos, radius))
+        if (candidate->IsInWorld() && candidate->GetMap() == referer->GetMap() && check(candidate))
+            targets.push_back(candidate);
+}
+
+std::vector<WorldObject*> const& Spell::GetTargetCandidates(uint32 containerMask, Unit* referer, Position const* pos, float radius)
+{
+    for (TargetCandidates const& candidates : m_targetCandidates)
+        if (candidates.X == pos->GetPositionX() && candidates.Y == pos->GetPositionY() && candidates.Radius == radius && candidates.ContainerMask == containerMask)
+            return candidates.Objects;
+
+    m_targetCandidates.push_back({ pos->GetPositionX(), pos->GetPositionY(), radius, containerMask, { } });
+    TargetCandidates& candidates = m_targetCandidates.back();
+
+    Trinity::WorldObjectSpellTargetCandidateCheck check;
+    Trinity::WorldObjectListSearcher<Trinity::WorldObjectSpellTargetCandidateCheck> searcher(m_caster, candidates.Objects, check, containerMask);
+    SearchTargets<Trinity::WorldObjectListSearcher<Trinity::WorldObjectSpellTargetCandidateCheck> >(searcher, containerMask, referer, pos, radius);
+    return candidates.Objects;
+}
+
 WorldObject* Spell::SearchNearbyTarget(float range, SpellTargetObjectTypes objectType, SpellTargetCheckTypes selectionType, ConditionContainer* condList)
 {
     WorldObject* target = NULL;
@@ -1958,8 +2055,7 @@ void Spell::SearchAreaTargets(std::list<WorldObject*>& targets, float range, Pos
     if (!containerTypeMask)
         return;
     Trinity::WorldObjectSpellAreaTargetCheck check(range, position, m_caster, referer, m_spellInfo, selectionType, condList);
-    Trinity::WorldObjectListSearcher<Trinity::WorldObjectSpellAreaTargetCheck> searcher(m_caster, targets, check, containerTypeMask);
-    SearchTargets<Trinity::WorldObjectListSearcher<Trinity::WorldObjectSpellAreaTargetCheck> > (searcher, containerTypeMask, m_caster, position, range);
+    SearchTargetList(targets, check, containerTypeMask, m_caster, position, range);
 }
 
 void Spell::SearchChainTargets(std::list<WorldObject*>& targets, uint32 chainTargets, WorldObject* target, SpellTargetObjectTypes objectType, SpellTargetCheckTypes selectType, ConditionContainer* condList, bool isChainHeal)
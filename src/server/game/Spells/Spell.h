@@ -542,6 +542,9 @@ class TC_GAME_API Spell
 
         uint32 GetSearcherTypeMask(SpellTargetObjectTypes objType, ConditionContainer* condList);
         template<class SEARCHER> void SearchTargets(SEARCHER& searcher, uint32 containerMask, Unit* referer, Position const* pos, float radius);
+        template<class CHECK> void SearchTargetList(std::list<WorldObject*>& targets, CHECK& check, uint32 containerMask, Unit* referer, Position const* pos, float radius);
+        std::vector<WorldObject*> const& GetTargetCandidates(uint32 containerMask, Unit* referer, Position const* pos, float radius);
+        bool HasSharedTargetSearches();
 
         WorldObject* SearchNearbyTarget(float range, SpellTargetObjectTypes objectType, SpellTargetCheckTypes selectionType, ConditionContainer* condList = NULL);
         void SearchAreaTargets(std::list<WorldObject*>& targets, float range, Position const* position, Unit* referer, SpellTargetObjectTypes objectType, SpellTargetCheckTypes selectionType, ConditionContainer* condList);
@@ -843,6 +846,18 @@ class TC_GAME_API Spell
 
         SpellDestination m_destTargets[MAX_SPELL_EFFECTS];
 
+        // objects of the grid searches done by SelectSpellTargets, only kept when several effects search the same area so they check the saved objects instead of visiting the cells again
+        struct TargetCandidates
+        {
+            float X;
+            float Y;
+            float Radius;
+            uint32 ContainerMask;
+            std::vector<WorldObject*> Objects;
+        };
+        std::vector<TargetCandidates> m_targetCandidates;
+        bool m_cacheTargetCandidates;
+
         void AddUnitTarget(Unit* target, uint32 effectMask, bool checkIfValid = true, bool implicit = true, Position const* losPosition = nullptr);
         void AddGOTarget(GameObject* target, uint32 effectMask);
         void AddItemTarget(Item* item, uint32 effectMask);
@@ -987,6 +1002,12 @@ namespace Trinity
             SpellInfo const* spellInfo, SpellTargetCheckTypes selectionType, ConditionContainer* condList);
         bool operator()(WorldObject* target);
     };
+
+    // takes every object of the visited cells, the checks above are applied to them afterwards
+    struct TC_GAME_API WorldObjectSpellTargetCandidateCheck
+    {
+        bool operator()(WorldObject* /*target*/) const { return true; }
+    };
 }
 
 typedef void(Spell::*pEffect)(SpellEffIndex effIndex);
@@ -3870,6 +3870,8 @@ void Spell::EffectApplyGlyph(SpellEffIndex /*effIndex*/)
     else if (glyphId)
         glyphs.push_back(glyphId);
 
+    player->SetSaveDataChanged(PLAYER_SAVE_DATA_GLYPHS);
+
     if (GlyphPropertiesEntry const* glyphProperties = sGlyphPropertiesStore.LookupEntry(glyphId))
         player->CastSpell(player, glyphProperties->SpellID, true);
 
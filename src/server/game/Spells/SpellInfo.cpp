@@ -1096,16 +1096,30 @@ SpellInfo::SpellInfo(SpellInfoLoadHelper const& data, SpellEffectEntryMap const&
 {
     Id = data.Entry->ID;
 
+    // one allocation for all effects, the storage must not move once pointers to it are handed out
+    std::size_t effectCount = 0;
+    for (SpellEffectEntryMap::value_type const& itr : effectsMap)
+        effectCount += std::count_if(itr.second.begin(), itr.second.end(), [](SpellEffectEntry const* effect) { return effect != nullptr; });
+
+    _effectInfos.reserve(effectCount);
+    _effects.reserve(effectsMap.size());
     for (SpellEffectEntryMap::value_type const& itr : effectsMap)
     {
         SpellEffectEntryVector const& effects = itr.second;
         _effects[itr.first].resize(effects.size());
 
         for (size_t i = 0; i < effects.size(); ++i)
+        {
             if (SpellEffectEntry const* effect = effects[i])
-                _effects[itr.first][effect->EffectIndex] = new SpellEffectInfo(this, effect->EffectIndex, effect);
+            {
+                _effectInfos.emplace_back(this, effect->EffectIndex, effect);
+                _effects[itr.first][effect->EffectIndex] = &_effectInfos.back();
+            }
+        }
     }
 
+    _LoadDifficultyEffects();
+
     SpellName = data.Entry->Name;
 
     // SpellMiscEntry
@@ -1272,10 +1286,10 @@ SpellInfo::~SpellInfo()
 
 void SpellInfo::_UnloadSpellEffects()
 {
-    for (SpellEffectInfoMap::value_type& i : _effects)
-        for (size_t j = 0; j < i.second.size(); ++j)
-            delete i.second[j];
+    _difficultyEffects.clear();
+    _defaultEffects.clear();
     _effects.clear();
+    _effectInfos.clear();
 }
 
 uint32 SpellInfo::GetCategory() const
@@ -1285,7 +1299,7 @@ uint32 SpellInfo::GetCategory() const
 
 bool SpellInfo::HasEffect(uint32 difficulty, SpellEffectName effect) const
 {
-    SpellEffectInfoVector effects = GetEffectsForDifficulty(difficulty);
+    SpellEffectInfoVector const& effects = GetEffectsForDifficulty(difficulty);
     for (SpellEffectInfo const* eff : effects)
     {
         if (eff && eff->IsEffect(effect))
@@ -1309,7 +1323,7 @@ bool SpellInfo::HasEffect(SpellEffectName effect) const
 
 bool SpellInfo::HasAura(uint32 difficulty) const
 {
-    SpellEffectInfoVector effects = GetEffectsForDifficulty(difficulty);
+    SpellEffectInfoVector const& effects = GetEffectsForDifficulty(difficulty);
     for (SpellEffectInfo const* effect : effects)
     {
         if (effect && effect->IsAura())
@@ -1320,7 +1334,7 @@ bool SpellInfo::HasAura(uint32 difficulty) const
 
 bool SpellInfo::HasAura(uint32 difficulty, AuraType aura) const
 {
-    SpellEffectInfoVector effects = GetEffectsForDifficulty(difficulty);
+    SpellEffectInfoVector const& effects = GetEffectsForDifficulty(difficulty);
     for (SpellEffectInfo const* effect : effects)
     {
         if (effect && effect->IsAura(aura))
@@ -1331,7 +1345,7 @@ bool SpellInfo::HasAura(uint32 difficulty, AuraType aura) const
 
 bool SpellInfo::HasAreaAuraEffect(uint32 difficulty) const
 {
-    SpellEffectInfoVector effects = GetEffectsForDifficulty(difficulty);
+    SpellEffectInfoVector const& effects = GetEffectsForDifficulty(difficulty);
     for (SpellEffectInfo const* effect : effects)
     {
         if (effect && effect->IsAreaAuraEffect())
@@ -1414,7 +1428,7 @@ bool SpellInfo::HasTargetType(::Targets target) const
 
 bool SpellInfo::HasTargetType(uint32 difficulty, ::Targets target) const
 {
-    SpellEffectInfoVector effects = GetEffectsForDifficulty(difficulty);
+    SpellEffectInfoVector const& effects = GetEffectsForDifficulty(difficulty);
     for (SpellEffectInfo const* effect : effects)
     {
         if (effect && (effect->TargetA.GetTarget() == target || effect->TargetB.GetTarget() == target))
@@ -1452,7 +1466,7 @@ bool SpellInfo::IsQuestTame() const
 
 bool SpellInfo::IsProfession(uint32 difficulty) const
 {
-    SpellEffectInfoVector effects = GetEffectsForDifficulty(difficulty);
+    SpellEffectInfoVector const& effects = GetEffectsForDifficulty(difficulty);
     for (SpellEffectInfo const* effect : effects)
     {
         if (effect && effect->Effect == SPELL_EFFECT_SKILL)
@@ -1468,7 +1482,7 @@ bool SpellInfo::IsProfession(uint32 difficulty) const
 
 bool SpellInfo::IsPrimaryProfession(uint32 difficulty) const
 {
-    SpellEffectInfoVector effects = GetEffectsForDifficulty(difficulty);
+    SpellEffectInfoVector const& effects = GetEffectsForDifficulty(difficulty);
     for(SpellEffectInfo const* effect : effects)
     {
         if (effect && effect->Effect == SPELL_EFFECT_SKILL)
@@ -1500,7 +1514,7 @@ bool SpellInfo::IsAbilityOfSkillType(uint32 skillType) const
 
 bool SpellInfo::IsAffectingArea(uint32 difficulty) const
 {
-    SpellEffectInfoVector effects = GetEffectsForDifficulty(difficulty);
+    SpellEffectInfoVector const& effects = GetEffectsForDifficulty(difficulty);
     for (SpellEffectInfo const* effect : effects)
     {
         if (effect && effect->IsEffect() && (effect->IsTargetingArea() || effect->IsEffect(SPELL_EFFECT_PERSISTENT_AREA_AURA) || effect->IsAreaAuraEffect()))
@@ -1512,7 +1526,7 @@ bool SpellInfo::IsAffectingArea(uint32 difficulty) const
 // checks if spell targets are selected from area, doesn't include spell effects in check (like area wide auras for example)
 bool SpellInfo::IsTargetingArea(uint32 difficulty) const
 {
-    SpellEffectInfoVector effects = GetEffectsForDifficulty(difficulty);
+    SpellEffectInfoVector const& effects = GetEffectsForDifficulty(difficulty);
     for (SpellEffectInfo const* effect : effects)
     {
         if (effect && effect->IsEffect() && effect->IsTargetingArea())
@@ -1546,7 +1560,7 @@ bool SpellInfo::NeedsToBeTriggeredByCaster(SpellInfo const* triggeringSpell, uin
     if (triggeringSpell->IsChanneled())
     {
         uint32 mask = 0;
-        SpellEffectInfoVector effects = GetEffectsForDifficulty(difficulty);
+        SpellEffectInfoVector const& effects = GetEffectsForDifficulty(difficulty);
         for (SpellEffectInfo const* effect : effects)
         {
             if (!effect)
@@ -1586,7 +1600,7 @@ bool SpellInfo::IsStackableWithRanks() const
         return false;
 
     // All stance spells. if any better way, change it.
-    SpellEffectInfoVector effects = GetEffectsForDifficulty(DIFFICULTY_NONE);
+    SpellEffectInfoVector const& effects = GetEffectsForDifficulty(DIFFICULTY_NONE);
     for (SpellEffectInfo const* effect : effects)
     {
         if (!effect)
@@ -1653,7 +1667,7 @@ bool SpellInfo::IsAllowingDeadTarget() const
 
 bool SpellInfo::IsGroupBuff() const
 {
-    SpellEffectInfoVector effects = GetEffectsForDifficulty(DIFFICULTY_NONE);
+    SpellEffectInfoVector const& effects = GetEffectsForDifficulty(DIFFICULTY_NONE);
     for (SpellEffectInfo const* effect : effects)
     {
         if (!effect)
@@ -4700,38 +4714,12 @@ void SpellInfo::_UnloadImplicitTargetConditionLists()
     }
 }
 
-SpellEffectInfoVector SpellInfo::GetEffectsForDifficulty(uint32 difficulty) const
+void SpellInfo::_LoadDifficultyEffects()
 {
-    SpellEffectInfoVector effList;
-
-    // downscale difficulty if original was not found
-    DifficultyEntry const* difficultyEntry = sDifficultyStore.LookupEntry(difficulty);
-    while (difficultyEntry)
-    {
-        SpellEffectInfoMap::const_iterator effectItr = _effects.find(difficulty);
-        if (effectItr != _effects.end())
-        {
-            for (SpellEffectInfo const* effect : effectItr->second)
-            {
-                if (effect)
-                {
-                    if (effect->EffectIndex >= effList.size())
-                        effList.resize(effect->EffectIndex + 1);
-
-                    if (!effList[effect->EffectIndex])
-                        effList[effect->EffectIndex] = effect;
-                }
-            }
-        }
-
-        difficultyEntry = sDifficultyStore.LookupEntry(difficultyEntry->FallbackDifficultyID);
-    }
-
-    // DIFFICULTY_NONE effects are the default effects, always active if current difficulty's effects don't overwrite
-    SpellEffectInfoMap::const_iterator itr = _effects.find(DIFFICULTY_NONE);
-    if (itr != _effects.end())
+    // effects of a difficulty replace the DIFFICULTY_NONE ones with the same index
+    auto mergeEffects = [](SpellEffectInfoVector& effList, SpellEffectInfoVector const& effects)
     {
-        for (SpellEffectInfo const* effect : itr->second)
+        for (SpellEffectInfo const* effect : effects)
         {
             if (effect)
             {
@@ -4742,32 +4730,60 @@ SpellEffectInfoVector SpellInfo::GetEffectsForDifficulty(uint32 difficulty) cons
                     effList[effect->EffectIndex] = effect;
             }
         }
-    }
+    };
+
+    SpellEffectInfoMap::const_iterator defaultItr = _effects.find(DIFFICULTY_NONE);
+    if (defaultItr != _effects.end())
+        mergeEffects(_defaultEffects, defaultItr->second);
+
+    for (SpellEffectInfoMap::value_type const& itr : _effects)
+    {
+        // lookups only ever used the effects of the requested difficulty, not the ones of its fallbacks
+        if (itr.first == DIFFICULTY_NONE || !sDifficultyStore.LookupEntry(itr.first))
+            continue;
 
-    return effList;
+        SpellEffectInfoVector& effList = _difficultyEffects[itr.first];
+        mergeEffects(effList, itr.second);
+        if (defaultItr != _effects.end())
+            mergeEffects(effList, defaultItr->second);
+    }
 }
 
-SpellEffectInfo const* SpellInfo::GetEffect(uint32 difficulty, uint32 index) const
+SpellEffectInfoVector const& SpellInfo::GetEffectsForDifficulty(uint32 difficulty) const
 {
-    DifficultyEntry const* difficultyEntry = sDifficultyStore.LookupEntry(difficulty);
-    while (difficultyEntry)
+    if (!_difficultyEffects.empty())
     {
-        SpellEffectInfoMap::const_iterator itr = _effects.find(difficulty);
-        if (itr != _effects.end())
-            if (itr->second.size() > index && itr->second[index])
-                return itr->second[index];
-
-        difficultyEntry = sDifficultyStore.LookupEntry(difficultyEntry->FallbackDifficultyID);
+        SpellEffectInfoMap::const_iterator itr = _difficultyEffects.find(difficulty);
+        if (itr != _difficultyEffects.end())
+            return itr->second;
     }
 
-    SpellEffectInfoMap::const_iterator itr = _effects.find(DIFFICULTY_NONE);
-    if (itr != _effects.end())
-        if (itr->second.size() > index)
-            return itr->second[index];
+    return _defaultEffects;
+}
+
+SpellEffectInfo const* SpellInfo::GetEffect(uint32 difficulty, uint32 index) const
+{
+    SpellEffectInfoVector const& effects = GetEffectsForDifficulty(difficulty);
+    if (index < effects.size())
+        return effects[index];
 
     return nullptr;
 }
 
+std::size_t SpellInfo::GetEffectsMemoryUsage(std::size_t& resolvedTables) const
+{
+    auto getMapSize = [](SpellEffectInfoMap const& effects)
+    {
+        std::size_t size = effects.capacity() * sizeof(SpellEffectInfoMap::value_type);
+        for (SpellEffectInfoMap::value_type const& itr : effects)
+            size += itr.second.capacity() * sizeof(SpellEffectInfo const*);
+        return size;
+    };
+
+    resolvedTables = getMapSize(_difficultyEffects) + _defaultEffects.capacity() * sizeof(SpellEffectInfo const*);
+    return _effectInfos.capacity() * sizeof(SpellEffectInfo) + getMapSize(_effects) + resolvedTables;
+}
+
 bool SpellInfo::IsTargetingLine() const
 {
     for (uint8 i = 0; i < MAX_SPELL_EFFECTS; ++i)
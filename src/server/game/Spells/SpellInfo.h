@@ -24,6 +24,7 @@
 #include "Object.h"
 #include "SpellAuraDefines.h"
 
+#include <boost/container/flat_map.hpp>
 #include <boost/container/flat_set.hpp>
 
 class Unit;
@@ -418,7 +419,7 @@ private:
 };
 
 typedef std::vector<SpellEffectInfo const*> SpellEffectInfoVector;
-typedef std::unordered_map<uint32, SpellEffectInfoVector> SpellEffectInfoMap;
+typedef boost::container::flat_map<uint32, SpellEffectInfoVector> SpellEffectInfoMap;
 
 typedef std::vector<SpellEffectEntry const*> SpellEffectEntryVector;
 typedef std::unordered_map<uint32, SpellEffectEntryVector> SpellEffectEntryMap;
@@ -686,9 +687,13 @@ class TC_GAME_API SpellInfo
         uint32 GetSpellXSpellVisualId(Unit const* caster = nullptr) const;
         uint32 GetSpellVisual(Unit const* caster = nullptr) const;
 
-        SpellEffectInfoVector GetEffectsForDifficulty(uint32 difficulty) const;
+        SpellEffectInfoVector const& GetEffectsForDifficulty(uint32 difficulty) const;
         SpellEffectInfo const* GetEffect(uint32 difficulty, uint32 index) const;
-        SpellEffectInfo const* GetEffect(uint32 index) const { return GetEffect(DIFFICULTY_NONE, index); }
+        SpellEffectInfo const* GetEffect(uint32 index) const { return index < _defaultEffects.size() ? _defaultEffects[index] : nullptr; }
+
+        // bytes allocated for the effects and their lookup tables, without the SpellInfo itself
+        // resolvedTables receives the part used by the resolved per difficulty lists, which duplicate the pointers of _effects
+        std::size_t GetEffectsMemoryUsage(std::size_t& resolvedTables) const;
 
         // spell diminishing returns
         DiminishingGroup GetDiminishingReturnsGroupForSpell() const;
@@ -713,13 +718,17 @@ class TC_GAME_API SpellInfo
         void _LoadAuraState();
         void _LoadSpellDiminishInfo();
         void _LoadImmunityInfo();
+        void _LoadDifficultyEffects();
 
         // unloading helpers
         void _UnloadImplicitTargetConditionLists();
         void _UnloadSpellEffects();
 
     private:
-        SpellEffectInfoMap _effects;
+        std::vector<SpellEffectInfo> _effectInfos;         // effects of all difficulties, everything below points into it
+        SpellEffectInfoMap _effects;                        // own effects of each difficulty
+        SpellEffectInfoVector _defaultEffects;              // effects of the difficulties without own ones
+        SpellEffectInfoMap _difficultyEffects;              // effects of the other difficulties, completed with the default ones
         SpellVisualMap _visuals;
         bool _hasPowerDifficultyData;
         SpellSpecificType _spellSpecific;
@@ -58,7 +58,7 @@ bool IsPartOfSkillLine(uint32 skillId, uint32 spellId)
     return false;
 }
 
-SpellMgr::SpellMgr() { }
+SpellMgr::SpellMgr() : mSpellProcGeneration(0) { }
 
 SpellMgr::~SpellMgr()
 {
@@ -1284,6 +1284,7 @@ void SpellMgr::LoadSpellProcs()
     uint32 oldMSTime = getMSTime();
 
     mSpellProcMap.clear();                             // need for reload case
+    ++mSpellProcGeneration;                            // units rebuild their proc auras from the new entries
 
     //                                                     0           1                2                 3                 4                 5                 6
     QueryResult result = WorldDatabase.Query("SELECT SpellId, SchoolMask, SpellFamilyName, SpellFamilyMask0, SpellFamilyMask1, SpellFamilyMask2, SpellFamilyMask3, "
@@ -2358,7 +2359,21 @@ void SpellMgr::LoadSpellInfoStore()
         }
     }
 
-    TC_LOG_INFO("server.loading", ">> Loaded SpellInfo store in %u ms", GetMSTimeDiffToNow(oldMSTime));
+    std::size_t memoryUsage = mSpellInfoMap.capacity() * sizeof(SpellInfo*);
+    std::size_t resolvedTablesUsage = 0;
+    for (SpellInfo const* spellInfo : mSpellInfoMap)
+    {
+        if (spellInfo)
+        {
+            std::size_t resolvedTables = 0;
+            memoryUsage += sizeof(SpellInfo) + spellInfo->GetEffectsMemoryUsage(resolvedTables);
+            resolvedTablesUsage += resolvedTables;
+        }
+    }
+
+    // the resolved per difficulty lists are memory added to save the lookups, everything else was allocated before as well
+    TC_LOG_INFO("server.loading", ">> Loaded SpellInfo store in %u ms, SpellInfo and effects use " SZFMTD " KB in total, " SZFMTD " KB of it for the resolved per difficulty effect lists",
+        GetMSTimeDiffToNow(oldMSTime), memoryUsage / 1024, resolvedTablesUsage / 1024);
 }
 
 void SpellMgr::UnloadSpellInfoStore()
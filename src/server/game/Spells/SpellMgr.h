@@ -664,6 +664,7 @@ class TC_GAME_API SpellMgr
 
         // Spell proc table
         SpellProcEntry const* GetSpellProcEntry(uint32 spellId) const;
+        uint32 GetSpellProcGeneration() const { return mSpellProcGeneration; }
         static bool CanSpellTriggerProcOnEvent(SpellProcEntry const& procEntry, ProcEventInfo& eventInfo);
 
         // Spell threat table
@@ -754,6 +755,7 @@ class TC_GAME_API SpellMgr
         SpellGroupSpellMap         mSpellGroupSpell;
         SpellGroupStackMap         mSpellGroupStack;
         SpellProcMap               mSpellProcMap;
+        uint32                     mSpellProcGeneration;
         SpellThreatMap             mSpellThreatMap;
         SpellPetAuraMap            mSpellPetAuraMap;
         SpellLinkedMap             mSpellLinkedMap;
@@ -0,0 +1,283 @@
+/*
+ * This file is part of the TrinityCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TickProfiler.h"
+#include "Metric.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <unordered_map>
+
+namespace
+{
+    struct TickProfilerEvent
+    {
+        char const* Name;
+        uint32 MapId;
+        uint32 InstanceId;
+        int64 Start;                                        // nanoseconds since profiler creation
+        int64 Duration;                                     // nanoseconds
+    };
+
+    struct TickProfilerPhaseKey
+    {
+        char const* Name;
+        uint32 MapId;
+        uint32 InstanceId;
+
+        bool operator==(TickProfilerPhaseKey const& right) const
+        {
+            return Name == right.Name && MapId == right.MapId && InstanceId == right.InstanceId;
+        }
+    };
+
+    struct TickProfilerPhaseKeyHash
+    {
+        std::size_t operator()(TickProfilerPhaseKey const& key) const
+        {
+            std::size_t hash = std::hash<char const*>()(key.Name);
+            hash ^= std::hash<uint64>()(uint64(key.MapId) << 32 | key.InstanceId) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+            return hash;
+        }
+    };
+
+    struct TickProfilerPhaseStats
+    {
+        uint64 Count = 0;
+        int64 TotalTime = 0;                                // nanoseconds
+        int64 MaxTime = 0;                                  // nanoseconds
+    };
+
+    typedef std::unordered_map<TickProfilerPhaseKey, TickProfilerPhaseStats, TickProfilerPhaseKeyHash> TickProfilerPhaseMap;
+
+    // map of the innermost scope on this thread that has one
+    thread_local uint32 CurrentMapId = TICK_PROFILER_NO_MAP;
+    thread_local uint32 CurrentInstanceId = 0;
+    thread_local uint32 ScopeDepth = 0;
+
+    void AddPhase(TickProfilerPhaseMap& phases, TickProfilerPhaseKey const& key, uint64 count, int64 totalTime, int64 maxTime)
+    {
+        TickProfilerPhaseStats& stats = phases[key];
+        stats.Count += count;
+        stats.TotalTime += totalTime;
+        stats.MaxTime = std::max(stats.MaxTime, maxTime);
+    }
+}
+
+struct TickProfiler::ThreadData
+{
+    // only contended while a reader copies the data
+    std::mutex Lock;
+    uint32 ThreadIndex = 0;
+    std::vector<TickProfilerEvent> Events;
+    std::size_t NextEvent = 0;
+    std::size_t EventCount = 0;
+    TickProfilerPhaseMap Phases;
+
+    // only used by the owning thread, published under Lock when its outermost scope ends
+    std::vector<TickProfilerEvent> PendingEvents;
+    TickProfilerPhaseMap PendingPhases;
+};
+
+TickProfiler::TickProfiler() : _enabled(false), _traceCapacity(0), _epoch(std::chrono::steady_clock::now())
+{
+}
+
+TickProfiler::~TickProfiler() = default;
+
+TickProfiler* TickProfiler::instance()
+{
+    static TickProfiler instance;
+    return &instance;
+}
+
+void TickProfiler::SetEnabled(bool enabled)
+{
+    _enabled.store(enabled, std::memory_order_relaxed);
+}
+
+TickProfiler::ThreadData& TickProfiler::GetThreadData()
+{
+    // owned by _threads so the data of finished threads can still be dumped
+    thread_local ThreadData* threadData = nullptr;
+    if (!threadData)
+    {
+        std::lock_guard<std::mutex> lock(_threadsLock);
+        _threads.push_back(std::make_unique<ThreadData>());
+        threadData = _threads.back().get();
+        threadData->ThreadIndex = uint32(_threads.size());
+    }
+
+    return *threadData;
+}
+
+void TickProfiler::Record(char const* name, uint32 mapId, uint32 instanceId, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end, bool outermost)
+{
+    int64 startTime = std::chrono::duration_cast<std::chrono::nanoseconds>(start - _epoch).count();
+    int64 duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    ThreadData& data = GetThreadData();
+    std::size_t capacity = _traceCapacity.load(std::memory_order_relaxed);
+    if (capacity)
+        data.PendingEvents.push_back({ name, mapId, instanceId, startTime, duration });
+
+    // totals are only consumed by LogMetrics, without Metric they would pile up forever
+    if (sMetric->IsEnabled())
+        AddPhase(data.PendingPhases, { name, mapId, instanceId }, 1, duration, duration);
+
+    if (outermost || (capacity && data.PendingEvents.size() >= capacity))
+        Publish(data, capacity);
+}
+
+void TickProfiler::Publish(ThreadData& data, std::size_t capacity)
+{
+    if (data.PendingEvents.empty() && data.PendingPhases.empty() && data.Events.size() == capacity)
+        return;
+
+    std::lock_guard<std::mutex> lock(data.Lock);
+
+    if (data.Events.size() != capacity)
+    {
+        data.Events.assign(capacity, TickProfilerEvent());
+        data.NextEvent = 0;
+        data.EventCount = 0;
+    }
+
+    if (capacity)
+    {
+        for (TickProfilerEvent const& event : data.PendingEvents)
+        {
+            data.Events[data.NextEvent] = event;
+            data.NextEvent = (data.NextEvent + 1) % capacity;
+        }
+
+        data.EventCount = std::min(data.EventCount + data.PendingEvents.size(), capacity);
+    }
+
+    for (auto const& phase : data.PendingPhases)
+        AddPhase(data.Phases, phase.first, phase.second.Count, phase.second.TotalTime, phase.second.MaxTime);
+
+    data.PendingEvents.clear();
+    data.PendingPhases.clear();
+}
+
+void TickProfiler::LogMetrics()
+{
+    TickProfilerPhaseMap totals;
+
+    {
+        std::lock_guard<std::mutex> lock(_threadsLock);
+        for (std::unique_ptr<ThreadData> const& data : _threads)
+        {
+            TickProfilerPhaseMap phases;
+            {
+                std::lock_guard<std::mutex> dataLock(data->Lock);
+                std::swap(phases, data->Phases);
+            }
+
+            for (auto const& phase : phases)
+                AddPhase(totals, phase.first, phase.second.Count, phase.second.TotalTime, phase.second.MaxTime);
+        }
+    }
+
+    if (!sMetric->IsEnabled())
+        return;
+
+    for (auto const& phase : totals)
+    {
+        std::vector<MetricTag> tags = { TC_METRIC_TAG("phase", phase.first.Name) };
+        if (phase.first.MapId != TICK_PROFILER_NO_MAP)
+        {
+            tags.push_back(TC_METRIC_TAG("map", std::to_string(phase.first.MapId)));
+            tags.push_back(TC_METRIC_TAG("instance", std::to_string(phase.first.InstanceId)));
+        }
+
+        sMetric->LogValue("tick_phase_count", phase.second.Count, tags);
+        sMetric->LogValue("tick_phase_time", phase.second.TotalTime / 1000, tags);
+        sMetric->LogValue("tick_phase_max_time", phase.second.MaxTime / 1000, std::move(tags));
+    }
+}
+
+bool TickProfiler::DumpTrace(std::string const& fileName) const
+{
+    std::ofstream file(fileName, std::ios::out | std::ios::trunc);
+    if (!file)
+        return false;
+
+    file << "{\"traceEvents\":[";
+    file << std::fixed << std::setprecision(3);
+
+    bool first = true;
+    std::lock_guard<std::mutex> lock(_threadsLock);
+    for (std::unique_ptr<ThreadData> const& data : _threads)
+    {
+        std::vector<TickProfilerEvent> events;
+        {
+            std::lock_guard<std::mutex> dataLock(data->Lock);
+            events.reserve(data->EventCount);
+            std::size_t oldest = (data->NextEvent + data->Events.size() - data->EventCount) % std::max<std::size_t>(data->Events.size(), 1);
+            for (std::size_t i = 0; i < data->EventCount; ++i)
+                events.push_back(data->Events[(oldest + i) % data->Events.size()]);
+        }
+
+        if (!first)
+            file << ',';
+        first = false;
+
+        file << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << data->ThreadIndex
+            << ",\"args\":{\"name\":\"Thread " << data->ThreadIndex << "\"}}";
+
+        // scope names are string literals from the code, they never need escaping
+        for (TickProfilerEvent const& event : events)
+        {
+            file << ",\n{\"name\":\"" << event.Name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << data->ThreadIndex
+                << ",\"ts\":" << event.Start / 1000.0 << ",\"dur\":" << event.Duration / 1000.0;
+            if (event.MapId != TICK_PROFILER_NO_MAP)
+                file << ",\"args\":{\"map\":" << event.MapId << ",\"instance\":" << event.InstanceId << '}';
+            file << '}';
+        }
+    }
+
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return bool(file);
+}
+
+void TickProfilerScope::Start(char const* name, uint32 mapId, uint32 instanceId)
+{
+    _name = name;
+    _parentMapId = CurrentMapId;
+    _parentInstanceId = CurrentInstanceId;
+    if (mapId == TICK_PROFILER_NO_MAP)
+    {
+        mapId = CurrentMapId;
+        instanceId = CurrentInstanceId;
+    }
+
+    _mapId = mapId;
+    _instanceId = instanceId;
+    ++ScopeDepth;
+    CurrentMapId = mapId;
+    CurrentInstanceId = instanceId;
+    _start = std::chrono::steady_clock::now();
+}
+
+void TickProfilerScope::Stop()
+{
+    sTickProfiler->Record(_name, _mapId, _instanceId, _start, std::chrono::steady_clock::now(), !--ScopeDepth);
+    CurrentMapId = _parentMapId;
+    CurrentInstanceId = _parentInstanceId;
+}
@@ -0,0 +1,115 @@
+/*
+ * This file is part of the TrinityCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TickProfiler_h__
+#define TickProfiler_h__
+
+#include "Define.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// map id of scopes not running inside any map update
+#define TICK_PROFILER_NO_MAP 0xFFFFFFFF
+
+/// Nested timing scopes of the world and map update loops.
+/// Every thread collects finished scopes on its own and publishes them once its outermost scope ends, into its ring buffer
+/// (for trace dumps) and per map/phase totals (for metrics while Metric is enabled). Readers only lock a thread's published
+/// data while copying it so the update threads never wait on each other.
+class TC_GAME_API TickProfiler
+{
+    struct ThreadData;
+
+public:
+    static TickProfiler* instance();
+
+    bool IsEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+    void SetEnabled(bool enabled);
+    void SetTraceCapacity(uint32 events) { _traceCapacity = events; }
+
+    void Record(char const* name, uint32 mapId, uint32 instanceId, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end, bool outermost);
+
+    /// Sends per map and phase totals recorded since the previous call through Metric
+    void LogMetrics();
+
+    /// Writes the ring buffers of all threads as Chrome trace event JSON (chrome://tracing, ui.perfetto.dev)
+    bool DumpTrace(std::string const& fileName) const;
+
+private:
+    TickProfiler();
+    ~TickProfiler();
+
+    ThreadData& GetThreadData();
+    void Publish(ThreadData& data, std::size_t capacity);
+
+    std::atomic<bool> _enabled;
+    std::atomic<uint32> _traceCapacity;
+    std::chrono::steady_clock::time_point _epoch;
+
+    mutable std::mutex _threadsLock;
+    std::vector<std::unique_ptr<ThreadData>> _threads;
+};
+
+#define sTickProfiler TickProfiler::instance()
+
+/// Times its own lifetime, scopes without a map inherit the map of the enclosing scope
+class TC_GAME_API TickProfilerScope
+{
+public:
+    explicit TickProfilerScope(char const* name) : _name(nullptr)
+    {
+        if (sTickProfiler->IsEnabled())
+            Start(name, TICK_PROFILER_NO_MAP, 0);
+    }
+
+    TickProfilerScope(char const* name, uint32 mapId, uint32 instanceId) : _name(nullptr)
+    {
+        if (sTickProfiler->IsEnabled())
+            Start(name, mapId, instanceId);
+    }
+
+    ~TickProfilerScope()
+    {
+        if (_name)
+            Stop();
+    }
+
+    TickProfilerScope(TickProfilerScope const&) = delete;
+    TickProfilerScope& operator=(TickProfilerScope const&) = delete;
+
+private:
+    void Start(char const* name, uint32 mapId, uint32 instanceId);
+    void Stop();
+
+    char const* _name;
+    uint32 _mapId;
+    uint32 _instanceId;
+    uint32 _parentMapId;
+    uint32 _parentInstanceId;
+    std::chrono::steady_clock::time_point _start;
+};
+
+#define TC_PROFILE_SCOPE_NAME_IMPL(line) tickProfilerScope ## line
+#define TC_PROFILE_SCOPE_NAME(line) TC_PROFILE_SCOPE_NAME_IMPL(line)
+
+#define TC_PROFILE_SCOPE(name) TickProfilerScope TC_PROFILE_SCOPE_NAME(__LINE__)(name)
+#define TC_PROFILE_MAP_SCOPE(name, map) TickProfilerScope TC_PROFILE_SCOPE_NAME(__LINE__)(name, (map)->GetId(), (map)->GetInstanceId())
+
+#endif // TickProfiler_h__
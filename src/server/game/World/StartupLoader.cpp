@@ -0,0 +1,124 @@
+/*
+ * This file is part of the TrinityCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StartupLoader.h"
+#include "Errors.h"
+#include "Log.h"
+#include "Timer.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+StartupLoader::StepId StartupLoader::AddStep(std::string name, std::function<void()> step, std::vector<StepId> const& dependencies /*= { }*/)
+{
+    StepId id = _steps.size();
+    _steps.emplace_back();
+    _steps.back().Name = std::move(name);
+    _steps.back().Work = std::move(step);
+
+    for (StepId dependency : dependencies)
+    {
+        ASSERT(dependency < id, "Startup step %s can only depend on steps added before it", _steps.back().Name.c_str());
+        _steps[dependency].Dependents.push_back(id);
+        ++_steps.back().PendingDependencies;
+    }
+
+    return id;
+}
+
+void StartupLoader::RunStep(Step& step)
+{
+    uint32 oldMSTime = getMSTime();
+    step.Work();
+    step.Duration = GetMSTimeDiffToNow(oldMSTime);
+}
+
+void StartupLoader::Run(uint32 threadCount)
+{
+    uint32 oldMSTime = getMSTime();
+    threadCount = std::max<uint32>(std::min<std::size_t>(threadCount, _steps.size()), 1);
+
+    if (threadCount == 1)
+    {
+        for (Step& step : _steps)
+            RunStep(step);
+    }
+    else
+    {
+        std::mutex lock;
+        std::condition_variable stepFinished;
+        std::deque<StepId> ready;
+        std::size_t finished = 0;
+
+        for (StepId id = 0; id < _steps.size(); ++id)
+            if (!_steps[id].PendingDependencies)
+                ready.push_back(id);
+
+        auto worker = [&]()
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            while (true)
+            {
+                stepFinished.wait(guard, [&]() { return !ready.empty() || finished == _steps.size(); });
+                if (ready.empty())
+                    return;
+
+                Step& step = _steps[ready.front()];
+                ready.pop_front();
+
+                guard.unlock();
+                RunStep(step);
+                guard.lock();
+
+                ++finished;
+                for (StepId dependent : step.Dependents)
+                    if (!--_steps[dependent].PendingDependencies)
+                        ready.push_back(dependent);
+
+                stepFinished.notify_all();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (uint32 i = 1; i < threadCount; ++i)
+            threads.emplace_back(worker);
+
+        worker();
+
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+
+    uint32 totalWork = 0;
+    for (Step const& step : _steps)
+        totalWork += step.Duration;
+
+    TC_LOG_INFO("server.loading", ">> %s: " SZFMTD " steps on %u threads done in %u ms (%u ms of loading)",
+        _name.c_str(), _steps.size(), threadCount, GetMSTimeDiffToNow(oldMSTime), totalWork);
+}
+
+std::vector<StartupLoader::StepTime> StartupLoader::GetStepTimes() const
+{
+    std::vector<StepTime> times;
+    times.reserve(_steps.size());
+    for (Step const& step : _steps)
+        times.push_back({ step.Name, step.Duration });
+
+    return times;
+}
@@ -0,0 +1,66 @@
+/*
+ * This file is part of the TrinityCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef StartupLoader_h__
+#define StartupLoader_h__
+
+#include "Define.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+/// Runs world loading steps as a dependency graph on a small thread pool.
+/// Steps can only depend on steps added before them, so the insertion order is always a valid
+/// sequential order and running with a single thread executes the steps exactly in that order.
+/// Steps without a dependency path between them must not write (or read while the other writes) the same data.
+class TC_GAME_API StartupLoader
+{
+public:
+    typedef std::size_t StepId;
+
+    struct StepTime
+    {
+        std::string Name;
+        uint32 Duration;                                    // milliseconds
+    };
+
+    explicit StartupLoader(std::string name) : _name(std::move(name)) { }
+
+    StepId AddStep(std::string name, std::function<void()> step, std::vector<StepId> const& dependencies = { });
+
+    /// Blocks until every step finished
+    void Run(uint32 threadCount);
+
+    std::vector<StepTime> GetStepTimes() const;
+
+private:
+    struct Step
+    {
+        std::string Name;
+        std::function<void()> Work;
+        std::vector<StepId> Dependents;
+        uint32 PendingDependencies = 0;
+        uint32 Duration = 0;
+    };
+
+    void RunStep(Step& step);
+
+    std::string _name;
+    std::vector<Step> _steps;
+};
+
+#endif // StartupLoader_h__
@@ -83,8 +83,10 @@
 #include "SkillExtraItems.h"
 #include "SpellMgr.h"
 #include "SmartScriptMgr.h"
+#include "StartupLoader.h"
 #include "SupportMgr.h"
 #include "TaxiPathGraph.h"
+#include "TickProfiler.h"
 #include "TransportMgr.h"
 #include "Unit.h"
 #include "UpdateTime.h"
@@ -665,6 +667,13 @@ void World::LoadConfigSettings(bool reload)
         TC_LOG_ERROR("server.loading", "Compression level (%i) must be in range 1..9. Using default compression level (1).", m_int_configs[CONFIG_COMPRESSION]);
         m_int_configs[CONFIG_COMPRESSION] = 1;
     }
+    m_int_configs[CONFIG_COMPRESSION_SHARED_MIN_SIZE] = sConfigMgr->GetIntDefault("Compression.Shared.MinSize", 4096);
+    m_int_configs[CONFIG_COMPRESSION_SHARED_LEVEL] = sConfigMgr->GetIntDefault("Compression.Shared.Level", 6);
+    if (m_int_configs[CONFIG_COMPRESSION_SHARED_LEVEL] < 1 || m_int_configs[CONFIG_COMPRESSION_SHARED_LEVEL] > 9)
+    {
+        TC_LOG_ERROR("server.loading", "Compression.Shared.Level (%i) must be in range 1..9. Using default compression level (6).", m_int_configs[CONFIG_COMPRESSION_SHARED_LEVEL]);
+        m_int_configs[CONFIG_COMPRESSION_SHARED_LEVEL] = 6;
+    }
     m_bool_configs[CONFIG_ADDON_CHANNEL] = sConfigMgr->GetBoolDefault("AddonChannel", true);
     m_bool_configs[CONFIG_CLEAN_CHARACTER_DB] = sConfigMgr->GetBoolDefault("CleanCharacterDB", false);
     m_int_configs[CONFIG_PERSISTENT_CHARACTER_CLEAN_FLAGS] = sConfigMgr->GetIntDefault("PersistentCharacterCleanFlags", 0);
@@ -1366,6 +1375,7 @@ void World::LoadConfigSettings(bool reload)
     m_bool_configs[CONFIG_SHOW_MUTE_IN_WORLD] = sConfigMgr->GetBoolDefault("ShowMuteInWorld", false);
     m_bool_configs[CONFIG_SHOW_BAN_IN_WORLD] = sConfigMgr->GetBoolDefault("ShowBanInWorld", false);
     m_int_configs[CONFIG_NUMTHREADS] = sConfigMgr->GetIntDefault("MapUpdate.Threads", 1);
+    m_bool_configs[CONFIG_MAP_UPDATE_PARALLEL_REGIONS] = sConfigMgr->GetBoolDefault("MapUpdate.ParallelRegions", false);
     m_int_configs[CONFIG_MAX_RESULTS_LOOKUP_COMMANDS] = sConfigMgr->GetIntDefault("Command.LookupMaxResults", 0);
 
     // Warden
@@ -1489,6 +1499,40 @@ void World::LoadConfigSettings(bool reload)
     // Allow to cache data queries
     m_bool_configs[CONFIG_CACHE_DATA_QUERIES] = sConfigMgr->GetBoolDefault("CacheDataQueries", true);
 
+    // Per opcode handling statistics
+    m_bool_configs[CONFIG_OPCODE_STATS] = sConfigMgr->GetBoolDefault("OpcodeStats.Enable", false);
+
+    // Per map and phase update timings
+    bool tickProfiler = sConfigMgr->GetBoolDefault("TickProfiler.Enable", false);
+    // a reload only applies a changed setting, otherwise ".server tickprofile on/off" is kept
+    if (!reload || tickProfiler != m_bool_configs[CONFIG_TICK_PROFILER])
+        sTickProfiler->SetEnabled(tickProfiler);
+    m_bool_configs[CONFIG_TICK_PROFILER] = tickProfiler;
+    m_int_configs[CONFIG_TICK_PROFILER_TRACE_EVENTS] = sConfigMgr->GetIntDefault("TickProfiler.TraceEvents", 65536);
+    if (int32(m_int_configs[CONFIG_TICK_PROFILER_TRACE_EVENTS]) < 0)
+    {
+        TC_LOG_ERROR("server.loading", "TickProfiler.TraceEvents (%i) can't be negative. Set to 0.", m_int_configs[CONFIG_TICK_PROFILER_TRACE_EVENTS]);
+        m_int_configs[CONFIG_TICK_PROFILER_TRACE_EVENTS] = 0;
+    }
+    sTickProfiler->SetTraceCapacity(m_int_configs[CONFIG_TICK_PROFILER_TRACE_EVENTS]);
+
+    // Threads used for independent loading steps at startup
+    m_int_configs[CONFIG_STARTUP_LOADER_THREADS] = sConfigMgr->GetIntDefault("Startup.LoaderThreads", 4);
+    if (m_int_configs[CONFIG_STARTUP_LOADER_THREADS] < 1)
+    {
+        TC_LOG_ERROR("server.loading", "Startup.LoaderThreads (%i) must be at least 1. Set to 1.", m_int_configs[CONFIG_STARTUP_LOADER_THREADS]);
+        m_int_configs[CONFIG_STARTUP_LOADER_THREADS] = 1;
+    }
+
+    // nearly every step queries the world database (only rbac and completed achievements use other pools),
+    // more threads than connections would only wait for each other
+    if (m_int_configs[CONFIG_STARTUP_LOADER_THREADS] > WorldDatabase.GetSynchThreadCount())
+    {
+        TC_LOG_INFO("server.loading", "Startup.LoaderThreads (%i) is limited to WorldDatabase.SynchThreads (%u).",
+            m_int_configs[CONFIG_STARTUP_LOADER_THREADS], uint32(WorldDatabase.GetSynchThreadCount()));
+        m_int_configs[CONFIG_STARTUP_LOADER_THREADS] = std::max<uint32>(WorldDatabase.GetSynchThreadCount(), 1);
+    }
+
     // Check Invalid Position
     m_bool_configs[CONFIG_CREATURE_CHECK_INVALID_POSITION] = sConfigMgr->GetBoolDefault("Creature.CheckInvalidPosition", false);
     m_bool_configs[CONFIG_GAME_OBJECT_CHECK_INVALID_POSITION] = sConfigMgr->GetBoolDefault("GameObject.CheckInvalidPosition", false);
@@ -1507,6 +1551,7 @@ void World::SetInitialWorldSettings()
 {
     ///- Server startup begin
     uint32 startupBegin = getMSTime();
+    std::vector<StartupLoader::StepTime> startupStepTimes;
 
     ///- Initialize the random number generator
     srand((unsigned int)time(NULL));
@@ -1639,72 +1684,99 @@ void World::SetInitialWorldSettings()
     TC_LOG_INFO("server.loading", "Loading instances...");
     sInstanceSaveMgr->LoadInstances();
 
-    TC_LOG_INFO("server.loading", "Loading Localization strings...");
-    uint32 oldMSTime = getMSTime();
-    sObjectMgr->LoadCreatureLocales();
-    sObjectMgr->LoadGameObjectLocales();
-    sObjectMgr->LoadQuestTemplateLocale();
-    sObjectMgr->LoadQuestGreetingLocales();
-    sObjectMgr->LoadQuestOfferRewardLocale();
-    sObjectMgr->LoadQuestRequestItemsLocale();
-    sObjectMgr->LoadQuestObjectivesLocale();
-    sObjectMgr->LoadPageTextLocales();
-    sObjectMgr->LoadGossipMenuItemsLocales();
-    sObjectMgr->LoadPointOfInterestLocales();
-
     sObjectMgr->SetDBCLocaleIndex(GetDefaultDbcLocale());        // Get once for all the locale index of DBC language (console/broadcasts)
-    TC_LOG_INFO("server.loading", ">> Localization strings loaded in %u ms", GetMSTimeDiffToNow(oldMSTime));
-
-    TC_LOG_INFO("server.loading", "Loading Account Roles and Permissions...");
-    sAccountMgr->LoadRBAC();
-
-    TC_LOG_INFO("server.loading", "Loading Page Texts...");
-    sObjectMgr->LoadPageTexts();
-
-    TC_LOG_INFO("server.loading", "Loading Game Object Templates...");         // must be after LoadPageTexts
-    sObjectMgr->LoadGameObjectTemplate();
-
-    TC_LOG_INFO("server.loading", "Loading Game Object template addons...");
-    sObjectMgr->LoadGameObjectTemplateAddons();
-
-    TC_LOG_INFO("server.loading", "Loading Transport templates...");
-    sTransportMgr->LoadTransportTemplates();
 
-    TC_LOG_INFO("server.loading", "Loading Transport animations and rotations...");
-    sTransportMgr->LoadTransportAnimationAndRotation();
+    // Localization strings, templates without spawns and the SpellMgr tables only depend on data loaded above,
+    // load the independent groups concurrently
+    {
+        StartupLoader loader("Localization strings, gameobject templates and spell data");
 
-    TC_LOG_INFO("server.loading", "Loading Spell Rank Data...");
-    sSpellMgr->LoadSpellRanks();
+        loader.AddStep("Creature locales", []() { sObjectMgr->LoadCreatureLocales(); });
+        loader.AddStep("GameObject locales", []() { sObjectMgr->LoadGameObjectLocales(); });
+        loader.AddStep("Quest template locales", []() { sObjectMgr->LoadQuestTemplateLocale(); });
+        StartupLoader::StepId questGreetingLocales = loader.AddStep("Quest greeting locales", []() { sObjectMgr->LoadQuestGreetingLocales(); });
+        loader.AddStep("Quest offer reward locales", []() { sObjectMgr->LoadQuestOfferRewardLocale(); });
+        loader.AddStep("Quest request items locales", []() { sObjectMgr->LoadQuestRequestItemsLocale(); });
+        loader.AddStep("Quest objectives locales", []() { sObjectMgr->LoadQuestObjectivesLocale(); });
+        loader.AddStep("Page text locales", []() { sObjectMgr->LoadPageTextLocales(); });
+        loader.AddStep("Gossip menu items locales", []() { sObjectMgr->LoadGossipMenuItemsLocales(); });
+        loader.AddStep("Points of interest locales", []() { sObjectMgr->LoadPointOfInterestLocales(); });
 
-    TC_LOG_INFO("server.loading", "Loading Spell Required Data...");
-    sSpellMgr->LoadSpellRequired();
+        loader.AddStep("Account Roles and Permissions", []()
+        {
+            TC_LOG_INFO("server.loading", "Loading Account Roles and Permissions...");
+            sAccountMgr->LoadRBAC();
+        });
 
-    TC_LOG_INFO("server.loading", "Loading Spell Group types...");
-    sSpellMgr->LoadSpellGroups();
+        StartupLoader::StepId pageTexts = loader.AddStep("Page Texts", []()
+        {
+            TC_LOG_INFO("server.loading", "Loading Page Texts...");
+            sObjectMgr->LoadPageTexts();
+        });
 
-    TC_LOG_INFO("server.loading", "Loading Spell Learn Skills...");
-    sSpellMgr->LoadSpellLearnSkills();                           // must be after LoadSpellRanks
+        // quest greeting locales look up gameobject templates, keep them running before the templates exist as they always did
+        StartupLoader::StepId gameObjectTemplates = loader.AddStep("Game Object Templates", []()
+        {
+            TC_LOG_INFO("server.loading", "Loading Game Object Templates...");
+            sObjectMgr->LoadGameObjectTemplate();
+        }, { pageTexts, questGreetingLocales });
 
-    TC_LOG_INFO("server.loading", "Loading SpellInfo SpellSpecific and AuraState...");
-    sSpellMgr->LoadSpellInfoSpellSpecificAndAuraState();         // must be after LoadSpellRanks
+        StartupLoader::StepId gameObjectTemplateAddons = loader.AddStep("Game Object template addons", []()
+        {
+            TC_LOG_INFO("server.loading", "Loading Game Object template addons...");
+            sObjectMgr->LoadGameObjectTemplateAddons();
+        }, { gameObjectTemplates });
 
-    TC_LOG_INFO("server.loading", "Loading Spell Learn Spells...");
-    sSpellMgr->LoadSpellLearnSpells();
+        StartupLoader::StepId transportTemplates = loader.AddStep("Transport templates", []()
+        {
+            TC_LOG_INFO("server.loading", "Loading Transport templates...");
+            sTransportMgr->LoadTransportTemplates();
+        }, { gameObjectTemplateAddons });
 
-    TC_LOG_INFO("server.loading", "Loading Spell Proc conditions and data...");
-    sSpellMgr->LoadSpellProcs();
+        loader.AddStep("Transport animations and rotations", []()
+        {
+            TC_LOG_INFO("server.loading", "Loading Transport animations and rotations...");
+            sTransportMgr->LoadTransportAnimationAndRotation();
+        }, { transportTemplates });
 
-    TC_LOG_INFO("server.loading", "Loading Aggro Spells Definitions...");
-    sSpellMgr->LoadSpellThreats();
+        // SpellMgr tables read each other, keep them in their original order
+        StartupLoader::StepId spellData = loader.AddStep("Spell Rank Data", []()
+        {
+            TC_LOG_INFO("server.loading", "Loading Spell Rank Data...");
+            sSpellMgr->LoadSpellRanks();
+        });
 
-    TC_LOG_INFO("server.loading", "Loading Spell Group Stack Rules...");
-    sSpellMgr->LoadSpellGroupStackRules();
+        std::pair<char const*, void(SpellMgr::*)()> const spellSteps[] =
+        {
+            { "Spell Required Data",                      &SpellMgr::LoadSpellRequired },
+            { "Spell Group types",                        &SpellMgr::LoadSpellGroups },
+            { "Spell Learn Skills",                       &SpellMgr::LoadSpellLearnSkills },
+            { "SpellInfo SpellSpecific and AuraState",    &SpellMgr::LoadSpellInfoSpellSpecificAndAuraState },
+            { "Spell Learn Spells",                       &SpellMgr::LoadSpellLearnSpells },
+            { "Spell Proc conditions and data",           &SpellMgr::LoadSpellProcs },
+            { "Aggro Spells Definitions",                 &SpellMgr::LoadSpellThreats },
+            { "Spell Group Stack Rules",                  &SpellMgr::LoadSpellGroupStackRules },
+            { "Enchant Spells Proc datas",                &SpellMgr::LoadSpellEnchantProcData }
+        };
+
+        for (auto const& spellStep : spellSteps)
+        {
+            spellData = loader.AddStep(spellStep.first, [spellStep]()
+            {
+                TC_LOG_INFO("server.loading", "Loading %s...", spellStep.first);
+                (sSpellMgr->*spellStep.second)();
+            }, { spellData });
+        }
 
-    TC_LOG_INFO("server.loading", "Loading NPC Texts...");
-    sObjectMgr->LoadNPCText();
+        loader.AddStep("NPC Texts", []()
+        {
+            TC_LOG_INFO("server.loading", "Loading NPC Texts...");
+            sObjectMgr->LoadNPCText();
+        });
 
-    TC_LOG_INFO("server.loading", "Loading Enchant Spells Proc datas...");
-    sSpellMgr->LoadSpellEnchantProcData();
+        loader.Run(getIntConfig(CONFIG_STARTUP_LOADER_THREADS));
+        startupStepTimes = loader.GetStepTimes();
+    }
 
     TC_LOG_INFO("server.loading", "Loading Random item bonus list definitions...");
     LoadItemRandomBonusListTemplates();
@@ -1909,38 +1981,86 @@ void World::SetInitialWorldSettings()
     TC_LOG_INFO("server.loading", "Loading Player level dependent mail rewards...");
     sObjectMgr->LoadMailLevelRewards();
 
-    // Loot tables
-    LoadLootTables();
+    // Loot tables, skill tables and achievements only read templates loaded above and write their own stores
+    {
+        StartupLoader loader("Loot, skill and achievement tables");
 
-    TC_LOG_INFO("server.loading", "Loading Skill Discovery Table...");
-    LoadSkillDiscoveryTable();
+        // every loot store is independent, only the reference store checks the references of all others
+        std::pair<char const*, void(*)()> const lootSteps[] =
+        {
+            { "Creature loot templates",        &LoadLootTemplates_Creature },
+            { "Fishing loot templates",         &LoadLootTemplates_Fishing },
+            { "Gameobject loot templates",      &LoadLootTemplates_Gameobject },
+            { "Item loot templates",            &LoadLootTemplates_Item },
+            { "Mail loot templates",            &LoadLootTemplates_Mail },
+            { "Milling loot templates",         &LoadLootTemplates_Milling },
+            { "Pickpocketing loot templates",   &LoadLootTemplates_Pickpocketing },
+            { "Scrapping loot templates",       &LoadLootTemplates_Scrapping },
+            { "Skinning loot templates",        &LoadLootTemplates_Skinning },
+            { "Disenchant loot templates",      &LoadLootTemplates_Disenchant },
+            { "Prospecting loot templates",     &LoadLootTemplates_Prospecting },
+            { "Spell loot templates",           &LoadLootTemplates_Spell }
+        };
+
+        std::vector<StartupLoader::StepId> lootStores;
+        for (auto const& lootStep : lootSteps)
+            lootStores.push_back(loader.AddStep(lootStep.first, lootStep.second));
+
+        loader.AddStep("Reference loot templates", &LoadLootTemplates_Reference, lootStores);
+
+        loader.AddStep("Skill Discovery Table", []()
+        {
+            TC_LOG_INFO("server.loading", "Loading Skill Discovery Table...");
+            LoadSkillDiscoveryTable();
+        });
 
-    TC_LOG_INFO("server.loading", "Loading Skill Extra Item Table...");
-    LoadSkillExtraItemTable();
+        loader.AddStep("Skill Extra Item Table", []()
+        {
+            TC_LOG_INFO("server.loading", "Loading Skill Extra Item Table...");
+            LoadSkillExtraItemTable();
+        });
 
-    TC_LOG_INFO("server.loading", "Loading Skill Perfection Data Table...");
-    LoadSkillPerfectItemTable();
+        loader.AddStep("Skill Perfection Data Table", []()
+        {
+            TC_LOG_INFO("server.loading", "Loading Skill Perfection Data Table...");
+            LoadSkillPerfectItemTable();
+        });
 
-    TC_LOG_INFO("server.loading", "Loading Skill Fishing base level requirements...");
-    sObjectMgr->LoadFishingBaseSkillLevel();
+        loader.AddStep("Skill Fishing base level requirements", []()
+        {
+            TC_LOG_INFO("server.loading", "Loading Skill Fishing base level requirements...");
+            sObjectMgr->LoadFishingBaseSkillLevel();
+        });
 
-    TC_LOG_INFO("server.loading", "Loading skill tier info...");
-    sObjectMgr->LoadSkillTiers();
+        loader.AddStep("Skill tier info", []()
+        {
+            TC_LOG_INFO("server.loading", "Loading skill tier info...");
+            sObjectMgr->LoadSkillTiers();
+        });
 
-    TC_LOG_INFO("server.loading", "Loading Criteria Modifier trees...");
-    sCriteriaMgr->LoadCriteriaModifiersTree();
-    TC_LOG_INFO("server.loading", "Loading Criteria Lists...");
-    sCriteriaMgr->LoadCriteriaList();
-    TC_LOG_INFO("server.loading", "Loading Criteria Data...");
-    sCriteriaMgr->LoadCriteriaData();
-    TC_LOG_INFO("server.loading", "Loading Achievements...");
-    sAchievementMgr->LoadAchievementReferenceList();
-    TC_LOG_INFO("server.loading", "Loading Achievement Rewards...");
-    sAchievementMgr->LoadRewards();
-    TC_LOG_INFO("server.loading", "Loading Achievement Reward Locales...");
-    sAchievementMgr->LoadRewardLocales();
-    TC_LOG_INFO("server.loading", "Loading Completed Achievements...");
-    sAchievementMgr->LoadCompletedAchievements();
+        // criteria and achievements build on each other, keep them in their original order
+        loader.AddStep("Criteria and Achievements", []()
+        {
+            TC_LOG_INFO("server.loading", "Loading Criteria Modifier trees...");
+            sCriteriaMgr->LoadCriteriaModifiersTree();
+            TC_LOG_INFO("server.loading", "Loading Criteria Lists...");
+            sCriteriaMgr->LoadCriteriaList();
+            TC_LOG_INFO("server.loading", "Loading Criteria Data...");
+            sCriteriaMgr->LoadCriteriaData();
+            TC_LOG_INFO("server.loading", "Loading Achievements...");
+            sAchievementMgr->LoadAchievementReferenceList();
+            TC_LOG_INFO("server.loading", "Loading Achievement Rewards...");
+            sAchievementMgr->LoadRewards();
+            TC_LOG_INFO("server.loading", "Loading Achievement Reward Locales...");
+            sAchievementMgr->LoadRewardLocales();
+            TC_LOG_INFO("server.loading", "Loading Completed Achievements...");
+            sAchievementMgr->LoadCompletedAchievements();
+        });
+
+        loader.Run(getIntConfig(CONFIG_STARTUP_LOADER_THREADS));
+        std::vector<StartupLoader::StepTime> stepTimes = loader.GetStepTimes();
+        startupStepTimes.insert(startupStepTimes.end(), stepTimes.begin(), stepTimes.end());
+    }
 
     // Load before guilds and arena teams
     TC_LOG_INFO("server.loading", "Loading character cache store...");
@@ -2263,8 +2383,20 @@ void World::SetInitialWorldSettings()
         });
     }
 
+    // all streamed world tables are loaded, write a recorded snapshot and release a replayed one
+    WorldDatabase.CloseSnapshot();
+
     uint32 startupDuration = GetMSTimeDiffToNow(startupBegin);
 
+    std::sort(startupStepTimes.begin(), startupStepTimes.end(), [](StartupLoader::StepTime const& left, StartupLoader::StepTime const& right)
+    {
+        return left.Duration > right.Duration;
+    });
+
+    TC_LOG_INFO("server.loading", "Concurrently loaded startup steps:");
+    for (StartupLoader::StepTime const& stepTime : startupStepTimes)
+        TC_LOG_INFO("server.loading", "    %6u ms  %s", stepTime.Duration, stepTime.Name.c_str());
+
     TC_LOG_INFO("server.worldserver", "World initialized in %u minutes %u seconds", (startupDuration / 60000), ((startupDuration % 60000) / 1000));
 
     TC_METRIC_EVENT("events", "World initialized", "World initialized in " + std::to_string(startupDuration / 60000) + " minutes " + std::to_string((startupDuration % 60000) / 1000) + " seconds");
@@ -2303,6 +2435,8 @@ void World::LoadAutobroadcasts()
 /// Update the World !
 void World::Update(uint32 diff)
 {
+    TC_PROFILE_SCOPE("World::Update");
+
     ///- Update the game time and check for shutdown time
     _UpdateGameTime();
     time_t currentGameTime = GameTime::GetGameTime();
@@ -2416,7 +2550,10 @@ void World::Update(uint32 diff)
 
     /// <li> Handle session updates when the timer has passed
     sWorldUpdateTime.RecordUpdateTimeReset();
-    UpdateSessions(diff);
+    {
+        TC_PROFILE_SCOPE("World::UpdateSessions");
+        UpdateSessions(diff);
+    }
     sWorldUpdateTime.RecordUpdateTimeDuration("UpdateSessions");
 
     /// <li> Update uptime table
@@ -2459,7 +2596,10 @@ void World::Update(uint32 diff)
     /// <li> Handle all other objects
     ///- Update objects when the timer has passed (maps, transport, creatures, ...)
     sWorldUpdateTime.RecordUpdateTimeReset();
-    sMapMgr->Update(diff);
+    {
+        TC_PROFILE_SCOPE("MapManager::Update");
+        sMapMgr->Update(diff);
+    }
     sWorldUpdateTime.RecordUpdateTimeDuration("UpdateMapMgr");
 
     if (sWorld->getBoolConfig(CONFIG_AUTOBROADCAST))
@@ -2471,13 +2611,22 @@ void World::Update(uint32 diff)
         }
     }
 
-    sBattlegroundMgr->Update(diff);
+    {
+        TC_PROFILE_SCOPE("BattlegroundMgr::Update");
+        sBattlegroundMgr->Update(diff);
+    }
     sWorldUpdateTime.RecordUpdateTimeDuration("UpdateBattlegroundMgr");
 
-    sOutdoorPvPMgr->Update(diff);
+    {
+        TC_PROFILE_SCOPE("OutdoorPvPMgr::Update");
+        sOutdoorPvPMgr->Update(diff);
+    }
     sWorldUpdateTime.RecordUpdateTimeDuration("UpdateOutdoorPvPMgr");
 
-    sBattlefieldMgr->Update(diff);
+    {
+        TC_PROFILE_SCOPE("BattlefieldMgr::Update");
+        sBattlefieldMgr->Update(diff);
+    }
     sWorldUpdateTime.RecordUpdateTimeDuration("BattlefieldMgr");
 
     ///- Delete all characters which have been deleted X days before
@@ -2485,16 +2634,26 @@ void World::Update(uint32 diff)
     {
         m_timers[WUPDATE_DELETECHARS].Reset();
         Player::DeleteOldCharacters();
+        CharacterDatabase.Execute(CharacterDatabase.GetPreparedStatement(CHAR_DEL_EXPIRED_BANS));
     }
 
-    sLFGMgr->Update(diff);
+    {
+        TC_PROFILE_SCOPE("LFGMgr::Update");
+        sLFGMgr->Update(diff);
+    }
     sWorldUpdateTime.RecordUpdateTimeDuration("UpdateLFGMgr");
 
-    sGroupMgr->Update(diff);
+    {
+        TC_PROFILE_SCOPE("GroupMgr::Update");
+        sGroupMgr->Update(diff);
+    }
     sWorldUpdateTime.RecordUpdateTimeDuration("GroupMgr");
 
     // execute callbacks from sql queries that were queued recently
-    ProcessQueryCallbacks();
+    {
+        TC_PROFILE_SCOPE("World::ProcessQueryCallbacks");
+        ProcessQueryCallbacks();
+    }
     sWorldUpdateTime.RecordUpdateTimeDuration("ProcessQueryCallbacks");
 
     ///- Erase corpses once every 20 minutes
@@ -195,6 +195,9 @@ enum WorldBoolConfigs
     CONFIG_GAME_OBJECT_CHECK_INVALID_POSITION,
     CONFIG_LEGACY_BUFF_ENABLED,
     CONFIG_IGNORE_DUNGEONS_BIND,
+    CONFIG_MAP_UPDATE_PARALLEL_REGIONS,
+    CONFIG_OPCODE_STATS,
+    CONFIG_TICK_PROFILER,
     BOOL_CONFIG_VALUE_COUNT
 };
 
@@ -405,6 +408,10 @@ enum WorldIntConfigs
     CONFIG_BLACKMARKET_MAXAUCTIONS,
     CONFIG_BLACKMARKET_UPDATE_PERIOD,
     CONFIG_AZERITE_KNOWLEGE,
+    CONFIG_COMPRESSION_SHARED_MIN_SIZE,
+    CONFIG_COMPRESSION_SHARED_LEVEL,
+    CONFIG_TICK_PROFILER_TRACE_EVENTS,
+    CONFIG_STARTUP_LOADER_THREADS,
     INT_CONFIG_VALUE_COUNT
 };
 
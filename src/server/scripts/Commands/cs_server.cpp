@@ -33,9 +33,12 @@ EndScriptData */
 #include "Log.h"
 #include "MySQLThreading.h"
 #include "ObjectAccessor.h"
+#include "OpcodeStats.h"
+#include "Opcodes.h"
 #include "Player.h"
 #include "RBAC.h"
 #include "Realm.h"
+#include "TickProfiler.h"
 #include "UpdateTime.h"
 #include "Util.h"
 #include "VMapFactory.h"
@@ -98,10 +101,12 @@ public:
             { "idleshutdown", rbac::RBAC_PERM_COMMAND_SERVER_IDLESHUTDOWN, true, nullptr,                     "", serverIdleShutdownCommandTable },
             { "info",         rbac::RBAC_PERM_COMMAND_SERVER_INFO,         true, &HandleServerInfoCommand,    "" },
             { "motd",         rbac::RBAC_PERM_COMMAND_SERVER_MOTD,         true, &HandleServerMotdCommand,    "" },
+            { "opcodestats",  rbac::RBAC_PERM_COMMAND_SERVER_OPCODESTATS,  true, &HandleServerOpcodeStatsCommand, "" },
             { "plimit",       rbac::RBAC_PERM_COMMAND_SERVER_PLIMIT,       true, &HandleServerPLimitCommand,  "" },
             { "restart",      rbac::RBAC_PERM_COMMAND_SERVER_RESTART,      true, nullptr,                     "", serverRestartCommandTable },
             { "shutdown",     rbac::RBAC_PERM_COMMAND_SERVER_SHUTDOWN,     true, nullptr,                     "", serverShutdownCommandTable },
             { "set",          rbac::RBAC_PERM_COMMAND_SERVER_SET,          true, nullptr,                     "", serverSetCommandTable },
+            { "tickprofile",  rbac::RBAC_PERM_COMMAND_SERVER_TICKPROFILE,  true, &HandleServerTickProfileCommand, "" },
         };
 
         static std::vector<ChatCommand> commandTable =
@@ -272,6 +277,117 @@ public:
 
         return true;
     }
+    // Display the most expensive opcodes recorded since startup
+    static bool HandleServerOpcodeStatsCommand(ChatHandler* handler, char const* args)
+    {
+        if (!sWorld->getBoolConfig(CONFIG_OPCODE_STATS))
+        {
+            handler->SendSysMessage("Opcode statistics are disabled (OpcodeStats.Enable).");
+            return true;
+        }
+
+        uint32 count = 10;
+        if (*args)
+        {
+            int32 value = atoi(args);
+            if (value < 1)
+            {
+                handler->SendSysMessage(LANG_BAD_VALUE);
+                handler->SetSentErrorMessage(true);
+                return false;
+            }
+
+            count = uint32(value);
+        }
+
+        std::vector<OpcodeStatsEntry> handled = sOpcodeStats->GetHandledStats();
+        std::sort(handled.begin(), handled.end(), [](OpcodeStatsEntry const& left, OpcodeStatsEntry const& right)
+        {
+            return left.TotalTime > right.TotalTime;
+        });
+
+        handler->PSendSysMessage("Handled opcodes by total time (top %u of " SZFMTD "):", count, handled.size());
+        for (std::size_t i = 0; i < handled.size() && i < count; ++i)
+        {
+            OpcodeStatsEntry const& entry = handled[i];
+            handler->PSendSysMessage("%s: count " UI64FMTD ", total " UI64FMTD " ms, avg " UI64FMTD " us, p50 " UI64FMTD " us, p95 " UI64FMTD " us, p99 " UI64FMTD " us, max " UI64FMTD " us, bytes " UI64FMTD,
+                GetOpcodeNameForLogging(static_cast<OpcodeClient>(entry.Opcode)).c_str(), entry.Count, entry.TotalTime / IN_MILLISECONDS, entry.GetAverageTime(),
+                entry.GetPercentileTime(50), entry.GetPercentileTime(95), entry.GetPercentileTime(99), entry.MaxTime, entry.Bytes);
+        }
+
+        std::vector<OpcodeStatsEntry> sent = sOpcodeStats->GetSentStats();
+        std::sort(sent.begin(), sent.end(), [](OpcodeStatsEntry const& left, OpcodeStatsEntry const& right)
+        {
+            return left.Bytes > right.Bytes;
+        });
+
+        handler->PSendSysMessage("Sent opcodes by bytes (top %u of " SZFMTD "):", count, sent.size());
+        for (std::size_t i = 0; i < sent.size() && i < count; ++i)
+        {
+            OpcodeStatsEntry const& entry = sent[i];
+            handler->PSendSysMessage("%s: count " UI64FMTD ", bytes " UI64FMTD,
+                GetOpcodeNameForLogging(static_cast<OpcodeServer>(entry.Opcode)).c_str(), entry.Count, entry.Bytes);
+        }
+
+        return true;
+    }
+
+    // Toggle the tick profiler or dump its trace buffers
+    static bool HandleServerTickProfileCommand(ChatHandler* handler, char const* args)
+    {
+        if (!*args)
+        {
+            handler->PSendSysMessage("Tick profiler is %s.", sTickProfiler->IsEnabled() ? "enabled" : "disabled");
+            return true;
+        }
+
+        char* mode = strtok((char*)args, " ");
+        if (!strncmp(mode, "on", 3))
+        {
+            sTickProfiler->SetEnabled(true);
+            handler->SendSysMessage("Tick profiler enabled.");
+            return true;
+        }
+
+        if (!strncmp(mode, "off", 4))
+        {
+            sTickProfiler->SetEnabled(false);
+            handler->SendSysMessage("Tick profiler disabled.");
+            return true;
+        }
+
+        if (!strncmp(mode, "dump", 5))
+        {
+            std::string fileName;
+            if (char* fileArg = strtok(nullptr, " "))
+                fileName = fileArg;
+            else
+                fileName = Trinity::StringFormat("tickprofile_" UI64FMTD ".json", uint64(GameTime::GetGameTime()));
+
+            // only a file name, the trace always goes to the logs directory
+            if (fileName.find_first_of("/\\:") != std::string::npos || fileName == "." || fileName == "..")
+            {
+                handler->PSendSysMessage("Invalid file name %s, give a file name without directory.", fileName.c_str());
+                handler->SetSentErrorMessage(true);
+                return false;
+            }
+
+            fileName = sLog->GetLogsDir() + fileName;
+
+            if (!sTickProfiler->DumpTrace(fileName))
+            {
+                handler->PSendSysMessage("Could not write tick profiler trace to %s.", fileName.c_str());
+                handler->SetSentErrorMessage(true);
+                return false;
+            }
+
+            handler->PSendSysMessage("Tick profiler trace written to %s.", fileName.c_str());
+            return true;
+        }
+
+        return false;
+    }
+
     // Display the 'Message of the day' for the realm
     static bool HandleServerMotdCommand(ChatHandler* handler, char const* /*args*/)
     {
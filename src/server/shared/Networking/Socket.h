@@ -21,15 +21,19 @@
 #include "MessageBuffer.h"
 #include "Log.h"
 #include <atomic>
-#include <queue>
+#include <deque>
 #include <memory>
 #include <functional>
 #include <type_traits>
+#include <vector>
+#include <boost/asio/buffer.hpp>
 #include <boost/asio/ip/tcp.hpp>
 
 using boost::asio::ip::tcp;
 
 #define READ_BLOCK_SIZE 4096
+// upper bound of queued buffers handed to a single gathered write (well below IOV_MAX)
+#define WRITE_GATHER_BUFFERS 64
 #ifdef BOOST_ASIO_HAS_IOCP
 #define TC_SOCKET_USE_IOCP
 #endif
@@ -66,9 +70,11 @@ class Socket : public std::enable_shared_from_this<T>
 {
 public:
     explicit Socket(tcp::socket&& socket) : _socket(std::move(socket)), _remoteAddress(_socket.remote_endpoint().address()),
-        _remotePort(_socket.remote_endpoint().port()), _readBuffer(), _closed(false), _closing(false), _isWritingAsync(false)
+        _remotePort(_socket.remote_endpoint().port()), _readBuffer(), _closed(false), _closing(false), _isWritingAsync(false),
+        _maxWriteSize(65536)
     {
         _readBuffer.Resize(READ_BLOCK_SIZE);
+        _writeBuffers.reserve(WRITE_GATHER_BUFFERS);
     }
 
     virtual ~Socket()
@@ -130,7 +136,7 @@ public:
 
     void QueuePacket(MessageBuffer&& buffer)
     {
-        _writeQueue.push(std::move(buffer));
+        _writeQueue.push_back(std::move(buffer));
 
 #ifdef TC_SOCKET_USE_IOCP
         AsyncProcessQueue();
@@ -171,8 +177,8 @@ protected:
         _isWritingAsync = true;
 
 #ifdef TC_SOCKET_USE_IOCP
-        MessageBuffer& buffer = _writeQueue.front();
-        _socket.async_write_some(boost::asio::buffer(buffer.GetReadPointer(), buffer.GetActiveSize()), std::bind(&Socket<T, Stream>::WriteHandler,
+        PrepareWriteBuffers();
+        _socket.async_write_some(_writeBuffers, std::bind(&Socket<T, Stream>::WriteHandler,
             this->shared_from_this(), std::placeholders::_1, std::placeholders::_2));
 #else
         _socket.async_write_some(boost::asio::null_buffers(), std::bind(&Socket<T, Stream>::WriteHandlerWrapper,
@@ -191,6 +197,9 @@ protected:
                 GetRemoteIpAddress().to_string().c_str(), err.value(), err.message().c_str());
     }
 
+    /// Limits the amount of queued data passed to a single write call
+    void SetMaxWriteSize(std::size_t maxWriteSize) { _maxWriteSize = maxWriteSize; }
+
     Stream& underlying_stream()
     {
         return _socket;
@@ -209,6 +218,42 @@ private:
         ReadHandler();
     }
 
+    /// Collects the front of the write queue into a buffer sequence so it can be sent with a single gathered write
+    void PrepareWriteBuffers()
+    {
+        _writeBuffers.clear();
+
+        std::size_t bytesToSend = 0;
+        for (MessageBuffer& queuedMessage : _writeQueue)
+        {
+            if (_writeBuffers.size() >= WRITE_GATHER_BUFFERS || (bytesToSend && bytesToSend + queuedMessage.GetActiveSize() > _maxWriteSize))
+                break;
+
+            _writeBuffers.emplace_back(queuedMessage.GetReadPointer(), queuedMessage.GetActiveSize());
+            bytesToSend += queuedMessage.GetActiveSize();
+        }
+    }
+
+    /// Drops fully written buffers from the write queue, returns true if everything passed to the last write was sent
+    bool WriteCompleted(std::size_t transferedBytes)
+    {
+        std::size_t buffersSent = _writeBuffers.size();
+        for (std::size_t i = 0; i < buffersSent; ++i)
+        {
+            MessageBuffer& queuedMessage = _writeQueue.front();
+            if (transferedBytes < queuedMessage.GetActiveSize())
+            {
+                queuedMessage.ReadCompleted(transferedBytes);
+                return false;
+            }
+
+            transferedBytes -= queuedMessage.GetActiveSize();
+            _writeQueue.pop_front();
+        }
+
+        return true;
+    }
+
 #ifdef TC_SOCKET_USE_IOCP
 
     void WriteHandler(boost::system::error_code error, std::size_t transferedBytes)
@@ -216,9 +261,7 @@ private:
         if (!error)
         {
             _isWritingAsync = false;
-            _writeQueue.front().ReadCompleted(transferedBytes);
-            if (!_writeQueue.front().GetActiveSize())
-                _writeQueue.pop();
+            WriteCompleted(transferedBytes);
 
             if (!_writeQueue.empty())
                 AsyncProcessQueue();
@@ -242,37 +285,31 @@ private:
         if (_writeQueue.empty())
             return false;
 
-        MessageBuffer& queuedMessage = _writeQueue.front();
-
-        std::size_t bytesToSend = queuedMessage.GetActiveSize();
+        PrepareWriteBuffers();
 
         boost::system::error_code error;
-        std::size_t bytesSent = _socket.write_some(boost::asio::buffer(queuedMessage.GetReadPointer(), bytesToSend), error);
+        std::size_t bytesSent = _socket.write_some(_writeBuffers, error);
 
         if (error)
         {
             if (error == boost::asio::error::would_block || error == boost::asio::error::try_again)
                 return AsyncProcessQueue();
 
-            _writeQueue.pop();
+            _writeQueue.pop_front();
             if (_closing && _writeQueue.empty())
                 CloseSocket();
             return false;
         }
         else if (bytesSent == 0)
         {
-            _writeQueue.pop();
+            _writeQueue.pop_front();
             if (_closing && _writeQueue.empty())
                 CloseSocket();
             return false;
         }
-        else if (bytesSent < bytesToSend) // now n > 0
-        {
-            queuedMessage.ReadCompleted(bytesSent);
+        else if (!WriteCompleted(bytesSent)) // now n > 0
             return AsyncProcessQueue();
-        }
 
-        _writeQueue.pop();
         if (_closing && _writeQueue.empty())
             CloseSocket();
         return !_writeQueue.empty();
@@ -286,12 +323,14 @@ private:
     uint16 _remotePort;
 
     MessageBuffer _readBuffer;
-    std::queue<MessageBuffer> _writeQueue;
+    std::deque<MessageBuffer> _writeQueue;
+    std::vector<boost::asio::const_buffer> _writeBuffers;
 
     std::atomic<bool> _closed;
     std::atomic<bool> _closing;
 
     bool _isWritingAsync;
+    std::size_t _maxWriteSize;
 };
 
 #endif // __SOCKET_H__
@@ -38,6 +38,7 @@
 #include "MySQLThreading.h"
 #include "ObjectAccessor.h"
 #include "OpenSSLCrypto.h"
+#include "OpcodeStats.h"
 #include "OutdoorPvP/OutdoorPvPMgr.h"
 #include "ProcessPriority.h"
 #include "RASession.h"
@@ -46,6 +47,7 @@
 #include "ScriptMgr.h"
 #include "ScriptReloadMgr.h"
 #include "TCSoap.h"
+#include "TickProfiler.h"
 #include "RESTService.h"
 #include "World.h"
 #include "WorldSocket.h"
@@ -259,6 +261,14 @@ extern int main(int argc, char** argv)
     sMetric->Initialize(realm.Name, *ioContext, []()
     {
         TC_METRIC_VALUE("online_players", sWorld->GetPlayerCount());
+        if (sWorld->getBoolConfig(CONFIG_OPCODE_STATS))
+            sOpcodeStats->LogMetrics();
+        if (sTickProfiler->IsEnabled())
+            sTickProfiler->LogMetrics();
+        LoginDatabase.LogMetrics();
+        CharacterDatabase.LogMetrics();
+        WorldDatabase.LogMetrics();
+        HotfixDatabase.LogMetrics();
     });
 
     TC_METRIC_EVENT("events", "Worldserver started", "");